@@ -14,6 +14,10 @@
  *    E1: Status
  *    F1: Temperature
  *    G1: Humidity
+ *    H1: Boot
+ *    I1: Seq
+ *    J1: Count
+ *    K1: First
  * 
  * 3. Vào menu: Extensions > Apps Script
  * 
@@ -33,50 +37,200 @@
  * 8. Paste URL đó vào file main.cpp (thay YOUR_SCRIPT_ID)
  * 
  * 9. Cũng thay đổi WIFI_SSID và WIFI_PASSWORD trong main.cpp
+ * 
+ * ESP32 gửi log theo lô bằng POST (doPost), body dạng:
+ *    {"rows":[["DOOR_OPEN","PASSWORD","ADMIN","SUCCESS",28.5,65,"8f3a12c0",42,1760680000,1,0], ...]}
+ * Các cột sau độ ẩm: mã lần khởi động (boot), số thứ tự (seq), giờ Unix lúc
+ * xảy ra (ts), số lần lặp (count) và số giây từ lần đầu (span).
+ * count > 1: chuỗi lỗi giống nhau đã được ESP32 gộp lại; Timestamp là lần
+ * cuối, cột First là lần đầu.
+ * doGet vẫn giữ để gửi tay từng dòng / tương thích firmware cũ
+ * (tham số boot, seq, ts, count, span là tùy chọn).
+ *
+ * Timestamp là giờ sự kiện xảy ra trên ESP32 (ts = 0 -> giờ nhận).
+ * Bản ghi trùng (ESP32 gửi lại sau khi mất phản hồi) bị bỏ theo (boot, seq):
+ * trong một lần khởi động ESP32 gửi theo đúng thứ tự seq, nên script chỉ
+ * cần nhớ seq lớn nhất đã ghi của mỗi boot. Chỉ giữ MAX_BOOTS boot dùng gần
+ * nhất trong 1 Script Property (LAST_SEQ_KEY), boot cũ hơn bị bỏ: mỗi lần
+ * ESP32 khởi động có boot mới, nhớ hết thì Script Properties đầy dần.
+ * Bản cũ lưu mỗi boot 1 property "seq_<boot>": chạy cleanupSeqProperties()
+ * 1 lần trong trình soạn Apps Script để xóa.
  */
 
-function doGet(e) {
+// Số cột ghi vào sheet (Timestamp .. First)
+var NUM_COLUMNS = 11;
+
+// Thời gian chờ khóa script (ms) khi nhiều request ghi cùng lúc
+var LOCK_TIMEOUT_MS = 10000;
+
+// Chống trùng: số boot nhớ seq, tên Script Property chứa
+// [[boot, seq], ...] (dùng gần nhất ở cuối)
+var MAX_BOOTS = 32;
+var LAST_SEQ_KEY = "lastSeq";
+
+// Định dạng giờ Việt Nam (UTC+7), date = null -> giờ hiện tại
+function vnTimestamp(date) {
+  var t = date || new Date();
+  var vnTime = new Date(t.getTime() + (7 * 60 * 60 * 1000));
+  return Utilities.formatDate(vnTime, "GMT", "dd/MM/yyyy HH:mm:ss");
+}
+
+// Giờ sự kiện từ ts (giây Unix) của ESP32, thiếu/0 -> giờ nhận.
+// agoSec: lùi lại bao nhiêu giây (lần đầu của nhóm lỗi đã gộp)
+function eventTimestamp(ts, agoSec) {
+  var sec = Number(ts);
+  var ms = (sec > 0 ? sec * 1000 : new Date().getTime()) - (Number(agoSec) || 0) * 1000;
+  return vnTimestamp(new Date(ms));
+}
+
+// Trả về response JSON
+function jsonResponse(obj) {
+  return ContentService.createTextOutput(JSON.stringify(obj))
+    .setMimeType(ContentService.MimeType.JSON);
+}
+
+function orDefault(v, def) {
+  return (v === undefined || v === null || v === "") ? def : v;
+}
+
+// Đọc danh sách [[boot, seq], ...] đã lưu, hỏng/chưa có -> rỗng
+function loadLastSeq(props) {
   try {
-    // Lấy parameters từ URL
-    var event = e.parameter.event || "UNKNOWN";
-    var method = e.parameter.method || "UNKNOWN";
-    var user = e.parameter.user || "UNKNOWN";
-    var status = e.parameter.status || "UNKNOWN";
-    var temp = e.parameter.temp || "N/A";
-    var humidity = e.parameter.humidity || "N/A";
+    var list = JSON.parse(props.getProperty(LAST_SEQ_KEY) || "[]");
+    return Array.isArray(list) ? list : [];
+  } catch (e) {
+    return [];
+  }
+}
+
+// Gộp seq mới vào danh sách: boot vừa ghi chuyển xuống cuối, bỏ boot cũ
+// nhất khi quá MAX_BOOTS
+function mergeLastSeq(list, lastSeq) {
+  var kept = list.filter(function(e) { return !(e[0] in lastSeq); });
+  for (var boot in lastSeq) kept.push([boot, lastSeq[boot]]);
+  return kept.slice(-MAX_BOOTS);
+}
+
+// Chạy tay 1 lần: xóa các property "seq_<boot>" của bản script cũ
+function cleanupSeqProperties() {
+  var props = PropertiesService.getScriptProperties();
+  var removed = 0;
+  props.getKeys().forEach(function(k) {
+    if (k.indexOf("seq_") === 0) {
+      props.deleteProperty(k);
+      removed++;
+    }
+  });
+  Logger.log("Đã xóa " + removed + " property seq_<boot>");
+}
+
+// Ghi các hàng [event, method, user, status, temp, hum, boot, seq, ts, count, span],
+// bỏ hàng trùng (boot, seq). Trả về {written, duplicates}
+function appendEvents(rows) {
+  var lock = LockService.getScriptLock();
+  lock.waitLock(LOCK_TIMEOUT_MS);
+  
+  try {
+    var props = PropertiesService.getScriptProperties();
+    var saved = loadLastSeq(props);
+    var known = {};    // boot -> seq lớn nhất đã lưu
+    saved.forEach(function(e) { known[e[0]] = Number(e[1]) || 0; });
+    var lastSeq = {};  // boot -> seq lớn nhất đã ghi (các boot có trong lô này)
+    var values = [];
+    var duplicates = 0;
+    
+    rows.forEach(function(r) {
+      var boot = orDefault(r[6], "");
+      var seq = Number(r[7]) || 0;
+      
+      // Hàng không có boot/seq (firmware cũ, gửi tay) -> luôn ghi
+      if (boot !== "" && seq > 0) {
+        var key = String(boot);
+        if (!(key in lastSeq)) lastSeq[key] = known[key] || 0;
+        if (seq <= lastSeq[key]) {
+          duplicates++;
+          return;
+        }
+        lastSeq[key] = seq;
+      }
+      
+      var count = Number(r[9]) || 1;
+      values.push([
+        eventTimestamp(r[8], 0),
+        orDefault(r[0], "UNKNOWN"),
+        orDefault(r[1], "UNKNOWN"),
+        orDefault(r[2], "UNKNOWN"),
+        orDefault(r[3], "UNKNOWN"),
+        orDefault(r[4], "N/A") + "°C",
+        orDefault(r[5], "N/A") + "%",
+        boot,
+        seq > 0 ? seq : "",
+        count,
+        count > 1 ? eventTimestamp(r[8], r[10]) : ""
+      ]);
+    });
+    
+    if (values.length > 0) {
+      var sheet = SpreadsheetApp.getActiveSpreadsheet().getActiveSheet();
+      sheet.getRange(sheet.getLastRow() + 1, 1, values.length, NUM_COLUMNS)
+        .setValues(values);
+    }
     
-    // Lấy timestamp Việt Nam (UTC+7)
-    var now = new Date();
-    var vnTime = new Date(now.getTime() + (7 * 60 * 60 * 1000));
-    var timestamp = Utilities.formatDate(vnTime, "GMT", "dd/MM/yyyy HH:mm:ss");
+    // Chỉ lưu seq sau khi đã ghi xong: ghi lỗi -> ESP32 gửi lại vẫn được nhận
+    if (Object.keys(lastSeq).length > 0) {
+      props.setProperty(LAST_SEQ_KEY, JSON.stringify(mergeLastSeq(saved, lastSeq)));
+    }
     
-    // Mở spreadsheet hiện tại
-    var sheet = SpreadsheetApp.getActiveSpreadsheet().getActiveSheet();
+    return { written: values.length, duplicates: duplicates };
+  } finally {
+    lock.releaseLock();
+  }
+}
+
+function doGet(e) {
+  try {
+    var p = e.parameter;
+    var result = appendEvents([[
+      p.event, p.method, p.user, p.status, p.temp, p.humidity, p.boot, p.seq, p.ts,
+      p.count, p.span
+    ]]);
     
-    // Thêm dữ liệu vào hàng mới
-    sheet.appendRow([
-      timestamp,
-      event,
-      method,
-      user,
-      status,
-      temp + "°C",
-      humidity + "%"
-    ]);
+    // Trả về response thành công (kể cả khi là bản ghi trùng)
+    return jsonResponse({
+      "status": "success",
+      "message": result.written ? "Data logged successfully" : "Duplicate ignored",
+      "duplicates": result.duplicates,
+      "timestamp": vnTimestamp()
+    });
     
-    // Trả về response thành công
-    return ContentService.createTextOutput(JSON.stringify({
+  } catch (error) {
+    // Trả về lỗi nếu có
+    return jsonResponse({
+      "status": "error",
+      "message": error.toString()
+    });
+  }
+}
+
+// Nhận cả lô log từ ESP32, ghi bằng 1 lần setValues()
+function doPost(e) {
+  try {
+    var data = JSON.parse(e.postData.contents);
+    var result = appendEvents(data.rows || []);
+    
+    return jsonResponse({
       "status": "success",
       "message": "Data logged successfully",
-      "timestamp": timestamp
-    })).setMimeType(ContentService.MimeType.JSON);
+      "rows": result.written,
+      "duplicates": result.duplicates,
+      "timestamp": vnTimestamp()
+    });
     
   } catch (error) {
-    // Trả về lỗi nếu có
-    return ContentService.createTextOutput(JSON.stringify({
+    return jsonResponse({
       "status": "error",
       "message": error.toString()
-    })).setMimeType(ContentService.MimeType.JSON);
+    });
   }
 }
 
@@ -89,10 +243,31 @@ function testLog() {
       user: "TEST_USER",
       status: "SUCCESS",
       temp: "28.5",
-      humidity: "65"
+      humidity: "65",
+      boot: "testlog",
+      seq: String(new Date().getTime())  // Tăng dần -> chạy lại không bị coi là trùng
     }
   };
   
   var result = doGet(e);
   Logger.log(result.getContent());
 }
+
+// Hàm test gửi lô (chạy thử trong Apps Script)
+function testBatch() {
+  var boot = "test" + new Date().getTime();  // boot mới mỗi lần chạy
+  var e = {
+    postData: {
+      contents: JSON.stringify({
+        rows: [
+          ["TEST", "SCRIPT", "TEST_USER", "SUCCESS", 28.5, 65, boot, 1, 0, 1, 0],
+          ["TEST", "SCRIPT", "TEST_USER", "FAILED", 28.6, 64, boot, 2, 0, 5, 12],  // Gộp 5 lần
+          ["TEST", "SCRIPT", "TEST_USER", "FAILED", 28.6, 64, boot, 2, 0, 5, 12]   // Trùng -> bỏ
+        ]
+      })
+    }
+  };
+  
+  var result = doPost(e);
+  Logger.log(result.getContent());
+}
@@ -0,0 +1,171 @@
+/*
+ * AS608 - Giao thức cảm biến vân tay không chặn
+ * ==============================================
+ *
+ * Thay cho Adafruit_Fingerprint: mỗi lệnh của thư viện chặn loop() tới khi
+ * có trả lời hoặc hết giờ (1 s), luồng đăng ký vân tay gọi liền nhiều lệnh.
+ * Ở đây lệnh được xếp hàng; as608Service() mỗi vòng loop() gửi lệnh đầu
+ * hàng, đọc dần các byte đã tới trong bộ đệm UART, ghép gói và gọi callback
+ * khi xong. Không hàm nào chờ cảm biến.
+ *
+ * Gói tin (datasheet AS608 / R30x):
+ *   EF 01 | địa chỉ (4) | PID (1) | độ dài (2) | dữ liệu | tổng kiểm (2)
+ *   độ dài = dữ liệu + 2, tổng kiểm = cộng các byte từ PID tới hết dữ liệu
+ *   Lệnh:     PID 01, dữ liệu = mã lệnh + tham số
+ *   Trả lời:  PID 07, dữ liệu = mã xác nhận (FINGERPRINT_*) + kết quả
+ *
+ * Mỗi loại lệnh có thời gian chờ trả lời và số lần gửi riêng (bảng trong
+ * as608.cpp). Hết giờ hoặc gói hỏng (sai tổng kiểm) -> bỏ các byte còn lại
+ * trong bộ đệm rồi gửi lại; hết lượt -> callback với FINGERPRINT_TIMEOUT /
+ * FINGERPRINT_BADPACKET. Gửi lại luôn an toàn với các lệnh dùng ở đây
+ * (chụp lại ảnh, ghi đè cùng ID, xóa lại); riêng đổi tốc độ chỉ gửi 1 lần.
+ *
+ * Callback chạy trong as608Service() (tức trong loop()), được gửi lệnh mới.
+ * Chỉ loop() dùng -> không cần khóa.
+ */
+
+#ifndef AS608_H
+#define AS608_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hal.h"
+
+// ==================== CẤU HÌNH ====================
+#define AS608_QUEUE_SIZE 8          // Lệnh chờ gửi tối đa
+#define AS608_ADDRESS 0xFFFFFFFF    // Địa chỉ mặc định của cảm biến
+#define AS608_PASSWORD 0x00000000   // Mật khẩu mặc định
+#define AS608_SEARCH_PAGES 0x00A3   // Vùng tìm: trang 0..162 (như Adafruit_Fingerprint)
+#define AS608_MAX_PAYLOAD 36        // Dữ liệu tối đa của 1 gói (ReadNotepad trả 33 byte)
+#define AS608_FRAME_MAX (AS608_MAX_PAYLOAD + 11)
+
+// ==================== GÓI TIN ====================
+#define AS608_PID_COMMAND 0x01
+#define AS608_PID_ACK 0x07
+
+// Mã lệnh
+#define AS608_CMD_GET_IMAGE 0x01
+#define AS608_CMD_IMAGE2TZ 0x02
+#define AS608_CMD_SEARCH 0x04
+#define AS608_CMD_CREATE 0x05
+#define AS608_CMD_STORE 0x06
+#define AS608_CMD_DELETE 0x0C
+#define AS608_CMD_EMPTY 0x0D
+#define AS608_CMD_SET_PARAM 0x0E
+#define AS608_CMD_READ_PARAMS 0x0F
+#define AS608_CMD_VERIFY 0x13
+#define AS608_CMD_WRITE_NOTEPAD 0x18
+#define AS608_CMD_READ_NOTEPAD 0x19
+#define AS608_CMD_FAST_SEARCH 0x1B
+#define AS608_CMD_COUNT 0x1D
+#define AS608_CMD_READ_INDEX 0x1F
+
+#define AS608_PARAM_BAUD 4          // SetSysPara: baud = 9600 x N (N = 1..12)
+#define AS608_BAUD_UNIT 9600
+#define AS608_NOTEPAD_BYTES 32      // 1 trang notepad (16 trang, flash của cảm biến)
+#define AS608_INDEX_BYTES 32        // 1 trang bảng chỉ mục = 256 ID, bit 0 của byte 0 = ID 0
+
+// Mã xác nhận (cùng giá trị với Adafruit_Fingerprint.h)
+#define FINGERPRINT_OK 0x00
+#define FINGERPRINT_PACKETRECIEVEERR 0x01
+#define FINGERPRINT_NOFINGER 0x02
+#define FINGERPRINT_IMAGEFAIL 0x03
+#define FINGERPRINT_NOTFOUND 0x09
+#define FINGERPRINT_ENROLLMISMATCH 0x0A
+#define FINGERPRINT_BADLOCATION 0x0B
+#define FINGERPRINT_PASSFAIL 0x13
+#define FINGERPRINT_FLASHERR 0x18
+#define FINGERPRINT_BADPACKET 0xFE   // Gói trả lời hỏng (đã gửi lại hết lượt)
+#define FINGERPRINT_TIMEOUT 0xFF     // Không có trả lời (đã gửi lại hết lượt)
+
+// Đóng gói: trả về số byte ghi vào out (tối đa len + 11)
+size_t as608Frame(uint8_t* out, uint8_t pid, const uint8_t* data, uint8_t len);
+
+// Ghép gói từ luồng byte, bỏ qua rác trước đầu gói EF 01
+class As608Parser {
+ public:
+  // Nạp 1 byte; true khi vừa hết 1 gói (bad = true nếu gói hỏng)
+  bool feed(uint8_t byte);
+  void reset() { pos = 0; }
+
+  uint8_t pid = 0;
+  uint8_t data[AS608_MAX_PAYLOAD];
+  uint8_t length = 0;
+  bool bad = false;
+
+ private:
+  uint16_t pos = 0;
+  uint16_t need = 0;      // Số byte dữ liệu của gói đang ghép
+  uint16_t sum = 0;
+  uint16_t check = 0;
+};
+
+// ==================== LỆNH ====================
+enum As608Op : uint8_t {
+  AS608_VERIFY,           // Kiểm tra mật khẩu (cảm biến có trả lời không)
+  AS608_GET_IMAGE,
+  AS608_IMAGE2TZ,         // arg: buffer 1 / 2
+  AS608_SEARCH,           // Tìm mẫu của buffer 1
+  AS608_FAST_SEARCH,      // HighSpeedSearch, như SEARCH
+  AS608_CREATE,           // Ghép buffer 1 + 2 thành mẫu
+  AS608_STORE,            // arg: ID
+  AS608_DELETE,           // arg: ID
+  AS608_EMPTY,
+  AS608_COUNT,
+  AS608_READ_PARAMS,      // ReadSysPara
+  AS608_SET_BAUD,         // arg: N (baud = 9600 x N), cảm biến đổi tốc độ sau khi trả lời
+  AS608_WRITE_NOTEPAD,    // arg: trang << 8 | mẫu (as608Pattern)
+  AS608_READ_NOTEPAD,     // arg: như WRITE_NOTEPAD, so dữ liệu đọc về với mẫu
+  AS608_READ_INDEX        // ReadIndexTable, arg: trang (256 ID / trang)
+};
+
+struct As608Result {
+  As608Op op;
+  uint16_t arg;           // Tham số đã gửi (buffer / ID)
+  uint8_t code;           // FINGERPRINT_*
+  uint16_t id;            // (FAST_)SEARCH: ID khớp, READ_PARAMS: số mẫu tối đa
+  uint16_t score;         // (FAST_)SEARCH: độ tin cậy, COUNT: số mẫu đã lưu,
+                          // READ_PARAMS: N của baud, READ_NOTEPAD: số byte khác mẫu,
+                          // READ_INDEX: số ID đã dùng của trang
+  const uint8_t* data;    // READ_INDEX: AS608_INDEX_BYTES byte, chỉ đọc trong callback
+  uint8_t tries;          // Số lần đã gửi
+  uint32_t sentMs;        // Lần gửi đầu tiên
+  uint32_t doneMs;
+};
+
+typedef void (*As608Callback)(const As608Result& result);
+
+// ==================== API ====================
+// Mở UART, không chờ cảm biến (gửi AS608_VERIFY để biết có cảm biến)
+void as608Begin(HalFingerPort& port, uint32_t baud);
+
+// Mở lại UART ở tốc độ khác, bỏ byte đang nhận dở. Chỉ gọi khi hàng trống
+// (dò / đổi tốc độ, as608_link.h)
+void as608SetBaud(uint32_t baud);
+uint32_t as608Baud();
+
+// Dữ liệu notepad của mẫu số seed (bit 0 / 1 xen kẽ, mỗi seed 1 mẫu khác)
+void as608Pattern(uint8_t seed, uint8_t* out);
+
+// Xếp hàng 1 lệnh; cb được gọi đúng 1 lần khi xong (có thể nullptr).
+// false nếu hàng đầy
+bool as608Submit(As608Op op, uint16_t arg, As608Callback cb);
+
+// Số lệnh chưa xong (kể cả lệnh đang chờ trả lời)
+uint8_t as608Pending();
+
+// Gửi / nhận / hết giờ, gọi mỗi vòng loop()
+void as608Service(uint32_t nowMs);
+
+// ==================== THỐNG KÊ ====================
+const char* as608OpName(As608Op op);
+
+uint32_t as608Commands();       // Lệnh đã xong
+uint32_t as608Retries();        // Lần gửi lại
+uint32_t as608Timeouts();       // Lần hết giờ chờ trả lời
+uint32_t as608BadFrames();      // Gói hỏng
+uint32_t as608Failures();       // Lệnh hết lượt gửi lại
+uint32_t as608LatencyMaxMs();   // Gửi lần đầu -> xong, lâu nhất
+
+#endif
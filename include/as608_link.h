@@ -0,0 +1,54 @@
+/*
+ * AS608 LINK - Dò / nâng tốc độ UART của cảm biến vân tay
+ * ========================================================
+ *
+ * UART2 từng mở cố định FINGER_BAUD (57600), trong khi AS608 chạy được tới
+ * 115200 (baud = 9600 x N, N lưu trong flash của cảm biến). Mỗi lệnh phải
+ * truyền gói qua dây nên tốc độ cao rút ngắn mọi lượt quét / đăng ký.
+ * as608LinkBegin() lúc khởi động:
+ *
+ *   1. Dò: VERIFY ở tốc độ đã lưu (NVS), rồi FINGER_BAUD, rồi các tốc độ
+ *      chuẩn khác, tới khi cảm biến trả lời
+ *   2. Đo khứ hồi trung bình của AS608_LINK_SAMPLES lệnh ReadSysPara
+ *   3. Tìm thấy ở tốc độ khác tốc độ đã lưu (lần đầu / thay cảm biến) và
+ *      AS608_LINK_UPGRADE: thử từng tốc độ nhanh hơn (nhanh nhất trước):
+ *      đặt tốc độ (SetSysPara), mở lại UART, kiểm tra vòng: ghi rồi đọc lại
+ *      1 trang notepad AS608_LINK_ROUNDS lần với mẫu khác nhau, ReadSysPara
+ *      báo đúng tốc độ, không lệnh nào phải gửi lại. Không đạt -> đặt lại
+ *      tốc độ cũ (dò lại nếu mất liên lạc), thử tốc độ kế tiếp
+ *   4. Đo lại khứ hồi, lưu tốc độ đang dùng vào NVS
+ *
+ * Lần khởi động sau dò trúng ngay, không ghi notepad nữa (flash của cảm
+ * biến). Bản AS608 chỉ đổi tốc độ sau khi cấp nguồn lại: kiểm tra ở tốc
+ * độ mới không có trả lời -> dò lại, vẫn chạy tốc độ cũ lần này.
+ *
+ * Chặn setup() (như kết nối WiFi): vài chục ms khi đã lưu tốc độ, vài giây
+ * nếu không có cảm biến. Gọi sau as608Begin(), trước mọi lệnh khác.
+ */
+
+#ifndef AS608_LINK_H
+#define AS608_LINK_H
+
+#include <stdint.h>
+
+#ifndef AS608_LINK_UPGRADE
+#define AS608_LINK_UPGRADE 1
+#endif
+
+// ==================== CẤU HÌNH ====================
+#define AS608_LINK_SAMPLES 8        // Số lệnh đo khứ hồi
+#define AS608_LINK_ROUNDS 4         // Số lần ghi / đọc notepad khi kiểm tra
+#define AS608_LINK_NOTEPAD_PAGE 15  // Trang notepad dùng để kiểm tra
+#define AS608_LINK_KEY "fp_baud"    // Khóa NVS
+
+// ==================== API ====================
+// true nếu cảm biến trả lời và đúng mật khẩu
+bool as608LinkBegin();
+
+uint32_t as608LinkBaud();           // 0 nếu không thấy cảm biến
+uint16_t as608LinkCapacity();       // Số mẫu tối đa (ReadSysPara)
+
+// In thống kê (lệnh Serial "stats")
+void as608LinkPrint();
+
+#endif
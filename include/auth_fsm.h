@@ -0,0 +1,125 @@
+/*
+ * AUTH FSM - Máy trạng thái xác thực / màn hình
+ * ==============================================
+ *
+ * Thay cho các cờ rời rạc (passwordVerified, fingerprintVerified,
+ * systemLocked, fingerprintLocked, guestDetected, currentDisplay...):
+ * loop() chỉ giữ 1 AuthState, các hàm xử lý không sửa trạng thái mà gửi
+ * sự kiện (AuthEvent). Bảng chuyển trạng thái [state][event] -> (state mới,
+ * hành động) là constexpr, tra O(1); thiếu / trùng ô nào là lỗi biên dịch.
+ *
+ * Bảng thuần logic: hành động (mở cửa, ghi log, hiện thông báo...) do
+ * main.cpp thực hiện theo AuthAction trả về.
+ *
+ * Chế độ Thường / 2FA không nhân đôi trạng thái: lúc phân loại đầu vào,
+ * main.cpp gửi EV_PASSWORD_OK hoặc EV_PASSWORD_OK_2FA (tương tự vân tay).
+ *
+ * Sơ đồ chính:
+ *   IDLE --số--> ENTRY --#(đúng)--> GRANTED --hết giờ mở cửa--> IDLE
+ *   2FA: IDLE/ENTRY --MK đúng--> 2FA_PASSWORD_OK --vân tay--> GRANTED
+ *        IDLE/ENTRY --vân tay--> 2FA_FINGER_OK --MK đúng--> GRANTED
+ *   Sai 3 lần: --> LOCKED (hết LOCKOUT_TIME --> IDLE)
+ *   Sai vân tay 3 lần: --> FINGER_LOCKED (chỉ MK mở được --> GRANTED)
+ *   Quá nhiệt: mọi trạng thái --> OVERHEAT (trừ LOCKED: giữ khóa)
+ */
+
+#ifndef AUTH_FSM_H
+#define AUTH_FSM_H
+
+#include <stdint.h>
+
+// ==================== CẤU HÌNH ====================
+#define LOCKOUT_TIME 30000          // Thời gian khóa sau khi sai mật khẩu (ms)
+#define TWO_FACTOR_TIMEOUT 30000    // Thời gian chờ lớp xác thực thứ 2 (ms)
+
+// ==================== TRẠNG THÁI ====================
+enum AuthState : uint8_t {
+  AUTH_IDLE,               // Màn hình chào
+  AUTH_ENTRY,              // Đang nhập mật khẩu
+  AUTH_SENSOR_INFO,        // Phím B: thông tin cảm biến
+  AUTH_UPLINK_STATS,       // Phím B lần 2: trạng thái gửi log
+  AUTH_GUEST,              // Có khách (âm thanh)
+  AUTH_2FA_PASSWORD_OK,    // 2FA: đã có mật khẩu, chờ vân tay
+  AUTH_2FA_FINGER_OK,      // 2FA: đã có vân tay, chờ mật khẩu
+  AUTH_GRANTED,            // Vừa mở cửa
+  AUTH_LOCKED,             // Khóa do nhập sai mật khẩu quá nhiều
+  AUTH_FINGER_LOCKED,      // Khóa vân tay, chỉ mở bằng mật khẩu
+  AUTH_OVERHEAT,           // Quá nhiệt, ngừng xác thực
+  AUTH_MENU,               // Menu Admin / đổi mật khẩu (uiFlow tự vẽ)
+  AUTH_STATE_COUNT
+};
+
+// ==================== SỰ KIỆN ====================
+enum AuthEvent : uint8_t {
+  // Keypad
+  EV_DIGIT,                // Phím số
+  EV_CLEAR,                // C: xóa mật khẩu đang nhập
+  EV_HOME,                 // *: về màn hình chính
+  EV_MODE,                 // A: đổi chế độ Thường / 2FA
+  EV_INFO,                 // B: xem thông tin
+  EV_MENU,                 // * hoặc D sau mật khẩu Admin
+  EV_PASSWORD_OK,          // # mật khẩu đúng, chế độ thường
+  EV_PASSWORD_OK_2FA,      // # mật khẩu đúng, chế độ 2FA
+  EV_PASSWORD_BAD,         // # mật khẩu sai
+  EV_TOO_MANY_PASSWORDS,   // Sai đủ MAX_WRONG_ATTEMPTS lần
+  // Vân tay
+  EV_FINGER_OK,            // Vân tay khớp, chế độ thường
+  EV_FINGER_OK_2FA,        // Vân tay khớp, chế độ 2FA
+  EV_FINGER_BAD,           // Vân tay không khớp
+  EV_TOO_MANY_FINGERS,     // Sai vân tay đủ MAX_WRONG_ATTEMPTS lần
+  // Hẹn giờ / cảm biến / menu
+  EV_TIMEOUT,              // Hết thời gian của trạng thái (authStateInfo().timeoutMs)
+  EV_DOOR_LOCKED,          // Cửa tự khóa lại
+  EV_SOUND,                // Có âm thanh
+  EV_GUEST_END,            // Hết thời gian đèn báo khách
+  EV_OVERHEAT,             // Nhiệt độ quá cao (gửi mỗi vòng khi còn nóng)
+  EV_COOLED,               // Nhiệt độ an toàn (gửi mỗi vòng khi đã nguội)
+  EV_MENU_DONE,            // Thoát menu
+  AUTH_EVENT_COUNT
+};
+
+// ==================== HÀNH ĐỘNG ====================
+enum AuthAction : uint8_t {
+  ACT_NONE,
+  ACT_RESET,               // Xóa mật khẩu đang nhập
+  ACT_CLEAR,               // Xóa mật khẩu + báo "Password cleared"
+  ACT_MODE,                // Đổi chế độ
+  ACT_MENU,                // Mở luồng menu đã chọn
+  ACT_UNLOCK_PASSWORD,     // Mở cửa bằng mật khẩu
+  ACT_UNLOCK_FINGER,       // Mở cửa bằng vân tay
+  ACT_UNLOCK_2FA,          // Mở cửa sau đủ 2 lớp
+  ACT_UNLOCK_OVERRIDE,     // Mở bằng mật khẩu khi vân tay bị khóa
+  ACT_2FA_PASSWORD,        // 2FA: ghi nhận mật khẩu
+  ACT_2FA_FINGER,          // 2FA: ghi nhận vân tay
+  ACT_PASSWORD_BAD,        // Đếm lần sai mật khẩu
+  ACT_LOCKOUT,             // Khóa hệ thống
+  ACT_FINGER_BAD,          // Đếm lần sai vân tay
+  ACT_FINGER_LOCK,         // Khóa vân tay
+  ACT_2FA_TIMEOUT,         // Hết thời gian 2FA
+  ACT_LOCKOUT_END,         // Hết thời gian khóa
+  ACT_SHUTDOWN,            // Quá nhiệt: thoát menu / thông báo
+  ACT_RESUME,              // Hết quá nhiệt
+  AUTH_ACTION_COUNT
+};
+
+struct AuthTransition {
+  AuthState next;
+  AuthAction action;
+};
+
+// Thuộc tính cố định của từng trạng thái
+struct AuthStateInfo {
+  bool keys;               // Keypad được xử lý (không phải menu)
+  bool finger;             // Hỏi cảm biến vân tay
+  bool fingerFast;         // Đang chờ vân tay: hỏi cảm biến nhịp nhanh (finger_poll.h)
+  uint32_t timeoutMs;      // > 0: gửi EV_TIMEOUT sau chừng này ms trong trạng thái
+};
+
+// ==================== API ====================
+const AuthTransition& authTransition(AuthState state, AuthEvent event);
+const AuthStateInfo& authStateInfo(AuthState state);
+
+const char* authStateName(AuthState state);
+const char* authEventName(AuthEvent event);
+
+#endif
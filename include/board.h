@@ -0,0 +1,65 @@
+/*
+ * BOARD - Sơ đồ chân ESP32 (xem text.txt để biết cách nối dây)
+ * Dùng chung cho main.cpp và lớp HAL ESP32 (src/hal_esp32.cpp)
+ */
+
+#ifndef BOARD_H
+#define BOARD_H
+
+// ==================== PIN DEFINITIONS ====================
+// LCD I2C
+#define LCD_SDA 21
+#define LCD_SCL 22
+#define LCD_ADDR 0x27
+
+// Fingerprint Sensor (UART2)
+#define FINGER_RX 16
+#define FINGER_TX 17
+#define FINGER_BAUD 57600
+
+// Chân chạm WAK/TCH của AS608 (Vt nối 3.3V). Mặc định -1: các bo hiện có không
+// nối chân này -> hỏi cảm biến theo nhịp của finger_poll.h. Đã nối dây thì bật
+// bằng build flag, vd. -DFINGER_TOUCH_PIN=39 (platformio.ini). Không bật khi
+// chưa nối: GPIO 34-39 không có điện trở kéo, chân bỏ trống bị thả nổi
+#ifndef FINGER_TOUCH_PIN
+#define FINGER_TOUCH_PIN -1
+#endif
+#define FINGER_TOUCH_ACTIVE HIGH    // Mức logic khi có ngón tay
+
+// Keypad 4x4
+#define ROW1 13
+#define ROW2 12
+#define ROW3 14
+#define ROW4 27
+#define COL1 26
+#define COL2 25
+#define COL3 33
+#define COL4 32
+
+// Relay (Door Lock) - Hiện không dùng vì chỉ có 1 relay
+#define RELAY_PIN 4
+
+// LDR Light Sensor
+#define LDR_ANALOG 34
+#define LDR_DIGITAL 35
+
+// Sound Sensor
+#define SOUND_PIN 5
+
+// DHT11 (DHT_TYPE = 11 như hằng DHT11 của thư viện DHT)
+#define DHT_PIN 15
+#define DHT_TYPE 11
+
+// LED (Đèn chiếu sáng tự động)
+#define LED_PIN 18
+
+// LED CỬA (Sáng khi mở cửa)
+#define DOOR_LED_PIN 19
+
+// LED ÂM THANH (Sáng khi có âm thanh)
+#define SOUND_LED_PIN 23
+
+// FAN/MOTOR (Quạt làm mát) - Relay nối vào D4 (cùng relay cửa)
+#define FAN_PIN 4
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * EVENT CLOCK - Thời điểm, mã lần khởi động và số thứ tự cho sự kiện
+ * ===================================================================
+ *
+ * Mỗi sự kiện được đóng dấu ngay lúc xảy ra (không phải lúc tới server):
+ *   - bootId: số ngẫu nhiên 32 bit, khác nhau mỗi lần khởi động
+ *   - seq:    tăng dần trong một lần khởi động (bắt đầu từ 1)
+ *   - epoch:  giờ Unix (UTC) từ SNTP, 0 nếu lúc đó chưa đồng bộ
+ *   - uptimeMs: millis() lúc xảy ra
+ *
+ * Script dùng (bootId, seq) để bỏ bản ghi trùng khi firmware gửi lại, và
+ * dùng epoch làm cột Timestamp nên lô gửi trễ / gửi lại từ nhật ký offline
+ * vẫn đúng giờ.
+ *
+ * Sự kiện xảy ra trước khi SNTP đồng bộ được bù giờ lúc gửi (cùng lần
+ * khởi động: epoch = giờ hiện tại - thời gian đã trôi theo millis()).
+ */
+
+#ifndef EVENT_CLOCK_H
+#define EVENT_CLOCK_H
+
+#include <stdint.h>
+
+#include "log_event.h"
+
+// ==================== CẤU HÌNH ====================
+#define EVENT_CLOCK_NTP_SERVER1 "pool.ntp.org"
+#define EVENT_CLOCK_NTP_SERVER2 "time.google.com"
+
+// Giờ Unix nhỏ hơn mốc này coi như chưa đồng bộ (14/11/2023)
+#define EVENT_CLOCK_MIN_EPOCH 1700000000u
+
+// ==================== API ====================
+// Nguồn thời gian: millis() và giờ Unix hiện tại (0 = chưa có)
+typedef uint32_t (*EventClockSource)();
+
+// Khởi tạo với mã lần khởi động và nguồn thời gian cho trước
+void eventClockBegin(uint32_t bootId, EventClockSource nowMs, EventClockSource nowEpoch);
+
+#if defined(ARDUINO)
+// ESP32: bootId ngẫu nhiên + bật SNTP chạy nền (không chờ đồng bộ)
+void eventClockBeginSntp();
+#endif
+
+// Đóng dấu sự kiện vừa tạo (bootId, seq, epoch, uptimeMs)
+void eventClockStamp(LogEvent& ev);
+
+// Gán seq mới, giữ nguyên thời điểm (sự kiện bị giữ lại rồi mới gửi,
+// vd. log_aggregate.h: seq phải tăng theo đúng thứ tự gửi đi)
+void eventClockResequence(LogEvent& ev);
+
+// Bù epoch cho sự kiện tạo trước khi đồng bộ giờ (chỉ cùng lần khởi động)
+void eventClockResolve(LogEvent& ev);
+
+uint32_t eventClockBootId();
+bool eventClockSynced();
+
+#endif
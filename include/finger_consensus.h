@@ -0,0 +1,80 @@
+/*
+ * FINGER CONSENSUS - Xác thực vân tay nhiều mẫu, giới hạn thời gian
+ * =================================================================
+ *
+ * Trước: 1 lần tìm NOTFOUND = 1 lần sai, 3 lần sai -> khóa vân tay
+ * (fingerprintLocked). Ngón khô / ướt / đặt lệch cho ảnh kém -> chủ nhà bị
+ * khóa oan. main1.cpp thử lại tới MAX_RETRY_ATTEMPTS lần nhưng chặn loop()
+ * bằng delay(RETRY_DELAY).
+ *
+ * Mỗi lần chạm mở 1 phiên (getImage OK đầu tiên): tối đa
+ * FINGER_CONSENSUS_SAMPLES mẫu (getImage -> image2Tz -> fingerMatch) trong
+ * FINGER_CONSENSUS_BUDGET_MS, mẫu sau cách mẫu trước FINGER_CONSENSUS_RETRY_MS:
+ *   - 1 mẫu khớp đủ CONFIDENCE_THRESHOLD (finger_match.h) -> chấp nhận ngay,
+ *     quét sạch không chậm thêm chút nào
+ *   - mẫu dưới ngưỡng chỉ là mẫu trượt, dù nhiều mẫu cùng khớp 1 ID: khóa
+ *     cửa không hạ ngưỡng bằng cách gộp các lần khớp yếu
+ *   - đủ số mẫu / hết thời gian mà chưa chấp nhận -> mới tính 1 lần sai
+ *   - hết thời gian mà chưa mẫu nào tìm xong (ảnh hỏng, lỗi UART) -> bỏ
+ *     phiên, không tính sai
+ * Kết luận xong phải nhấc tay (getImage NOFINGER) mới mở phiên mới: ngón
+ * tay để yên sau khi mở cửa không bị tính thêm lần sai.
+ *
+ * Chỉ là logic, không gửi lệnh AS608: main.cpp báo từng mẫu và hỏi kết
+ * luận, chạy được trên máy tính với AS608 giả ("finger <n> [độ tin cậy]").
+ *
+ * Đếm (lệnh Serial "stats"): số phiên, chấp nhận ở mẫu đầu / sau mẫu trượt
+ * (trước đây là 1 lần sai), từ chối, bỏ, thời gian từ lúc
+ * chạm tới kết luận (TB / lâu nhất) của chấp nhận và từ chối.
+ *
+ * Chỉ loop() dùng -> không cần khóa.
+ */
+
+#ifndef FINGER_CONSENSUS_H
+#define FINGER_CONSENSUS_H
+
+#include <stdint.h>
+
+#include "as608.h"
+
+// ==================== CẤU HÌNH ====================
+#define FINGER_CONSENSUS_SAMPLES 3        // MAX_RETRY_ATTEMPTS (main1.cpp)
+#define FINGER_CONSENSUS_BUDGET_MS 2500   // Từ lúc chạm tới kết luận
+#define FINGER_CONSENSUS_RETRY_MS 100     // RETRY_DELAY (main1.cpp)
+
+enum FingerVerdict : uint8_t {
+  FINGER_VERDICT_PENDING,   // Chưa kết luận (không có phiên / chờ mẫu kế tiếp)
+  FINGER_VERDICT_ACCEPT,    // fingerConsensusId() / Score()
+  FINGER_VERDICT_REJECT,    // Tính 1 lần sai
+  FINGER_VERDICT_DROP       // Bỏ phiên, không tính
+};
+
+// ==================== API ====================
+// getImage OK: mở phiên nếu chưa có. false nếu vẫn là lần chạm đã kết luận
+// (chưa nhấc tay) -> không lấy mẫu
+bool fingerConsensusStart(uint32_t nowMs);
+
+// getImage NOFINGER: đã nhấc tay
+void fingerConsensusLifted();
+
+// Kết quả fingerMatch() của 1 mẫu. PENDING: lấy thêm mẫu
+FingerVerdict fingerConsensusSample(const As608Result& result, uint32_t nowMs);
+
+// Hết thời gian của phiên -> REJECT / DROP, còn lại PENDING
+FingerVerdict fingerConsensusCheck(uint32_t nowMs);
+
+bool fingerConsensusActive();
+bool fingerConsensusDue(uint32_t nowMs);  // Tới lúc lấy mẫu kế tiếp
+uint8_t fingerConsensusSamples();         // Số mẫu đã tìm xong của phiên
+
+// Kết quả của lần ACCEPT gần nhất
+uint16_t fingerConsensusId();
+uint16_t fingerConsensusScore();
+
+// Bỏ phiên (khóa, vào menu...), không tính
+void fingerConsensusCancel();
+
+// In thống kê (lệnh Serial "stats")
+void fingerConsensusPrint();
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * FINGER MATCH - Tìm vân tay: tìm nhanh trước, tìm đầy đủ khi cần
+ * =================================================================
+ *
+ * AS608 có 2 lệnh tìm mẫu của buffer 1 trong thư viện:
+ *   Search (0x04)           so lần lượt từng mẫu, lâu dần theo số mẫu đã lưu
+ *   HighSpeedSearch (0x1B)  nhanh hơn nhiều, nhưng với ảnh kém (ngón khô /
+ *                           ướt, đặt lệch) có thể trượt hoặc độ tin cậy thấp
+ * main.cpp từng chỉ dùng Search, main1.cpp chỉ dùng HighSpeedSearch.
+ *
+ * fingerMatch(): HighSpeedSearch trước; trượt (NOTFOUND) hoặc độ tin cậy
+ * dưới CONFIDENCE_THRESHOLD -> Search. Kết quả cuối vẫn dưới ngưỡng -> trả
+ * về FINGERPRINT_NOTFOUND (như main1.cpp, main.cpp cũ không xét ngưỡng).
+ * Lỗi giao tiếp (hết giờ, gói hỏng) không tìm lại.
+ *
+ * Đếm riêng từng cách tìm (lệnh Serial "stats"): số lần, trúng (khớp đủ
+ * ngưỡng), trượt, độ tin cậy thấp, thời gian TB / lâu nhất; cùng số lần
+ * phải tìm đầy đủ và số lần tìm đầy đủ cứu được -> chỉnh ngưỡng, hoặc bỏ
+ * tìm nhanh nếu hầu như lần nào cũng phải tìm lại.
+ *
+ * Build flag FINGER_MATCH_FAST=0: chỉ dùng Search (để so sánh).
+ * Chỉ loop() dùng, mỗi lúc 1 lượt tìm -> không cần khóa.
+ */
+
+#ifndef FINGER_MATCH_H
+#define FINGER_MATCH_H
+
+#include <stdint.h>
+
+#include "as608.h"
+
+#ifndef FINGER_MATCH_FAST
+#define FINGER_MATCH_FAST 1
+#endif
+
+// ==================== CẤU HÌNH ====================
+#define CONFIDENCE_THRESHOLD 60     // Độ tin cậy tối thiểu (main1.cpp)
+
+enum FingerMatchKind : uint8_t {
+  FINGER_MATCH_QUICK,               // HighSpeedSearch
+  FINGER_MATCH_FULL                 // Search
+};
+
+// ==================== API ====================
+// Tìm mẫu của buffer 1 (đã image2Tz). done nhận kết quả cuối: FINGERPRINT_OK
+// (id, score đủ ngưỡng) / NOTFOUND (score > 0: khớp id nhưng dưới ngưỡng) /
+// lỗi giao tiếp; sentMs = lúc bắt đầu tìm
+void fingerMatch(As608Callback done);
+
+// In thống kê (lệnh Serial "stats")
+void fingerMatchPrint();
+
+#endif
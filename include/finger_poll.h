@@ -0,0 +1,67 @@
+/*
+ * FINGER POLL - Nhịp hỏi cảm biến AS608 theo dấu hiệu có người
+ * =============================================================
+ *
+ * Mỗi getImage() là 1 lệnh UART (~60 ms). Hỏi liên tục tốn tải cảm biến,
+ * hỏi thưa (main1.cpp: 500 ms cố định) làm chậm phản hồi. Nhịp hỏi:
+ *
+ *   Nối chân WAK (finger_touch.h): chỉ hỏi khi có chạm, mỗi vòng loop()
+ *   Không nối chân WAK:
+ *     FAST  FINGER_POLL_FAST_MS  - trong FINGER_POLL_BOOST_MS sau tiếng động
+ *                                  / nhấn phím, hoặc đang chờ vân tay (2FA)
+ *     IDLE  FINGER_POLL_IDLE_MS  - rảnh, trời sáng
+ *     DARK  FINGER_POLL_DARK_MS  - rảnh, trời tối (ít khả năng có người)
+ *
+ * Đo để so sánh các cách hỏi (lệnh Serial "stats"):
+ *   - số lệnh getImage / giờ
+ *   - độ trễ chạm -> phát hiện (getImage OK lần đầu của 1 lần chạm):
+ *     có chân WAK: tính từ cạnh chạm; không có: tính từ lần hỏi cuối
+ *     còn trống (cận trên - ngón tay đặt lên sau lần hỏi đó)
+ *
+ * Chỉ loop() dùng -> không cần khóa.
+ */
+
+#ifndef FINGER_POLL_H
+#define FINGER_POLL_H
+
+#include <stdint.h>
+
+// ==================== CẤU HÌNH ====================
+#define FINGER_POLL_FAST_MS 100
+#define FINGER_POLL_IDLE_MS 500
+#define FINGER_POLL_DARK_MS 2000
+#define FINGER_POLL_BOOST_MS 15000   // Giữ nhịp nhanh sau tiếng động / phím
+
+enum FingerPollMode : uint8_t {
+  FINGER_POLL_TOUCH,                // Theo chân WAK
+  FINGER_POLL_FAST,
+  FINGER_POLL_IDLE,
+  FINGER_POLL_DARK
+};
+
+// ==================== API ====================
+// Có dấu hiệu người tới gần (tiếng động, nhấn phím)
+void fingerPollBoost(uint32_t nowMs);
+
+// true nếu nên gửi getImage() lúc này.
+// expecting: đang chờ vân tay (2FA), dark: trời tối
+bool fingerPollDue(uint32_t nowMs, bool expecting, bool dark);
+
+// Thời gian tới lần hỏi kế tiếp theo nhịp hiện tại (giờ dậy khi ngủ nhẹ).
+// UINT32_MAX khi nối chân WAK (chạm tự đánh thức)
+uint32_t fingerPollWaitMs(uint32_t nowMs);
+
+// Kết quả 1 lệnh getImage() gửi lúc sentMs (fingerOn: FINGERPRINT_OK).
+// Gọi sau mỗi lệnh, kể cả lệnh của luồng đăng ký vân tay
+void fingerPollResult(uint32_t sentMs, uint32_t nowMs, bool fingerOn);
+
+// ==================== THỐNG KÊ ====================
+FingerPollMode fingerPollMode();
+const char* fingerPollModeName(FingerPollMode mode);
+
+uint32_t fingerPollCommands();                     // Tổng lệnh getImage
+uint32_t fingerPollCommandsPerHour(uint32_t nowMs); // Trung bình từ lúc khởi động
+uint32_t fingerPollDetects();                       // Số lần chạm đã phát hiện
+uint32_t fingerPollLatencyAvgMs();                  // Trễ chạm -> phát hiện trung bình
+
+#endif
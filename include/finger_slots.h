@@ -0,0 +1,53 @@
+/*
+ * FINGER SLOTS - Bảng ID vân tay đã dùng trong RAM
+ * ================================================
+ *
+ * Trước: "4: Xem số vân tay" gửi TemplateNum qua UART mỗi lần, còn nhập ID
+ * để đăng ký / xóa không biết ID đó đã có người chưa -> Admin ghi đè vân
+ * tay của người khác mà không hay.
+ *
+ * Lúc khởi động đọc bảng chỉ mục của AS608 (ReadIndexTable 0x1F, 1 bit /
+ * ID, 256 ID / trang, đủ số trang cho số mẫu tối đa của as608_link.h) vào
+ * 1 bitmap. Sau đó main.cpp báo kết quả storeModel / deleteModel /
+ * emptyDatabase (fingerSlotsNote) để cập nhật bitmap: đếm, hỏi ID đã dùng,
+ * tìm ID trống không gửi gì qua UART.
+ *
+ * Lệnh ghi / xóa không có trả lời (hết giờ, gói hỏng): không biết cảm biến
+ * đã làm chưa -> đọc lại cả bảng. Trong lúc đọc (hoặc đọc lỗi)
+ * fingerSlotsReady() = false, main.cpp hỏi cảm biến như cũ.
+ *
+ * Chỉ loop() dùng -> không cần khóa.
+ */
+
+#ifndef FINGER_SLOTS_H
+#define FINGER_SLOTS_H
+
+#include <stdint.h>
+
+#include "as608.h"
+
+// ==================== CẤU HÌNH ====================
+#define FINGER_SLOTS_MAX 1024       // 4 trang bảng chỉ mục, 128 byte RAM
+
+// ==================== API ====================
+// Đọc bảng chỉ mục (capacity ID, 0 = 1 trang) qua hàng lệnh AS608, không chặn. done
+// (có thể nullptr) nhận kết quả trang cuối, score = số ID đã dùng. Gọi khi đang
+// đọc -> đọc lại sau lượt này; done = nullptr thì giữ done của lượt đang đọc
+void fingerSlotsLoad(uint16_t capacity, As608Callback done);
+
+// Bitmap khớp với cảm biến
+bool fingerSlotsReady();
+
+// Kết quả lệnh storeModel / deleteModel / emptyDatabase (lệnh khác bỏ qua)
+void fingerSlotsNote(const As608Result& result);
+
+uint16_t fingerSlotsCount();
+bool fingerSlotsUsed(uint16_t id);
+
+// ID trống nhỏ nhất trong [from, to], 0 nếu đã đầy
+uint16_t fingerSlotsFirstFree(uint16_t from, uint16_t to);
+
+// In thống kê (lệnh Serial "stats")
+void fingerSlotsPrint();
+
+#endif
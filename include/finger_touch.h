@@ -0,0 +1,44 @@
+/*
+ * FINGER TOUCH - Ngắt từ chân chạm (WAK/TCH) của cảm biến AS608
+ * ==============================================================
+ *
+ * Mạch cảm ứng của AS608 (cấp nguồn qua chân Vt) báo có ngón tay trên
+ * chân WAK mà không cần lệnh UART. Ngắt cạnh ở chân này đưa thời điểm
+ * chạm vào SpscRing (ring_buffer.h: ISR ghi, loop() đọc), loop() chỉ gửi
+ * lệnh getImage() khi:
+ *   - chân WAK đang báo có ngón tay, hoặc
+ *   - vừa có cạnh chạm trong FINGER_TOUCH_WINDOW_MS (chạm nhanh rồi nhấc)
+ *
+ * Khi rảnh không còn lệnh UART nào tới cảm biến. Không nối chân WAK ->
+ * fingerTouchBegin(-1, ...) và loop() hỏi cảm biến mỗi vòng như cũ.
+ */
+
+#ifndef FINGER_TOUCH_H
+#define FINGER_TOUCH_H
+
+#include <stdint.h>
+
+// ==================== CẤU HÌNH ====================
+// Sau cạnh chạm, tiếp tục hỏi cảm biến trong khoảng này (ms)
+#define FINGER_TOUCH_WINDOW_MS 1500
+
+// Số cạnh chạm chờ loop() đọc (lũy thừa của 2, đầy thì bỏ - chỉ cần cạnh mới nhất)
+#define FINGER_TOUCH_RING_LEN 4
+
+// ==================== API ====================
+// pin < 0: không nối chân WAK. activeLevel: mức logic khi có ngón tay
+void fingerTouchBegin(int8_t pin, uint8_t activeLevel);
+
+// true nếu nên hỏi cảm biến lúc này (luôn true khi không nối chân WAK).
+// Chỉ gọi từ loop()
+bool fingerTouchWanted(uint32_t nowMs);
+
+bool fingerTouchEnabled();
+
+// Số lần chạm (cạnh) đã nhận
+uint32_t fingerTouchCount();
+
+// Thời điểm cạnh chạm gần nhất (đã đọc qua fingerTouchWanted())
+uint32_t fingerTouchLastMs();
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * HAL - Lớp giao tiếp phần cứng mỏng
+ * ===================================
+ *
+ * main.cpp (xác thực, tự động hóa, giao diện) không gọi thẳng thư viện
+ * Arduino nữa mà chỉ dùng các giao diện dưới đây:
+ *   - Đồng hồ, GPIO: hàm tự do (gọi rất nhiều chỗ, như millis())
+ *   - LCD, keypad, vân tay, DHT11, WiFi, Serial: lớp giao diện
+ *   - Khởi động nhật ký offline / uplink / đồng hồ sự kiện theo nền tảng
+ *
+ * Hai bản cài đặt, chọn lúc biên dịch (giống uplink.cpp, event_clock.cpp):
+ *   - src/hal_esp32.cpp  (ARDUINO): LiquidCrystal_I2C, Keypad, UART2 (AS608),
+ *                                   DHT, WiFi, Serial
+ *   - src/hal_native.cpp (máy tính, [env:native]): thiết bị giả + đồng hồ mô
+ *                                   phỏng, có main() chạy setup()/loop() theo kịch bản
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+// Hằng số Arduino dùng trong main.cpp
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define RISING 1
+#define FALLING 2
+#define IRAM_ATTR
+#endif
+
+// ==================== ĐỒNG HỒ ====================
+uint32_t halMillis();
+uint32_t halMicros();
+void halDelay(uint32_t ms);
+
+// ==================== GPIO ====================
+typedef void (*HalIsr)();
+
+void halPinMode(uint8_t pin, uint8_t mode);
+void halDigitalWrite(uint8_t pin, uint8_t level);
+int halDigitalRead(uint8_t pin);
+int halAnalogRead(uint8_t pin);
+
+// mode: RISING / FALLING. isr chạy trong ngắt (ESP32) -> chỉ làm việc ngắn
+void halAttachInterrupt(uint8_t pin, HalIsr isr, uint8_t mode);
+
+// ==================== NGUỒN ====================
+enum HalWakeCause : uint8_t {
+  HAL_WAKE_TIMER,          // Hết maxMs
+  HAL_WAKE_GPIO,           // Phím / chạm vân tay / âm thanh (hoặc đang ở mức đánh thức)
+  HAL_WAKE_OTHER
+};
+
+void halSetCpuMhz(uint32_t mhz);
+uint32_t halCpuMhz();
+
+// Ngủ nhẹ tối đa maxMs. Dậy sớm khi nhấn phím bất kỳ, chạm cảm biến vân tay
+// (FINGER_TOUCH_PIN) hoặc có âm thanh (SOUND_PIN) - chân lấy từ board.h.
+// Chân đang ở mức đánh thức -> trả về HAL_WAKE_GPIO ngay, không ngủ
+HalWakeCause halLightSleep(uint32_t maxMs);
+
+// ==================== LCD 16x2 ====================
+class HalDisplay {
+ public:
+  virtual void begin() = 0;
+  virtual void clear() = 0;
+  virtual void setCursor(uint8_t col, uint8_t row) = 0;
+  virtual void print(const char* text) = 0;
+
+  void print(char c);
+  void print(int value);
+  void print(float value, int digits);
+};
+
+// ==================== KEYPAD 4x4 ====================
+class HalKeypad {
+ public:
+  // Phím vừa nhấn, 0 nếu không có
+  virtual char getKey() = 0;
+};
+
+// ==================== UART CẢM BIẾN VÂN TAY AS608 ====================
+// Luồng byte thô, không chặn; gói tin / lệnh ở as608.h
+class HalFingerPort {
+ public:
+  virtual void begin(uint32_t baud) = 0;
+  virtual int read() = 0;  // Byte kế tiếp đã nhận, -1 nếu chưa có
+  virtual void write(const uint8_t* data, size_t len) = 0;
+};
+
+// ==================== DHT11 ====================
+class HalClimate {
+ public:
+  virtual void begin() = 0;
+  // NAN nếu đọc lỗi
+  virtual float readTemperature() = 0;
+  virtual float readHumidity() = 0;
+};
+
+// ==================== WIFI ====================
+class HalNetwork {
+ public:
+  virtual void begin(const char* ssid, const char* password) = 0;
+  virtual bool connected() = 0;
+  virtual const char* address() = 0;  // IP dạng chuỗi
+};
+
+// ==================== SERIAL ====================
+class HalConsole {
+ public:
+  virtual void begin(uint32_t baud) = 0;
+  virtual void write(const char* text) = 0;
+  virtual int read() = 0;  // Ký tự kế tiếp, -1 nếu chưa có
+
+  void print(const char* text) { write(text); }
+  void print(char c);
+  void print(int value);
+  void println(const char* text = "");
+  void println(char c);
+  void println(int value);
+  void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+HalDisplay& halDisplay();
+HalKeypad& halKeypad();
+HalFingerPort& halFingerPort();
+HalClimate& halClimate();
+HalNetwork& halNetwork();
+HalConsole& halConsole();
+
+// ==================== DỊCH VỤ THEO NỀN TẢNG ====================
+// ESP32: bootId ngẫu nhiên + SNTP. Máy tính: đồng hồ mô phỏng
+void halEventClockBegin();
+
+// ESP32: phân vùng flash "spiffs". Máy tính: flash giả trong RAM
+bool halJournalBegin();
+
+// ESP32: task uplink + HTTPS. Máy tính: transport giả in ra console
+bool halUplinkBegin(const char* scriptUrl);
+
+// Số nguyên giữ qua khởi động lại. ESP32: NVS (Preferences). Máy tính: RAM
+uint32_t halSettingGet(const char* key, uint32_t fallback);
+void halSettingPut(const char* key, uint32_t value);
+
+#if !defined(ARDUINO)
+// ==================== MÔ PHỎNG (MÁY TÍNH) ====================
+// Dùng chung cho main() của hal_native.cpp và test/ (pio test -e native)
+
+// Đưa chân / cảm biến giả về mặc định rồi gọi setup()
+void halSimSetup();
+
+// Chạy 1 lệnh kịch bản (xem đầu src/hal_native.cpp), vd. "wait 500", "key 1234#"
+void halSimCommand(const char* line);
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * INPUT TRACE - Ghi lại / phát lại mọi đầu vào của loop()
+ * ========================================================
+ *
+ * Ghi (ESP32 hoặc máy tính): mỗi đầu vào loop() nhận được được ghi kèm
+ * thời điểm vào bộ nhớ RAM (12 byte / bản ghi, chỉ ghi khi có gì đó xảy ra):
+ *   K  phím keypad                     (không ghi lần getKey() trả về 0)
+ *   F  lệnh AS608 + mã trả về, ID, độ tin cậy / số mẫu
+ *                                      (ghép từ gói trên UART, as608.h;
+ *                                       không ghi getImage() = NOFINGER,
+ *                                       trừ lần đầu sau khi có ngón tay)
+ *   S  số liệu DHT11 + LDR, N  tiếng động (tin từ task cảm biến)
+ *   W  trạng thái WiFi (khi đổi)
+ * cùng các hành động loop() tạo ra:
+ *   P  chân ra relay / LED / quạt (khi đổi mức)
+ *   L  sự kiện gửi Google Sheets (trước khi gộp lỗi)
+ *
+ * Lệnh Serial "trace" in bản ghi, mỗi dòng: T <ms> <loại> <arg> <a> <b> <c>
+ * "trace live" bật/tắt in ngay từng bản ghi (ghi dài hơn bộ đệm RAM).
+ * Bộ đệm đầy -> ngừng ghi (giữ phần từ lúc khởi động để phát lại được).
+ *
+ * Phát lại (chỉ [env:native]): program --replay trace.txt
+ *   Thiết bị giả được thay bằng bản ghi: mỗi đầu vào được trả về đúng lúc
+ *   đồng hồ mô phỏng tới thời điểm đã ghi; hành động P / L loop() tạo ra
+ *   được so với bản ghi (đúng thứ tự, lệch giờ <= TRACE_MAX_SKEW_MS).
+ *   Sai khác -> in ra và thoát với mã 1 (dùng làm test hồi quy).
+ *
+ * Chỉ loop() gọi các hàm dưới đây -> không cần khóa.
+ * Build flag INPUT_TRACE=0 (mặc định trên ESP32) -> không ghi gì, các hàm
+ * trace*() chỉ trả lại thiết bị / giá trị gốc.
+ */
+
+#ifndef INPUT_TRACE_H
+#define INPUT_TRACE_H
+
+#include <stdint.h>
+
+#include "hal.h"
+#include "sensors.h"
+#include "log_event.h"
+
+#ifndef INPUT_TRACE
+#define INPUT_TRACE 0
+#endif
+
+#if INPUT_TRACE
+
+// ==================== CẤU HÌNH ====================
+#if defined(ARDUINO)
+#define TRACE_RECORDS 1024        // 12 KB RAM
+#else
+#define TRACE_RECORDS 65536       // Máy tính: đủ cho bản ghi "trace live" dài
+#endif
+#define TRACE_MAX_SKEW_MS 100     // Lệch giờ tối đa của 1 hành động khi phát lại
+
+// ==================== API ====================
+// Bọc thiết bị: ghi lại kết quả (chế độ ghi) hoặc trả kết quả đã ghi (phát lại)
+HalKeypad& traceKeypad(HalKeypad& inner);
+HalFingerPort& traceFingerPort(HalFingerPort& inner);
+HalNetwork& traceNetwork(HalNetwork& inner);
+
+// Thay cho sensorsReceive() trong loop()
+bool traceSensorsReceive(SensorMsg& msg);
+
+// Hành động của loop()
+void traceOutput(uint8_t pin, uint8_t level);
+void traceLog(LogEventType event, LogMethod method, LogUser user, LogStatus status,
+              uint16_t fingerId);
+
+// Lệnh Serial "trace" / "trace live"
+void tracePrint();
+void traceSetLive(bool live);
+bool traceLive();
+
+#if !defined(ARDUINO)
+// ==================== PHÁT LẠI (MÁY TÍNH) ====================
+// Đọc bản ghi (dòng "T ..."; dòng khác bỏ qua). Gọi trước setup()
+bool traceReplayLoad(const char* path);
+
+// Có lệnh AS608 đã ghi tới hạn (vòng mô phỏng giữ chân chạm WAK)
+bool traceReplayFingerDue(uint32_t nowMs);
+
+// Thời điểm bản ghi cuối cùng (vòng mô phỏng chạy tới đây rồi dừng)
+uint32_t traceReplayEndMs();
+
+// In kết quả so sánh, trả về số sai khác
+uint32_t traceReplayReport();
+#endif
+
+#else
+
+inline HalKeypad& traceKeypad(HalKeypad& inner) { return inner; }
+inline HalFingerPort& traceFingerPort(HalFingerPort& inner) { return inner; }
+inline HalNetwork& traceNetwork(HalNetwork& inner) { return inner; }
+inline bool traceSensorsReceive(SensorMsg& msg) { return sensorsReceive(msg); }
+inline void traceOutput(uint8_t, uint8_t) {}
+inline void traceLog(LogEventType, LogMethod, LogUser, LogStatus, uint16_t) {}
+
+#endif
+
+#endif
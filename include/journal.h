@@ -0,0 +1,66 @@
+/*
+ * JOURNAL - Nhật ký sự kiện offline trên flash
+ * ============================================
+ *
+ * Khi không gửi được log (mất WiFi, lỗi HTTP), sự kiện được ghi nối tiếp
+ * vào phân vùng "spiffs" (dùng trực tiếp, không qua SPIFFS) và gửi lại
+ * theo đúng thứ tự khi có mạng.
+ *
+ * Bố cục: phân vùng chia thành các sector 4KB dùng xoay vòng.
+ *   - Đầu sector: {magic, số thứ tự sector}
+ *   - Sau đó là các ô cố định: {seq, LogEvent, crc32, consumed}
+ * Ô rỗng = 0xFF. Ghi seq+event+crc trước, đánh dấu đã gửi bằng cách
+ * ghi consumed = 0 (flash chỉ cần đổi bit 1 -> 0, không phải xóa).
+ * Mất điện giữa lúc ghi -> CRC sai -> ô bị bỏ qua khi khởi động lại.
+ *
+ * Dung lượng tự tính theo kích thước phân vùng tìm thấy, nên bảng phân
+ * vùng 8MB/16MB tự động giữ được nhiều sự kiện hơn.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "uplink.h"
+
+// ==================== CẤU HÌNH ====================
+#define JOURNAL_SECTOR_SIZE 4096
+#define JOURNAL_MAGIC 0x4A524E34  // "JRN4" (LogEvent có bootId/seq/epoch/count)
+
+// ==================== GIAO DIỆN FLASH ====================
+// Địa chỉ tính từ đầu vùng nhớ dành cho journal.
+// Có thể thay bằng flash giả (file) khi chạy trên máy tính.
+struct JournalFlash {
+  uint32_t size;  // Tổng dung lượng (bội số JOURNAL_SECTOR_SIZE)
+  bool (*read)(uint32_t addr, void* buf, size_t len);
+  bool (*write)(uint32_t addr, const void* buf, size_t len);
+  bool (*eraseSector)(uint32_t addr);
+};
+
+// ==================== API ====================
+// Khởi tạo và khôi phục trạng thái từ flash (quét các sector còn dữ liệu)
+bool journalBegin(const JournalFlash& flash);
+
+#if defined(ARDUINO)
+// Dùng phân vùng dữ liệu có nhãn label trong bảng phân vùng
+bool journalBeginPartition(const char* label = "spiffs");
+#endif
+
+bool journalReady();
+
+// Ghi nối tiếp 1 sự kiện. Đầy -> xóa sector cũ nhất (tính vào số bị mất)
+bool journalAppend(const LogEvent& ev);
+
+// Đọc tối đa max sự kiện cũ nhất (chưa đánh dấu đã gửi)
+uint8_t journalPeek(LogEvent* out, uint8_t max);
+
+// Đánh dấu n sự kiện cũ nhất đã gửi xong
+void journalConsume(uint8_t n);
+
+uint32_t journalCount();     // Số sự kiện đang chờ gửi lại
+uint32_t journalCapacity();  // Số sự kiện tối đa giữ được
+uint32_t journalLost();      // Số sự kiện bị ghi đè do đầy
+
+#endif
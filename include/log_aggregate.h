@@ -0,0 +1,48 @@
+/*
+ * LOG AGGREGATE - Gộp chuỗi lỗi giống nhau thành 1 sự kiện tổng hợp
+ * =================================================================
+ *
+ * Nhập sai PIN liên tục / quẹt vân tay bẩn tạo ra hàng loạt sự kiện
+ * FAILED giống hệt nhau đúng lúc hệ thống đang bận. Bộ gộp giữ lại
+ * sự kiện FAILED đầu tiên và chỉ đếm các lần lặp lại, rồi gửi 1 sự kiện
+ * duy nhất kèm count và khoảng thời gian (lần đầu -> lần cuối).
+ *
+ * Một nhóm được gửi khi:
+ *   - Không lặp lại trong LOG_AGG_QUIET_MS, hoặc đã kéo dài LOG_AGG_MAX_SPAN_MS
+ *   - Có sự kiện không gộp (mở cửa, SYSTEM_LOCKED, FINGER_LOCKED...) ->
+ *     các nhóm đang chờ được gửi trước, rồi sự kiện đó đi ngay, giữ
+ *     đúng thứ tự trên Sheets
+ *   - Hết ô nhớ -> gửi nhóm cũ nhất
+ */
+
+#ifndef LOG_AGGREGATE_H
+#define LOG_AGGREGATE_H
+
+#include <stdint.h>
+
+#include "log_event.h"
+
+// ==================== CẤU HÌNH ====================
+#define LOG_AGG_SLOTS 4              // Số nhóm lỗi khác nhau giữ cùng lúc
+#define LOG_AGG_QUIET_MS 5000        // Gửi nhóm khi im lặng quá thời gian này
+#define LOG_AGG_MAX_SPAN_MS 30000    // Gửi nhóm dù vẫn đang lặp lại
+
+// Nơi nhận sự kiện đã gộp (thường là uplinkLog)
+typedef bool (*LogSink)(const LogEvent& ev);
+
+// ==================== API ====================
+void logAggregateBegin(LogSink sink);
+
+// Nhận sự kiện đã đóng dấu (event_clock.h): gộp nếu là lỗi, còn lại gửi ngay
+void logAggregateSubmit(const LogEvent& ev, uint32_t nowMs);
+
+// Gửi các nhóm đã hết cửa sổ, gọi định kỳ trong loop()
+void logAggregateService(uint32_t nowMs);
+
+// Gửi ngay mọi nhóm đang chờ
+void logAggregateFlush();
+
+// Số sự kiện lỗi đã được gộp (không gửi riêng)
+uint32_t logAggregateSuppressed();
+
+#endif
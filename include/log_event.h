@@ -0,0 +1,93 @@
+/*
+ * LOG EVENT - Bản ghi sự kiện gọn và định dạng không cấp phát heap
+ * ================================================================
+ *
+ * Sự kiện được lưu bằng enum + số (vài byte) thay cho 4 String.
+ * Các hàm định dạng ghi thẳng vào buffer do người gọi cấp, không dùng
+ * String/malloc và không dùng printf cho số thực (newlib cấp phát khi
+ * định dạng %f). Nội dung ghi lên Sheets giữ nguyên như trước.
+ */
+
+#ifndef LOG_EVENT_H
+#define LOG_EVENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== ENUM ====================
+enum LogEventType : uint8_t {
+  LOG_DOOR_OPEN,
+  LOG_SYSTEM_LOCKED,
+  LOG_FINGER_LOCKED,
+  LOG_EVENT_TYPE_COUNT
+};
+
+enum LogMethod : uint8_t {
+  LOG_BY_PASSWORD,
+  LOG_BY_FINGERPRINT,
+  LOG_BY_2FA,
+  LOG_METHOD_COUNT
+};
+
+enum LogUser : uint8_t {
+  LOG_USER_UNKNOWN,
+  LOG_USER_ADMIN,
+  LOG_USER_USER,
+  LOG_USER_FINGER,      // Kèm fingerId -> "Finger_ID_<id>"
+  LOG_USER_COUNT
+};
+
+enum LogStatus : uint8_t {
+  LOG_SUCCESS,
+  LOG_SUCCESS_AFTER_FINGER_LOCK,
+  LOG_FAILED,
+  LOG_LOCKED_3_ATTEMPTS,
+  LOG_STATUS_COUNT
+};
+
+// ==================== BẢN GHI ====================
+struct LogEvent {
+  LogEventType event;
+  LogMethod method;
+  LogUser user;
+  LogStatus status;
+  uint16_t fingerId;    // Chỉ dùng khi user = LOG_USER_FINGER
+  int16_t tempTenths;   // Nhiệt độ x10 (28.5°C -> 285)
+  uint8_t humidity;     // %
+  uint16_t count;       // Số lần lặp lại đã gộp (log_aggregate.h), 1 = đơn lẻ
+
+  // Đóng dấu lúc tạo (event_clock.h), 0 = chưa đóng dấu
+  uint32_t bootId;      // Mã lần khởi động
+  uint32_t seq;         // Số thứ tự trong lần khởi động
+  uint32_t epoch;       // Giờ Unix UTC (0 = chưa đồng bộ SNTP)
+  uint32_t uptimeMs;    // millis() lúc tạo (lần cuối nếu count > 1)
+  uint32_t spanMs;      // Lần đầu -> lần cuối khi count > 1
+};
+
+// Tạo bản ghi (làm tròn nhiệt độ/độ ẩm), chưa đóng dấu thời điểm
+LogEvent logEventMake(LogEventType event, LogMethod method, LogUser user,
+                      LogStatus status, uint16_t fingerId,
+                      float temperature, float humidity);
+
+// Tên hiển thị (giống chuỗi firmware cũ gửi lên Sheets)
+const char* logEventName(LogEventType event);
+const char* logMethodName(LogMethod method);
+const char* logStatusName(LogStatus status);
+
+// ==================== ĐỊNH DẠNG ====================
+// Các hàm trả về độ dài đã ghi (không tính '\0'), hoặc -1 nếu buffer không đủ
+
+// Tên người dùng: "ADMIN", "USER", "Unknown", "Finger_ID_5"
+int logFormatUser(const LogEvent& ev, char* out, size_t outLen);
+
+// Query string cho doGet:
+// event=..&method=..&user=..&status=..&temp=..&humidity=..&boot=..&seq=..&ts=..
+// &count=..&span=..
+int logFormatQuery(const LogEvent& ev, char* out, size_t outLen);
+
+// Một hàng JSON cho doPost:
+// ["DOOR_OPEN","PASSWORD","ADMIN","SUCCESS",28.5,65,"8f3a12c0",42,1760680000,1,0]
+// (boot dạng hex, seq, giờ Unix lúc xảy ra, số lần, số giây từ lần đầu)
+int logFormatJsonRow(const LogEvent& ev, char* out, size_t outLen);
+
+#endif
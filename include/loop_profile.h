@@ -0,0 +1,71 @@
+/*
+ * LOOP PROFILE - Đo thời gian từng hàm xử lý trong loop()
+ * ========================================================
+ *
+ * Mỗi điểm đo (hàm xử lý trong loop() hoặc lệnh chặn như finger.getImage())
+ * ghi lại: số lần gọi, min / trung bình / max và histogram theo log2
+ * (ô k chứa các lần gọi mất [2^k, 2^(k+1)) us, ô 0 gồm cả < 1 us).
+ *
+ * Nguồn thời gian: thanh ghi đếm chu kỳ CCOUNT của CPU (ESP.getCycleCount(),
+ * 1 chu kỳ = 1/240 us ở 240 MHz). CCOUNT riêng từng core và quay vòng sau
+ * ~17 giây -> chỉ đo đoạn ngắn, trong cùng 1 task (loop()).
+ * powerIdle() đổi xung 240 <-> 80 MHz giữa các vòng -> số chu kỳ được đổi
+ * ra ns ngay lúc ghi theo tần số CPU khi đó (halCpuMhz()), không lúc in.
+ *
+ * Dùng:
+ *   PROFILE_CALL("readSensors", readSensors());
+ *   PROFILE_CALL("getImage", result = finger.getImage());
+ * Lệnh Serial "prof" in bảng số liệu, "prof reset" xóa số liệu.
+ *
+ * Build flag LOOP_PROFILE=0 (platformio.ini) -> PROFILE_CALL chỉ còn lệnh
+ * bên trong, không còn mã đo nào được biên dịch.
+ */
+
+#ifndef LOOP_PROFILE_H
+#define LOOP_PROFILE_H
+
+#include <stdint.h>
+
+#ifndef LOOP_PROFILE
+#define LOOP_PROFILE 1
+#endif
+
+#if LOOP_PROFILE
+
+// ==================== CẤU HÌNH ====================
+#define PROFILE_MAX_POINTS 24     // Số điểm đo tối đa
+#define PROFILE_BUCKETS 18        // Ô histogram: < 2 us ... >= 131 ms
+
+// ==================== API ====================
+// Đăng ký điểm đo (gọi 1 lần, PROFILE_CALL tự làm). Trùng tên -> dùng chung
+// điểm đo. Trả về id, hoặc PROFILE_MAX_POINTS nếu hết chỗ (bỏ qua, không đo)
+uint8_t profileRegister(const char* name);
+
+// Số đếm hiện tại của đồng hồ đo
+uint32_t profileNow();
+
+// Ghi 1 lần đo (ticks = hiệu 2 lần profileNow())
+void profileRecord(uint8_t id, uint32_t ticks);
+
+// In bảng số liệu qua Serial / xóa số liệu (giữ danh sách điểm đo)
+void profilePrint();
+void profileReset();
+
+#define PROFILE_CALL(name, call)                                   \
+  do {                                                             \
+    static const uint8_t profileId_ = profileRegister(name);       \
+    uint32_t profileStart_ = profileNow();                         \
+    call;                                                          \
+    profileRecord(profileId_, profileNow() - profileStart_);       \
+  } while (0)
+
+#else
+
+#define PROFILE_CALL(name, call) \
+  do {                           \
+    call;                        \
+  } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * POWER - Hạ xung CPU / ngủ nhẹ khi không có ai
+ * ==============================================
+ *
+ * loop() nghỉ delay(10) mỗi vòng ở 240 MHz suốt ngày đêm. Thay bằng
+ * powerIdle() cuối vòng, theo thời gian yên lặng (không phím, chạm, âm
+ * thanh, lệnh Serial):
+ *
+ *   FULL   240 MHz, delay như cũ
+ *   SLOW   sau POWER_SLOW_AFTER_MS: 80 MHz (WiFi vẫn chạy bình thường)
+ *   SLEEP  sau POWER_SLEEP_AFTER_MS, nếu loop() không còn việc dở (màn hình
+ *          chính, cửa khóa, không có log chờ gửi): ngủ nhẹ giữa các vòng,
+ *          dậy khi nhấn phím / chạm vân tay / có âm thanh (halLightSleep)
+ *          hoặc tới hạn chót gần nhất (timer_wheel, đọc DHT11, nhịp hỏi vân tay)
+ *
+ * Dậy do phím / chạm / âm thanh -> về FULL ngay. Ngủ nhẹ tắt radio: WiFi có
+ * thể rớt khi ngủ lâu, log kế tiếp đi vào nhật ký offline và WiFi tự nối lại.
+ *
+ * Đo (lệnh Serial "stats"):
+ *   - thời gian ở 240 MHz / 80 MHz / ngủ nhẹ -> dòng trung bình ước tính từ
+ *     POWER_UA_* (số liệu datasheet của chip, đo thực tế rồi sửa lại) và
+ *     phần trăm tiết kiệm so với chạy 240 MHz liên tục
+ *   - trễ dậy hẹn giờ: ngủ hẹn giờ dậy muộn hơn hạn bao nhiêu (chi phí vào
+ *     + ra chế độ ngủ)
+ *   - trễ dậy do phím / chạm / âm thanh: từ lúc halLightSleep() trả về tới
+ *     lúc thao tác đầu tiên được xử lý (powerActivity()); lần dậy mà tới lần
+ *     ngủ sau vẫn chưa có thao tác nào (chân rung, nhấc tay) đếm riêng
+ *
+ * Build flag POWER_SAVE=0: luôn FULL, chỉ delay như cũ (vẫn đếm thời gian).
+ * Chỉ loop() gọi -> không cần khóa.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+#ifndef POWER_SAVE
+#define POWER_SAVE 1
+#endif
+
+// ==================== CẤU HÌNH ====================
+#define POWER_SLOW_AFTER_MS 30000     // Yên lặng -> hạ xung
+#define POWER_SLEEP_AFTER_MS 60000    // Yên lặng -> ngủ nhẹ giữa các vòng
+#define POWER_SLEEP_MIN_MS 20         // Hạn chót gần hơn -> delay như thường
+#define POWER_LOOP_DELAY_MS 10        // Nghỉ cuối vòng khi không ngủ
+
+#define POWER_CPU_FULL_MHZ 240
+#define POWER_CPU_SLOW_MHZ 80
+
+// Dòng tiêu thụ của chip ESP32 (µA, datasheet: modem-sleep / light-sleep)
+#define POWER_UA_FULL 50000
+#define POWER_UA_SLOW 25000
+#define POWER_UA_SLEEP 800
+
+enum PowerMode : uint8_t {
+  POWER_FULL,
+  POWER_SLOW,
+  POWER_SLEEP
+};
+
+// ==================== API ====================
+void powerBegin(uint32_t nowMs);
+
+// Có người dùng (phím, chạm vân tay, âm thanh, lệnh Serial) -> về FULL.
+// Lần đầu sau khi dậy do chân đánh thức: ghi trễ dậy -> xử lý
+void powerActivity(uint32_t nowMs);
+
+// Thay cho delay cuối vòng loop(), gọi mỗi vòng (cộng thời gian từng chế độ).
+// canSleep: loop() không có việc dở; wakeMs: thời gian tới hạn chót gần nhất
+void powerIdle(uint32_t nowMs, bool canSleep, uint32_t wakeMs);
+
+PowerMode powerMode();
+
+// In thống kê (lệnh Serial "stats")
+void powerPrint(uint32_t nowMs);
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * RING BUFFER - Hàng đợi vòng không khóa giữa các task
+ * ====================================================
+ *
+ * Các task (cảm biến, điều khiển, uplink) chỉ trao đổi dữ liệu qua hai
+ * loại hàng đợi này, không dùng biến toàn cục chung:
+ *   - SpscRing: 1 task ghi, 1 task đọc (vd. task cảm biến -> loop())
+ *   - MpscRing: nhiều task ghi, 1 task đọc (vd. mọi nơi ghi log -> task uplink)
+ *
+ * Không khóa, không chặn: push() trả về false khi đầy, pop() trả về false
+ * khi rỗng. Task đọc tự quyết định cách chờ (vTaskDelay, task notification).
+ *
+ * Chỉ dùng __atomic của GCC nên biên dịch được cả trên máy tính.
+ * N phải là lũy thừa của 2 (chỉ số chạy 32 bit, lấy phần dư bằng mặt nạ).
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+
+// ==================== SPSC ====================
+// Task ghi chỉ sửa head, task đọc chỉ sửa tail -> không cần CAS
+template <typename T, uint32_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing: N phai la luy thua cua 2");
+
+ public:
+  // Chỉ gọi từ task ghi
+  bool push(const T& item) {
+    uint32_t head = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+    if (head - tail >= N) return false;
+
+    items_[head & (N - 1)] = item;
+    // Công bố phần tử sau khi đã ghi xong nội dung
+    __atomic_store_n(&head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Chỉ gọi từ task đọc
+  bool pop(T& out) {
+    uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+    if (tail == head) return false;
+
+    out = items_[tail & (N - 1)];
+    // Trả ô cho task ghi sau khi đã đọc xong
+    __atomic_store_n(&tail_, tail + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Số phần tử đang chờ (gần đúng nếu task khác đang ghi/đọc)
+  uint32_t size() const {
+    uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+    uint32_t head = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+    return head - tail;
+  }
+
+  static constexpr uint32_t capacity() { return N; }
+
+ private:
+  T items_[N];
+  uint32_t head_ = 0;   // Vị trí ghi tiếp theo
+  uint32_t tail_ = 0;   // Vị trí đọc tiếp theo
+};
+
+// ==================== MPSC ====================
+// Hàng đợi có giới hạn kiểu Vyukov: mỗi ô có số thứ tự riêng cho biết ô
+// đang trống (seq == vị trí ghi) hay đã có dữ liệu (seq == vị trí + 1).
+// Task ghi giành vị trí bằng CAS trên head rồi mới chép dữ liệu vào ô,
+// nên task đọc không bao giờ thấy ô ghi dở.
+template <typename T, uint32_t N>
+class MpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscRing: N phai la luy thua cua 2");
+
+ public:
+  MpscRing() {
+    for (uint32_t i = 0; i < N; i++) cells_[i].seq = i;
+  }
+
+  // Gọi được từ nhiều task cùng lúc
+  bool push(const T& item) {
+    uint32_t pos = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+    Cell* cell;
+    for (;;) {
+      cell = &cells_[pos & (N - 1)];
+      uint32_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+      int32_t diff = (int32_t)(seq - pos);
+      if (diff == 0) {
+        // Ô trống -> giành vị trí pos (thất bại: pos được nạp lại giá trị mới)
+        if (__atomic_compare_exchange_n(&head_, &pos, pos + 1, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // Đầy: ô vẫn còn dữ liệu của vòng trước
+      } else {
+        pos = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+      }
+    }
+
+    cell->item = item;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Chỉ gọi từ task đọc
+  bool pop(T& out) {
+    uint32_t pos = __atomic_load_n(&tail_, __ATOMIC_RELAXED);
+    Cell* cell = &cells_[pos & (N - 1)];
+    uint32_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    if ((int32_t)(seq - (pos + 1)) < 0) return false;  // Rỗng hoặc đang ghi dở
+
+    out = cell->item;
+    // Ô trống lại cho vòng sau (vị trí pos + N)
+    __atomic_store_n(&cell->seq, pos + N, __ATOMIC_RELEASE);
+    __atomic_store_n(&tail_, pos + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Số phần tử đã được giành chỗ (gồm cả ô đang ghi dở)
+  uint32_t size() const {
+    uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+    uint32_t head = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+    return head - tail;
+  }
+
+  static constexpr uint32_t capacity() { return N; }
+
+ private:
+  struct Cell {
+    uint32_t seq;
+    T item;
+  };
+
+  Cell cells_[N];
+  uint32_t head_ = 0;   // Vị trí ghi tiếp theo (các task ghi tranh nhau)
+  uint32_t tail_ = 0;   // Vị trí đọc tiếp theo (chỉ task đọc)
+};
+
+#endif
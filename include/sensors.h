@@ -0,0 +1,76 @@
+/*
+ * SENSORS - Task đọc cảm biến (DHT11, LDR, âm thanh)
+ * ===================================================
+ *
+ * Đọc DHT11 mất ~25 ms (bit-bang, có đoạn tắt ngắt) nên không đặt trong
+ * loop(). Task cảm biến chạy trên core 0 cùng task uplink, chỉ gửi kết
+ * quả sang loop() (core 1) qua SpscRing (ring_buffer.h):
+ *   - SENSOR_CLIMATE: nhiệt độ, độ ẩm, ánh sáng mỗi SENSOR_CLIMATE_MS
+ *   - SENSOR_SOUND:   có âm thanh (ngắt cạnh lên ở chân âm thanh đánh thức
+ *                     task; tiếng kéo dài báo lại mỗi SENSOR_SOUND_REPEAT_MS)
+ *
+ * Tiếng kéo dài: chân rung (nhiều cạnh lên) được gộp lại; chân giữ HIGH thì
+ * không còn cạnh nào -> task xem lại mức chân mỗi SENSOR_SOUND_REPEAT_MS
+ * chừng nào chân còn HIGH. Ngoài lúc đó, giữa các lần đọc DHT11 task ngủ
+ * hẳn, không hỏi chân âm thanh định kỳ.
+ * loop() ngủ nhẹ (power.h) thì gọi sensorsWake() sau khi dậy.
+ *
+ * loop() giữ bản sao số liệu của riêng nó; hai task không dùng chung biến.
+ */
+
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <stdint.h>
+
+#include "hal.h"
+
+// ==================== CẤU HÌNH ====================
+#define SENSOR_CLIMATE_MS 2000        // Chu kỳ đọc DHT11 + LDR
+#define SENSOR_SOUND_REPEAT_MS 1000   // Còn tiếng -> báo lại / xem lại chân sau khoảng này
+
+// Số tin nhắn chờ loop() đọc (lũy thừa của 2)
+#define SENSOR_RING_LEN 8
+
+// Stack và độ ưu tiên: cao hơn task uplink để TLS không làm trễ lấy mẫu
+#define SENSOR_TASK_STACK 3072
+#define SENSOR_TASK_PRIORITY 2
+#define SENSOR_TASK_CORE 0
+
+// ==================== TIN NHẮN ====================
+enum SensorMsgKind : uint8_t {
+  SENSOR_CLIMATE,
+  SENSOR_SOUND
+};
+
+struct SensorMsg {
+  SensorMsgKind kind;
+  uint32_t atMs;        // millis() lúc đọc
+  float temperature;    // NAN nếu DHT11 đọc lỗi (giữ giá trị cũ)
+  float humidity;
+  int lightLevel;       // analogRead() của LDR
+};
+
+// ==================== API ====================
+// Khởi tạo chân cảm biến và tạo task (gọi 1 lần trong setup())
+bool sensorsBegin(HalClimate& climate, uint8_t ldrPin, uint8_t soundPin);
+
+#if !defined(ARDUINO)
+// Máy tính (không có task): đọc cảm biến nếu đến hạn, gọi định kỳ
+void sensorsService(uint32_t nowMs);
+#endif
+
+// Lấy tin nhắn kế tiếp, false nếu không còn (chỉ gọi từ loop())
+bool sensorsReceive(SensorMsg& msg);
+
+// Số tin nhắn bị bỏ do loop() đọc không kịp
+uint32_t sensorsDropped();
+
+// Thời gian tới lần đọc DHT11 kế tiếp (giờ dậy khi ngủ nhẹ)
+uint32_t sensorsNextMs(uint32_t nowMs);
+
+// Vừa dậy sau ngủ nhẹ: task xem lại hạn đọc DHT11 và chân âm thanh
+// (cạnh âm thanh lúc ngủ không gọi ngắt)
+void sensorsWake();
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * TIMER WHEEL - Hẹn giờ phân tầng cho mọi hạn chót của loop()
+ * ===========================================================
+ *
+ * Thay cho các cặp "xxxStartTime + so sánh millis() mỗi vòng" rải trong
+ * từng hàm xử lý: hàm nào cần hạn chót thì timerArm() / timerCancel(),
+ * loop() gọi timerService() 1 lần, callback chỉ chạy khi đã tới hạn.
+ *
+ * 3 tầng x 64 ô, mỗi nấc TIMER_TICK_MS:
+ *   tầng 0: 10 ms / ô  -> tới 640 ms
+ *   tầng 1: 640 ms / ô -> tới 41 s
+ *   tầng 2: 41 s / ô   -> tới 43 phút (xa hơn: đặt ở ô cuối, tự dời lại)
+ * Gắn / hủy O(1). Mỗi nấc chỉ xem 1 ô tầng 0; khi tầng dưới quay hết vòng
+ * mới chuyển 1 ô của tầng trên xuống (cascade). Không có hẹn giờ nào ->
+ * timerService() chỉ cộng đồng hồ.
+ *
+ * Tràn millis() (49.7 ngày): bánh xe đếm nấc riêng, chỉ dùng hiệu
+ * nowMs - mốc trước (số không dấu) nên không bị ảnh hưởng.
+ *
+ * Callback không bao giờ chạy sớm, muộn tối đa 1 nấc + độ dài 1 vòng loop().
+ * Callback được gắn lại / hủy hẹn giờ bất kỳ (kể cả chính nó).
+ * Chỉ loop() dùng -> không cần khóa.
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+// ==================== CẤU HÌNH ====================
+#define TIMER_TICK_MS 10
+#define TIMER_WHEEL_BITS 6          // 64 ô / tầng
+#define TIMER_WHEEL_LEVELS 3
+
+typedef void (*TimerCallback)();
+
+struct Timer {
+  explicit Timer(TimerCallback cb) : next(nullptr), pprev(nullptr), expires(0), fn(cb) {}
+
+  Timer* next;
+  Timer** pprev;                    // nullptr: chưa gắn
+  uint32_t expires;                 // Nấc tới hạn
+  TimerCallback fn;
+};
+
+// ==================== API ====================
+// Mốc thời gian ban đầu, gọi 1 lần trước khi gắn hẹn giờ
+void timerBegin(uint32_t nowMs);
+
+// Gọi fn sau ít nhất delayMs (đang gắn -> dời hạn mới)
+void timerArm(Timer& t, uint32_t nowMs, uint32_t delayMs);
+void timerCancel(Timer& t);
+bool timerArmed(const Timer& t);
+
+// Thời gian còn lại tới hạn (0 nếu chưa gắn)
+uint32_t timerRemainingMs(const Timer& t, uint32_t nowMs);
+
+// Chạy callback của các hẹn giờ đã tới hạn, gọi mỗi vòng loop()
+void timerService(uint32_t nowMs);
+
+// Thời gian tới lần timerService() kế tiếp có việc (callback hoặc cascade),
+// không muộn hơn hạn thật -> dùng làm giờ dậy khi ngủ. UINT32_MAX: không có hẹn giờ
+uint32_t timerNextMs(uint32_t nowMs);
+
+// Số hẹn giờ đang gắn
+uint16_t timerCount();
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * UPLINK - Gửi log lên Google Sheets bất đồng bộ
+ * ==============================================
+ *
+ * Các hàm xác thực chỉ đưa một bản ghi nhỏ vào hàng đợi không khóa
+ * (MpscRing, ring_buffer.h), task uplink riêng (FreeRTOS, core 0) lấy ra
+ * và thực hiện HTTP request.
+ * Nhờ vậy relay mở cửa ngay, không phải chờ TLS/HTTP 1-3 giây.
+ *
+ * Các sự kiện được gom thành lô và gửi bằng 1 POST (JSON) tới doPost()
+ * trong GoogleAppsScript.js, script ghi cả lô bằng 1 lần setValues().
+ *
+ * Gửi thất bại (mất WiFi, lỗi HTTP) -> lô được ghi vào nhật ký offline
+ * trên flash (journal.h) và gửi lại theo đúng thứ tự khi có mạng.
+ */
+
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "log_event.h"
+
+// ==================== CẤU HÌNH ====================
+// Số sự kiện tối đa chờ gửi (hàng đợi đầy -> bỏ sự kiện mới), lũy thừa của 2
+#define UPLINK_QUEUE_LEN 16
+
+// Gom lô: gửi khi đủ N sự kiện hoặc sự kiện đầu tiên đã chờ T ms
+#define UPLINK_BATCH_MAX 8
+#define UPLINK_BATCH_WINDOW_MS 2000
+
+// Kích thước tối đa body JSON của một lô (1 hàng dài nhất ~140 byte)
+#define UPLINK_BODY_LEN 1536
+
+// Chu kỳ thử gửi lại nhật ký offline (ms)
+#define UPLINK_RETRY_MS 5000
+
+// Lô đầu nhật ký bị script báo {"status":"error"} bấy nhiêu lần liền -> bỏ lô
+// (lỗi có thể tạm thời, vd. hết giờ chờ lock, nên không bỏ ngay lần đầu)
+#define UPLINK_SCRIPT_ERROR_MAX 3
+
+// Stack và độ ưu tiên của task uplink (TLS cần stack lớn)
+#define UPLINK_TASK_STACK 8192
+#define UPLINK_TASK_PRIORITY 1
+#define UPLINK_TASK_CORE 0
+
+// ==================== LÔ SỰ KIỆN ====================
+// Bản ghi sự kiện: LogEvent (log_event.h)
+struct UplinkBatch {
+  LogEvent events[UPLINK_BATCH_MAX];
+  uint32_t queuedMs[UPLINK_BATCH_MAX];  // Lúc vào hàng đợi (0 = từ nhật ký)
+  uint8_t count;
+  uint32_t firstMs;     // Thời điểm sự kiện đầu tiên vào lô
+};
+
+// Hàm gửi HTTP POST, trả về HTTP code (> 0) hoặc mã lỗi (<= 0).
+// accepted = script trả {"status":"success"}: doPost gặp exception vẫn trả
+// HTTP 200 với {"status":"error"} -> lô chưa được ghi.
+// Có thể thay bằng bản giả lập khi chạy trên máy tính.
+typedef int (*UplinkTransport)(const char* url, const char* body, size_t len, bool* accepted);
+
+// uplinkDeliver: không tạo được body (lô quá lớn) -> bỏ lô, không gửi lại.
+// HTTP 4xx cũng bỏ lô (gửi lại vẫn bị từ chối, nhật ký sẽ kẹt ở lô này).
+// Ngoài dải mã lỗi của HTTPClient (-1 .. -11)
+#define UPLINK_BODY_ERROR (-1000)
+
+// ==================== API ====================
+// Khởi tạo hàng đợi và task uplink.
+// transport = nullptr -> dùng kết nối HTTPS giữ lâu dài (uplink_conn.h)
+bool uplinkBegin(const char* scriptUrl, UplinkTransport transport = nullptr);
+
+// Đưa sự kiện vào hàng đợi, trả về ngay (false nếu hàng đợi đầy).
+// Gọi được từ nhiều task (không gọi trong ISR)
+bool uplinkLog(const LogEvent& ev);
+
+// Gửi cả lô đồng bộ qua transport, trả về HTTP code hoặc UPLINK_BODY_ERROR.
+// accepted (có thể nullptr) = script báo ghi thành công
+int uplinkDeliver(const UplinkBatch& batch, bool* accepted = nullptr);
+
+// Gửi lô (thất bại -> ghi vào nhật ký offline) rồi làm rỗng lô.
+// nowMs dùng để tính độ trễ hàng đợi -> xác nhận (uplink_metrics.h)
+void uplinkFlush(UplinkBatch& batch, uint32_t nowMs);
+
+// Gửi lại các sự kiện trong nhật ký offline, false nếu còn lỗi.
+// Lô không bao giờ gửi được (4xx, script lỗi UPLINK_SCRIPT_ERROR_MAX lần)
+// bị bỏ để các lô sau không kẹt theo
+bool uplinkReplay();
+
+// Lô đã đến lúc gửi chưa (đủ N sự kiện hoặc quá T ms)
+bool uplinkBatchDue(const UplinkBatch& batch, uint32_t nowMs);
+
+// Tạo body JSON {"rows":[[event,method,user,status,temp,hum,boot,seq,ts,count,span],...]}
+// Trả về độ dài body, hoặc -1 nếu buffer không đủ
+int uplinkBuildBody(const UplinkBatch& batch, char* out, size_t outLen);
+
+#if !defined(ARDUINO)
+// Máy tính (không có task): gửi lô nếu đã đến hạn, gọi định kỳ
+void uplinkService(uint32_t nowMs);
+#endif
+
+// Số sự kiện đang chờ và số sự kiện bị bỏ do hàng đợi đầy
+uint32_t uplinkPending();
+uint32_t uplinkDropped();
+
+// Còn việc gửi: sự kiện trong hàng đợi, lô task đã lấy ra / đang POST, hoặc
+// nhật ký offline chưa gửi hết (main.cpp không hạ xung / ngủ nhẹ khi bận)
+bool uplinkBusy();
+
+#endif
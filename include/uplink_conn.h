@@ -0,0 +1,79 @@
+/*
+ * UPLINK CONNECTION - Giữ kết nối HTTPS lâu dài cho task uplink
+ * ==============================================================
+ *
+ * Mỗi host (script.google.com và script.googleusercontent.com sau khi
+ * redirect) có một WiFiClientSecure riêng, được giữ mở (keep-alive) giữa
+ * các lô log. Chỉ bắt tay TLS lại khi kết nối bị đóng hoặc để rỗi quá
+ * lâu; nếu gửi trên kết nối cũ thất bại thì kết nối lại và thử 1 lần nữa.
+ *
+ * Redirect của Apps Script: doPost đã chạy xong trước khi server trả 302,
+ * bước GET sang script.googleusercontent.com chỉ để lấy nội dung trả về.
+ * Uplink tự "học": sau UPLINK_REDIRECT_LEARN lần theo redirect và nhận
+ * {"status":"success"}, nó ghi nhớ tiền tố URL redirect và coi 302 có
+ * Location đúng tiền tố đó là đã nhận log (bỏ 1 round trip). Cứ
+ * UPLINK_REDIRECT_VERIFY_EVERY lần lại theo redirect một lần để kiểm tra;
+ * nếu kết quả không thành công thì quay về chế độ luôn theo redirect.
+ * 302 tới nơi khác (vd. trang đăng nhập Google) luôn được theo để kiểm tra.
+ *
+ * Chỉ task uplink gọi các hàm này (không cần khóa).
+ */
+
+#ifndef UPLINK_CONN_H
+#define UPLINK_CONN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CẤU HÌNH ====================
+// Số host giữ kết nối cùng lúc (mỗi kết nối TLS tốn ~40KB heap)
+#define UPLINK_CONN_POOL 2
+
+// Kết nối rỗi lâu hơn -> chủ động kết nối lại (server thường đã đóng)
+#define UPLINK_CONN_IDLE_MS 50000
+
+// Timeout kết nối / đọc phản hồi (ms)
+#define UPLINK_CONN_TIMEOUT_MS 8000
+
+// 1 = học và bỏ qua bước theo redirect, 0 = luôn theo redirect
+#define UPLINK_TRUST_REDIRECT 1
+
+// Số lần theo redirect thành công liên tiếp trước khi tin 302
+#define UPLINK_REDIRECT_LEARN 3
+
+// Khi đã tin 302: cứ N lô lại theo redirect 1 lần để kiểm tra
+#define UPLINK_REDIRECT_VERIFY_EVERY 20
+
+// ==================== THỐNG KÊ ====================
+struct UplinkConnStats {
+  uint32_t requests;          // Số HTTP request đã gửi
+  uint32_t handshakes;        // Số lần bắt tay TLS (kết nối mới)
+  uint32_t reused;            // Số request dùng lại kết nối có sẵn
+  uint32_t reconnects;        // Số lần kết nối cũ hỏng phải kết nối lại
+  uint32_t handshakeMsTotal;  // Tổng thời gian bắt tay TLS
+  uint32_t lastHandshakeMs;
+
+  // So sánh độ trễ: theo redirect và chấp nhận ngay 302
+  uint32_t redirectsFollowed;
+  uint32_t followMsTotal;
+  uint32_t redirectsAccepted;
+  uint32_t acceptMsTotal;
+};
+
+// ==================== API ====================
+// Transport cho uplink: POST body, tự xử lý redirect của Apps Script.
+// accepted = body trả về có {"status":"success"} (hoặc 302 đã học)
+int uplinkConnPost(const char* url, const char* body, size_t len, bool* accepted);
+
+// Đóng mọi kết nối (ví dụ khi mất WiFi)
+void uplinkConnReset();
+
+const UplinkConnStats& uplinkConnStats();
+
+// Thời gian ước tính đã tiết kiệm nhờ dùng lại kết nối (ms)
+uint32_t uplinkConnSavedMs();
+
+// Đã học được tiền tố redirect và đang chấp nhận ngay 302 hay chưa
+bool uplinkConnRedirectTrusted();
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * UPLINK METRICS - Thống kê tình trạng gửi log
+ * ============================================
+ *
+ * Đếm số sự kiện vào hàng đợi / bị bỏ / đã gửi / ghi vào nhật ký offline,
+ * phân loại HTTP code, số lần gửi lại, và histogram độ trễ từ lúc đưa vào
+ * hàng đợi tới lúc server xác nhận (bucket cố định, không cấp phát).
+ *
+ * Xem qua lệnh Serial "stats" hoặc trang LCD (nhấn B hai lần).
+ * Các bộ đếm là uint32_t, mỗi bộ đếm chỉ do 1 task ghi -> không cần khóa.
+ */
+
+#ifndef UPLINK_METRICS_H
+#define UPLINK_METRICS_H
+
+#include <stdint.h>
+
+// ==================== HISTOGRAM ĐỘ TRỄ ====================
+// Cận trên (ms) của từng bucket, bucket cuối = lớn hơn tất cả
+#define UPLINK_LATENCY_BUCKETS 10
+extern const uint32_t UPLINK_LATENCY_BOUNDS_MS[UPLINK_LATENCY_BUCKETS - 1];
+
+struct UplinkMetrics {
+  // Hàng đợi (task chính ghi)
+  uint32_t enqueued;
+  uint32_t dropped;           // Hàng đợi đầy
+  uint32_t queueHighWater;    // Độ sâu hàng đợi lớn nhất từng thấy
+
+  // Gửi (task uplink ghi)
+  uint32_t delivered;         // Sự kiện đã được server xác nhận
+  uint32_t spooled;           // Sự kiện ghi vào nhật ký offline
+  uint32_t replayed;          // Sự kiện gửi lại thành công từ nhật ký
+  uint32_t retries;           // Số lần thử gửi lại lô từ nhật ký
+  uint32_t discarded;         // Sự kiện bị bỏ: quá lớn, 4xx, script lỗi mãi
+  uint32_t scriptErrors;      // Lô HTTP OK nhưng script báo {"status":"error"}
+  uint32_t http2xx;
+  uint32_t http3xx;
+  uint32_t http4xx;
+  uint32_t http5xx;
+  uint32_t httpError;         // Lỗi kết nối / timeout (code <= 0)
+
+  uint32_t latency[UPLINK_LATENCY_BUCKETS];
+  uint32_t latencyCount;
+  uint32_t latencyMaxMs;
+  uint32_t latencySumMs;
+};
+
+extern UplinkMetrics uplinkMetrics;
+
+// ==================== GHI NHẬN ====================
+void metricsRecordEnqueue(uint32_t queueDepth);
+void metricsRecordHttp(int httpCode);
+void metricsRecordLatency(uint32_t ms);
+
+// ==================== TRA CỨU ====================
+// Phân vị độ trễ (vd. 95) -> cận trên của bucket chứa phân vị đó (ms).
+// Trả về 0 nếu chưa có dữ liệu, UINT32_MAX nếu rơi vào bucket cuối
+uint32_t metricsLatencyPercentile(uint8_t percent);
+
+// In toàn bộ thống kê (kèm độ sâu hàng đợi và nhật ký hiện tại)
+void metricsPrint(uint32_t queueDepth, uint32_t journalBacklog);
+
+#endif
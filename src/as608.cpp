@@ -0,0 +1,370 @@
+/*
+ * AS608 - Giao thức cảm biến vân tay không chặn
+ * Xem include/as608.h
+ */
+
+#include "as608.h"
+
+// ==================== BẢNG LỆNH ====================
+// Thời gian chờ tính từ lúc gửi: truyền gói (57600 baud ~2 ms, notepad ở 9600
+// baud ~50 ms) + cảm biến xử lý (chụp ảnh / trích đặc trưng ~0.1-0.5 s, tìm
+// trong thư viện tới 1 s)
+struct As608OpInfo {
+  const char* name;
+  uint8_t cmd;
+  uint16_t timeoutMs;
+  uint8_t tries;          // Số lần gửi tối đa (kể cả lần đầu)
+};
+
+static const As608OpInfo OPS[] = {
+  { "verify",        AS608_CMD_VERIFY,        300,  3 },
+  { "getImage",      AS608_CMD_GET_IMAGE,     500,  2 },
+  { "image2Tz",      AS608_CMD_IMAGE2TZ,      800,  2 },
+  { "search",        AS608_CMD_SEARCH,        1500, 2 },
+  { "fastSearch",    AS608_CMD_FAST_SEARCH,   1000, 2 },
+  { "createModel",   AS608_CMD_CREATE,        800,  2 },
+  { "storeModel",    AS608_CMD_STORE,         1000, 2 },
+  { "deleteModel",   AS608_CMD_DELETE,        1000, 2 },
+  { "emptyDatabase", AS608_CMD_EMPTY,         2000, 2 },
+  { "templateCount", AS608_CMD_COUNT,         300,  2 },
+  { "readSysPara",   AS608_CMD_READ_PARAMS,   300,  2 },
+  { "setBaud",       AS608_CMD_SET_PARAM,     500,  1 },  // Gửi lại ở tốc độ cũ: vô ích
+  { "writeNotepad",  AS608_CMD_WRITE_NOTEPAD, 500,  2 },
+  { "readNotepad",   AS608_CMD_READ_NOTEPAD,  300,  2 },
+  { "readIndex",     AS608_CMD_READ_INDEX,    300,  2 },
+};
+
+// ==================== GÓI TIN ====================
+size_t as608Frame(uint8_t* out, uint8_t pid, const uint8_t* data, uint8_t len) {
+  uint16_t length = len + 2;
+  size_t n = 0;
+  out[n++] = 0xEF;
+  out[n++] = 0x01;
+  out[n++] = (uint8_t)(AS608_ADDRESS >> 24);
+  out[n++] = (uint8_t)(AS608_ADDRESS >> 16);
+  out[n++] = (uint8_t)(AS608_ADDRESS >> 8);
+  out[n++] = (uint8_t)AS608_ADDRESS;
+  out[n++] = pid;
+  out[n++] = (uint8_t)(length >> 8);
+  out[n++] = (uint8_t)length;
+
+  uint16_t sum = pid + (length >> 8) + (length & 0xFF);
+  for (uint8_t i = 0; i < len; i++) {
+    out[n++] = data[i];
+    sum += data[i];
+  }
+  out[n++] = (uint8_t)(sum >> 8);
+  out[n++] = (uint8_t)sum;
+  return n;
+}
+
+// Vị trí trong gói: 0-1 đầu gói, 2-5 địa chỉ, 6 PID, 7-8 độ dài,
+// 9.. dữ liệu, 2 byte cuối tổng kiểm
+bool As608Parser::feed(uint8_t byte) {
+  switch (pos) {
+    case 0:
+      if (byte == 0xEF) pos = 1;
+      return false;
+
+    case 1:
+      if (byte == 0x01) {
+        pos = 2;
+      } else if (byte != 0xEF) {
+        pos = 0;
+      }
+      return false;
+
+    case 2:
+    case 3:
+    case 4:
+    case 5:
+      pos++;
+      return false;
+
+    case 6:
+      pid = byte;
+      sum = byte;
+      pos++;
+      return false;
+
+    case 7:
+      need = (uint16_t)byte << 8;
+      sum += byte;
+      pos++;
+      return false;
+
+    case 8:
+      need |= byte;
+      sum += byte;
+      pos = 0;
+      // Độ dài gồm 2 byte tổng kiểm
+      if (need < 2 || need - 2 > AS608_MAX_PAYLOAD) {
+        bad = true;
+        return true;
+      }
+      need -= 2;
+      length = 0;
+      pos = 9;
+      return false;
+
+    default:
+      if (length < need) {
+        data[length++] = byte;
+        sum += byte;
+        return false;
+      }
+      if (length == need && pos == 9) {
+        check = (uint16_t)byte << 8;
+        pos = 10;
+        return false;
+      }
+      check |= byte;
+      pos = 0;
+      bad = check != sum;
+      return true;
+  }
+}
+
+// ==================== HÀNG LỆNH ====================
+struct As608Command {
+  As608Op op;
+  uint16_t arg;
+  As608Callback cb;
+  uint8_t tries;
+  uint32_t firstMs;       // Lần gửi đầu
+  uint32_t sentMs;        // Lần gửi gần nhất
+};
+
+static HalFingerPort* port = nullptr;
+static As608Parser parser;
+static uint32_t baudRate = 0;
+
+static As608Command queue[AS608_QUEUE_SIZE];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+static bool waiting = false;        // Lệnh đầu hàng đã gửi, chờ trả lời
+
+// Thống kê
+static uint32_t commands = 0;
+static uint32_t retries = 0;
+static uint32_t timeouts = 0;
+static uint32_t badFrames = 0;
+static uint32_t failures = 0;
+static uint32_t latencyMaxMs = 0;
+
+static void send(uint32_t nowMs) {
+  As608Command& c = queue[queueHead];
+  uint8_t data[AS608_MAX_PAYLOAD];
+  uint8_t len = 0;
+  data[len++] = OPS[c.op].cmd;
+
+  switch (c.op) {
+    case AS608_VERIFY:
+      data[len++] = (uint8_t)(AS608_PASSWORD >> 24);
+      data[len++] = (uint8_t)(AS608_PASSWORD >> 16);
+      data[len++] = (uint8_t)(AS608_PASSWORD >> 8);
+      data[len++] = (uint8_t)AS608_PASSWORD;
+      break;
+    case AS608_IMAGE2TZ:
+      data[len++] = (uint8_t)c.arg;
+      break;
+    case AS608_SEARCH:
+    case AS608_FAST_SEARCH:
+      data[len++] = 1;            // Buffer 1
+      data[len++] = 0;            // Trang bắt đầu
+      data[len++] = 0;
+      data[len++] = (uint8_t)(AS608_SEARCH_PAGES >> 8);
+      data[len++] = (uint8_t)AS608_SEARCH_PAGES;
+      break;
+    case AS608_STORE:
+      data[len++] = 1;            // Lưu mẫu ở buffer 1
+      data[len++] = (uint8_t)(c.arg >> 8);
+      data[len++] = (uint8_t)c.arg;
+      break;
+    case AS608_DELETE:
+      data[len++] = (uint8_t)(c.arg >> 8);
+      data[len++] = (uint8_t)c.arg;
+      data[len++] = 0;            // Xóa 1 mẫu
+      data[len++] = 1;
+      break;
+    case AS608_SET_BAUD:
+      data[len++] = AS608_PARAM_BAUD;
+      data[len++] = (uint8_t)c.arg;
+      break;
+    case AS608_WRITE_NOTEPAD:
+      data[len++] = (uint8_t)(c.arg >> 8);
+      as608Pattern((uint8_t)c.arg, data + len);
+      len += AS608_NOTEPAD_BYTES;
+      break;
+    case AS608_READ_NOTEPAD:
+      data[len++] = (uint8_t)(c.arg >> 8);
+      break;
+    case AS608_READ_INDEX:
+      data[len++] = (uint8_t)c.arg;
+      break;
+    default:
+      break;
+  }
+
+  uint8_t frame[AS608_FRAME_MAX];
+  size_t n = as608Frame(frame, AS608_PID_COMMAND, data, len);
+  if (c.tries == 0) c.firstMs = nowMs;
+  c.tries++;
+  c.sentMs = nowMs;
+  waiting = true;
+  port->write(frame, n);
+}
+
+// Bỏ lệnh đầu hàng rồi gọi callback (callback được xếp lệnh mới)
+static void finish(uint8_t code, uint16_t id, uint16_t score, uint32_t nowMs,
+                   const uint8_t* data = nullptr) {
+  As608Command c = queue[queueHead];
+  queueHead = (queueHead + 1) % AS608_QUEUE_SIZE;
+  queueCount--;
+  waiting = false;
+
+  commands++;
+  uint32_t latencyMs = nowMs - c.firstMs;
+  if (latencyMs > latencyMaxMs) latencyMaxMs = latencyMs;
+
+  if (!c.cb) return;
+  As608Result r = { c.op, c.arg, code, id, score, data, c.tries, c.firstMs, nowMs };
+  c.cb(r);
+}
+
+// Hết giờ / gói hỏng: bỏ byte còn lại (trả lời dở / muộn) rồi gửi lại
+static void retry(uint8_t failCode, uint32_t nowMs) {
+  while (port->read() >= 0) {}
+  parser.reset();
+
+  As608Command& c = queue[queueHead];
+  if (c.tries < OPS[c.op].tries) {
+    retries++;
+    send(nowMs);
+    return;
+  }
+  failures++;
+  finish(failCode, 0, 0, nowMs);
+}
+
+static void received(uint32_t nowMs) {
+  if (parser.bad) {
+    parser.bad = false;
+    badFrames++;
+    if (waiting) retry(FINGERPRINT_BADPACKET, nowMs);
+    return;
+  }
+  // Trả lời muộn của lệnh đã hết lượt / gói không phải trả lời -> bỏ
+  if (!waiting || parser.pid != AS608_PID_ACK || parser.length == 0) return;
+
+  uint16_t id = 0;
+  uint16_t score = 0;
+  const uint8_t* d = parser.data;
+  const As608Command& c = queue[queueHead];
+  if ((c.op == AS608_SEARCH || c.op == AS608_FAST_SEARCH) && parser.length >= 5) {
+    id = (uint16_t)(d[1] << 8) | d[2];
+    score = (uint16_t)(d[3] << 8) | d[4];
+  } else if (c.op == AS608_COUNT && parser.length >= 3) {
+    score = (uint16_t)(d[1] << 8) | d[2];
+  } else if (c.op == AS608_READ_PARAMS && parser.length >= 17) {
+    // Trạng thái, mã hệ thống, số mẫu tối đa, mức bảo mật, địa chỉ, cỡ gói, N của baud
+    id = (uint16_t)(d[5] << 8) | d[6];
+    score = (uint16_t)(d[15] << 8) | d[16];
+  } else if (c.op == AS608_READ_NOTEPAD && d[0] == FINGERPRINT_OK) {
+    uint8_t expect[AS608_NOTEPAD_BYTES];
+    as608Pattern((uint8_t)c.arg, expect);
+    score = AS608_NOTEPAD_BYTES;
+    for (uint8_t i = 0; i < AS608_NOTEPAD_BYTES && i + 1 < parser.length; i++) {
+      if (d[i + 1] == expect[i]) score--;
+    }
+  } else if (c.op == AS608_READ_INDEX && d[0] == FINGERPRINT_OK &&
+             parser.length >= 1 + AS608_INDEX_BYTES) {
+    for (uint8_t i = 1; i <= AS608_INDEX_BYTES; i++) {
+      for (uint8_t bits = d[i]; bits; bits &= bits - 1) score++;
+    }
+    finish(d[0], id, score, nowMs, d + 1);
+    return;
+  }
+  finish(d[0], id, score, nowMs);
+}
+
+// ==================== API ====================
+void as608Begin(HalFingerPort& p, uint32_t baud) {
+  port = &p;
+  as608SetBaud(baud);
+}
+
+void as608SetBaud(uint32_t baud) {
+  baudRate = baud;
+  port->begin(baud);
+  while (port->read() >= 0) {}
+  parser.reset();
+}
+
+uint32_t as608Baud() {
+  return baudRate;
+}
+
+void as608Pattern(uint8_t seed, uint8_t* out) {
+  for (uint8_t i = 0; i < AS608_NOTEPAD_BYTES; i++) {
+    out[i] = (uint8_t)(seed * 29 + i * 7) ^ (i & 1 ? 0xAA : 0x55);
+  }
+}
+
+bool as608Submit(As608Op op, uint16_t arg, As608Callback cb) {
+  if (queueCount >= AS608_QUEUE_SIZE) return false;
+  As608Command& c = queue[(queueHead + queueCount) % AS608_QUEUE_SIZE];
+  c = { op, arg, cb, 0, 0, 0 };
+  queueCount++;
+  return true;
+}
+
+uint8_t as608Pending() {
+  return queueCount;
+}
+
+void as608Service(uint32_t nowMs) {
+  if (!port) return;
+
+  // Đọc hết byte đã tới (callback có thể gửi lệnh kế tiếp ngay)
+  int byte;
+  while ((byte = port->read()) >= 0) {
+    if (parser.feed((uint8_t)byte)) received(nowMs);
+  }
+
+  if (waiting && nowMs - queue[queueHead].sentMs >= OPS[queue[queueHead].op].timeoutMs) {
+    timeouts++;
+    retry(FINGERPRINT_TIMEOUT, nowMs);
+  }
+
+  if (!waiting && queueCount > 0) send(nowMs);
+}
+
+// ==================== THỐNG KÊ ====================
+const char* as608OpName(As608Op op) {
+  return op < sizeof(OPS) / sizeof(OPS[0]) ? OPS[op].name : "?";
+}
+
+uint32_t as608Commands() {
+  return commands;
+}
+
+uint32_t as608Retries() {
+  return retries;
+}
+
+uint32_t as608Timeouts() {
+  return timeouts;
+}
+
+uint32_t as608BadFrames() {
+  return badFrames;
+}
+
+uint32_t as608Failures() {
+  return failures;
+}
+
+uint32_t as608LatencyMaxMs() {
+  return latencyMaxMs;
+}
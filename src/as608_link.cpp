@@ -0,0 +1,165 @@
+/*
+ * AS608 LINK - Dò / nâng tốc độ UART của cảm biến vân tay
+ * Xem include/as608_link.h
+ */
+
+#include "as608_link.h"
+#include "as608.h"
+#include "board.h"
+#include "hal.h"
+
+// Tốc độ chuẩn AS608 hỗ trợ, nhanh -> chậm
+static const uint32_t BAUDS[] = { 115200, 57600, 38400, 19200, 9600 };
+#define BAUD_COUNT (sizeof(BAUDS) / sizeof(BAUDS[0]))
+
+static uint32_t savedBaud = 0;      // Đọc từ NVS lúc khởi động
+static uint32_t foundBaud = 0;      // Dò thấy
+static uint32_t linkBaud = 0;       // Đang dùng
+static uint8_t probes = 0;          // Số tốc độ đã thử khi dò
+static uint8_t verifyCode = FINGERPRINT_TIMEOUT;
+static uint16_t capacity = 0;
+static uint32_t rttBeforeUs = 0;    // Khứ hồi TB ở tốc độ dò thấy
+static uint32_t rttAfterUs = 0;     // Khứ hồi TB ở tốc độ đang dùng
+
+// ==================== CHẠY 1 LỆNH ====================
+static As608Result result;
+static bool done = false;
+
+static void onDone(const As608Result& r) {
+  result = r;
+  done = true;
+}
+
+// Xếp lệnh rồi chờ xong (hết giờ / gửi lại do as608Service lo)
+static As608Result run(As608Op op, uint16_t arg) {
+  done = false;
+  as608Submit(op, arg, onDone);
+  while (true) {
+    as608Service(halMillis());
+    if (done) return result;
+    halDelay(1);
+  }
+}
+
+static bool answered(const As608Result& r) {
+  return r.code != FINGERPRINT_TIMEOUT && r.code != FINGERPRINT_BADPACKET;
+}
+
+// ==================== DÒ ====================
+static bool tryBaud(uint32_t baud) {
+  as608SetBaud(baud);
+  probes++;
+  As608Result r = run(AS608_VERIFY, 0);
+  if (!answered(r)) return false;
+  verifyCode = r.code;
+  return true;
+}
+
+// Thử first trước, rồi FINGER_BAUD, rồi các tốc độ còn lại
+static bool probe(uint32_t first) {
+  if (first && tryBaud(first)) return true;
+  if (first != FINGER_BAUD && tryBaud(FINGER_BAUD)) return true;
+  for (uint8_t i = 0; i < BAUD_COUNT; i++) {
+    if (BAUDS[i] != first && BAUDS[i] != FINGER_BAUD && tryBaud(BAUDS[i])) return true;
+  }
+  return false;
+}
+
+// Khứ hồi trung bình (us) của ReadSysPara, 0 nếu mất liên lạc
+static uint32_t measureRtt() {
+  uint32_t totalUs = 0;
+  for (uint8_t i = 0; i < AS608_LINK_SAMPLES; i++) {
+    uint32_t startUs = halMicros();
+    As608Result r = run(AS608_READ_PARAMS, 0);
+    if (r.code != FINGERPRINT_OK) return 0;
+    totalUs += halMicros() - startUs;
+    capacity = r.id;
+  }
+  return totalUs / AS608_LINK_SAMPLES;
+}
+
+// ==================== ĐỔI TỐC ĐỘ ====================
+// Kiểm tra vòng ở tốc độ vừa đặt: mọi lệnh trả lời ngay lần gửi đầu, đúng dữ liệu
+static bool linkCheck(uint32_t baud) {
+  for (uint8_t i = 0; i < AS608_LINK_ROUNDS; i++) {
+    uint16_t arg = (uint16_t)(AS608_LINK_NOTEPAD_PAGE << 8) | (uint8_t)(i + 1);
+    As608Result w = run(AS608_WRITE_NOTEPAD, arg);
+    if (w.code != FINGERPRINT_OK || w.tries > 1) return false;
+    As608Result r = run(AS608_READ_NOTEPAD, arg);
+    if (r.code != FINGERPRINT_OK || r.tries > 1 || r.score != 0) return false;
+  }
+  As608Result p = run(AS608_READ_PARAMS, 0);
+  return p.code == FINGERPRINT_OK && p.tries == 1 &&
+         (uint32_t)p.score * AS608_BAUD_UNIT == baud;
+}
+
+static bool upgrade(uint32_t from, uint32_t to) {
+  HalConsole& out = halConsole();
+  As608Result r = run(AS608_SET_BAUD, (uint16_t)(to / AS608_BAUD_UNIT));
+  if (r.code != FINGERPRINT_OK) {
+    out.printf("[AS608] Không đặt được %lu baud (mã 0x%02X)\n", (unsigned long)to, r.code);
+    return false;
+  }
+  as608SetBaud(to);
+  if (linkCheck(to)) return true;
+
+  out.printf("[AS608] %lu baud không qua kiểm tra vòng, về %lu baud\n",
+             (unsigned long)to, (unsigned long)from);
+  run(AS608_SET_BAUD, (uint16_t)(from / AS608_BAUD_UNIT));
+  probe(from);
+  return false;
+}
+
+// ==================== API ====================
+bool as608LinkBegin() {
+  HalConsole& out = halConsole();
+  savedBaud = halSettingGet(AS608_LINK_KEY, 0);
+  if (!probe(savedBaud)) {
+    linkBaud = 0;
+    return false;
+  }
+  if (verifyCode != FINGERPRINT_OK) {
+    linkBaud = as608Baud();
+    return false;
+  }
+
+  foundBaud = linkBaud = as608Baud();
+  rttBeforeUs = rttAfterUs = measureRtt();
+
+#if AS608_LINK_UPGRADE
+  if (foundBaud != savedBaud) {
+    for (uint8_t i = 0; i < BAUD_COUNT && BAUDS[i] > foundBaud; i++) {
+      if (upgrade(foundBaud, BAUDS[i])) break;
+    }
+    linkBaud = as608Baud();
+    if (linkBaud != foundBaud) rttAfterUs = measureRtt();
+  }
+#endif
+
+  if (linkBaud != savedBaud) halSettingPut(AS608_LINK_KEY, linkBaud);
+
+  if (linkBaud != foundBaud) {
+    out.printf("[AS608] UART: %lu -> %lu baud | Khứ hồi TB: %lu -> %lu us\n",
+               (unsigned long)foundBaud, (unsigned long)linkBaud,
+               (unsigned long)rttBeforeUs, (unsigned long)rttAfterUs);
+  } else {
+    out.printf("[AS608] UART: %lu baud (dò %u lần) | Khứ hồi TB: %lu us\n",
+               (unsigned long)linkBaud, probes, (unsigned long)rttAfterUs);
+  }
+  return true;
+}
+
+uint32_t as608LinkBaud() {
+  return linkBaud;
+}
+
+uint16_t as608LinkCapacity() {
+  return capacity;
+}
+
+void as608LinkPrint() {
+  halConsole().printf("[AS608] UART: %lu baud (lúc dò: %lu, NVS lúc khởi động: %lu) | Khứ hồi TB: %lu -> %lu us | Số mẫu tối đa: %u\n",
+                      (unsigned long)linkBaud, (unsigned long)foundBaud,
+                      (unsigned long)savedBaud, (unsigned long)rttBeforeUs,
+                      (unsigned long)rttAfterUs, capacity);
+}
@@ -0,0 +1,215 @@
+/*
+ * AUTH FSM - Bảng chuyển trạng thái xác thực / màn hình
+ * Xem include/auth_fsm.h
+ */
+
+#include "auth_fsm.h"
+
+#include <initializer_list>
+
+// ==================== BẢNG ====================
+// Dựng lúc biên dịch; mỗi ô [state][event] phải được gán đúng 1 lần
+struct AuthTable {
+  AuthTransition cells[AUTH_STATE_COUNT][AUTH_EVENT_COUNT];
+  uint8_t sets[AUTH_STATE_COUNT][AUTH_EVENT_COUNT];
+
+  constexpr AuthTable() : cells(), sets() {}
+
+  constexpr void on(AuthState state, AuthEvent event, AuthState next,
+                    AuthAction action = ACT_NONE) {
+    cells[state][event] = AuthTransition{ next, action };
+    sets[state][event]++;
+  }
+
+  // Các sự kiện giữ nguyên trạng thái, không làm gì
+  constexpr void stay(AuthState state, std::initializer_list<AuthEvent> events) {
+    for (AuthEvent event : events) on(state, event, state);
+  }
+
+  constexpr bool complete() const {
+    for (int s = 0; s < AUTH_STATE_COUNT; s++) {
+      for (int e = 0; e < AUTH_EVENT_COUNT; e++) {
+        if (sets[s][e] != 1) return false;
+      }
+    }
+    return true;
+  }
+};
+
+// Màn hình chính / nhập mật khẩu / xem thông tin / vừa mở cửa:
+// nhận mật khẩu và vân tay như nhau
+constexpr void onReady(AuthTable& t, AuthState s) {
+  t.on(s, EV_CLEAR, AUTH_ENTRY, ACT_CLEAR);
+  t.on(s, EV_HOME, AUTH_IDLE, ACT_RESET);
+  t.on(s, EV_MODE, AUTH_IDLE, ACT_MODE);
+  t.on(s, EV_MENU, AUTH_MENU, ACT_MENU);
+  t.on(s, EV_PASSWORD_OK, AUTH_GRANTED, ACT_UNLOCK_PASSWORD);
+  t.on(s, EV_PASSWORD_OK_2FA, AUTH_2FA_PASSWORD_OK, ACT_2FA_PASSWORD);
+  t.on(s, EV_PASSWORD_BAD, AUTH_ENTRY, ACT_PASSWORD_BAD);
+  t.on(s, EV_TOO_MANY_PASSWORDS, AUTH_LOCKED, ACT_LOCKOUT);
+  t.on(s, EV_FINGER_OK, AUTH_GRANTED, ACT_UNLOCK_FINGER);
+  t.on(s, EV_FINGER_OK_2FA, AUTH_2FA_FINGER_OK, ACT_2FA_FINGER);
+  t.on(s, EV_FINGER_BAD, s, ACT_FINGER_BAD);
+  t.on(s, EV_TOO_MANY_FINGERS, AUTH_FINGER_LOCKED, ACT_FINGER_LOCK);
+  t.on(s, EV_OVERHEAT, AUTH_OVERHEAT, ACT_SHUTDOWN);
+  t.stay(s, { EV_TIMEOUT, EV_COOLED, EV_MENU_DONE });
+}
+
+// 2FA đã có 1 lớp: giữ trạng thái tới khi đủ lớp thứ 2 hoặc hết giờ
+constexpr void onHalfway(AuthTable& t, AuthState s) {
+  t.on(s, EV_CLEAR, s, ACT_CLEAR);
+  t.on(s, EV_HOME, AUTH_IDLE, ACT_RESET);
+  t.on(s, EV_MODE, AUTH_IDLE, ACT_MODE);
+  t.on(s, EV_MENU, AUTH_MENU, ACT_MENU);
+  t.on(s, EV_PASSWORD_BAD, s, ACT_PASSWORD_BAD);
+  t.on(s, EV_TOO_MANY_PASSWORDS, AUTH_LOCKED, ACT_LOCKOUT);
+  t.on(s, EV_FINGER_BAD, s, ACT_FINGER_BAD);
+  t.on(s, EV_TOO_MANY_FINGERS, AUTH_FINGER_LOCKED, ACT_FINGER_LOCK);
+  t.on(s, EV_TIMEOUT, AUTH_IDLE, ACT_2FA_TIMEOUT);
+  t.on(s, EV_OVERHEAT, AUTH_OVERHEAT, ACT_SHUTDOWN);
+  // Chế độ thường không tới được đây
+  t.stay(s, { EV_DIGIT, EV_INFO, EV_PASSWORD_OK, EV_FINGER_OK, EV_DOOR_LOCKED, EV_SOUND,
+              EV_GUEST_END, EV_COOLED, EV_MENU_DONE });
+}
+
+constexpr AuthTable buildTable() {
+  AuthTable t;
+
+  onReady(t, AUTH_IDLE);
+  t.on(AUTH_IDLE, EV_DIGIT, AUTH_ENTRY);
+  t.on(AUTH_IDLE, EV_INFO, AUTH_SENSOR_INFO);
+  t.on(AUTH_IDLE, EV_SOUND, AUTH_GUEST);
+  t.stay(AUTH_IDLE, { EV_DOOR_LOCKED, EV_GUEST_END });
+
+  onReady(t, AUTH_ENTRY);
+  t.on(AUTH_ENTRY, EV_INFO, AUTH_SENSOR_INFO);
+  t.stay(AUTH_ENTRY, { EV_DIGIT, EV_DOOR_LOCKED, EV_SOUND, EV_GUEST_END });
+
+  onReady(t, AUTH_SENSOR_INFO);
+  t.on(AUTH_SENSOR_INFO, EV_DIGIT, AUTH_ENTRY);
+  t.on(AUTH_SENSOR_INFO, EV_INFO, AUTH_UPLINK_STATS);
+  t.on(AUTH_SENSOR_INFO, EV_SOUND, AUTH_GUEST);
+  t.stay(AUTH_SENSOR_INFO, { EV_DOOR_LOCKED, EV_GUEST_END });
+
+  onReady(t, AUTH_UPLINK_STATS);
+  t.on(AUTH_UPLINK_STATS, EV_DIGIT, AUTH_ENTRY);
+  t.on(AUTH_UPLINK_STATS, EV_INFO, AUTH_SENSOR_INFO);
+  t.on(AUTH_UPLINK_STATS, EV_SOUND, AUTH_GUEST);
+  t.stay(AUTH_UPLINK_STATS, { EV_DOOR_LOCKED, EV_GUEST_END });
+
+  onReady(t, AUTH_GUEST);
+  t.on(AUTH_GUEST, EV_DIGIT, AUTH_ENTRY);
+  t.on(AUTH_GUEST, EV_INFO, AUTH_SENSOR_INFO);
+  t.on(AUTH_GUEST, EV_GUEST_END, AUTH_IDLE);
+  t.stay(AUTH_GUEST, { EV_DOOR_LOCKED, EV_SOUND });
+
+  // Cửa đang mở: vẫn nhận mật khẩu / vân tay, tự về IDLE khi cửa khóa lại
+  onReady(t, AUTH_GRANTED);
+  t.on(AUTH_GRANTED, EV_INFO, AUTH_SENSOR_INFO);
+  t.on(AUTH_GRANTED, EV_DOOR_LOCKED, AUTH_IDLE, ACT_RESET);
+  t.stay(AUTH_GRANTED, { EV_DIGIT, EV_SOUND, EV_GUEST_END });
+
+  onHalfway(t, AUTH_2FA_PASSWORD_OK);
+  t.on(AUTH_2FA_PASSWORD_OK, EV_FINGER_OK_2FA, AUTH_GRANTED, ACT_UNLOCK_2FA);
+  t.stay(AUTH_2FA_PASSWORD_OK, { EV_PASSWORD_OK_2FA });
+
+  onHalfway(t, AUTH_2FA_FINGER_OK);
+  t.on(AUTH_2FA_FINGER_OK, EV_PASSWORD_OK_2FA, AUTH_GRANTED, ACT_UNLOCK_2FA);
+  t.on(AUTH_2FA_FINGER_OK, EV_FINGER_OK_2FA, AUTH_2FA_FINGER_OK, ACT_2FA_FINGER);
+
+  // Khóa: bỏ qua mọi đầu vào (kể cả quá nhiệt) tới khi hết LOCKOUT_TIME
+  t.on(AUTH_LOCKED, EV_TIMEOUT, AUTH_IDLE, ACT_LOCKOUT_END);
+  t.stay(AUTH_LOCKED, { EV_DIGIT, EV_CLEAR, EV_HOME, EV_MODE, EV_INFO, EV_MENU,
+                        EV_PASSWORD_OK, EV_PASSWORD_OK_2FA, EV_PASSWORD_BAD,
+                        EV_TOO_MANY_PASSWORDS, EV_FINGER_OK, EV_FINGER_OK_2FA, EV_FINGER_BAD,
+                        EV_TOO_MANY_FINGERS, EV_DOOR_LOCKED, EV_SOUND, EV_GUEST_END,
+                        EV_OVERHEAT, EV_COOLED, EV_MENU_DONE });
+
+  // Vân tay bị khóa: chỉ mật khẩu đúng (Admin hoặc User) mở được
+  t.on(AUTH_FINGER_LOCKED, EV_CLEAR, AUTH_FINGER_LOCKED, ACT_CLEAR);
+  t.on(AUTH_FINGER_LOCKED, EV_HOME, AUTH_FINGER_LOCKED, ACT_RESET);
+  t.on(AUTH_FINGER_LOCKED, EV_MODE, AUTH_FINGER_LOCKED, ACT_MODE);
+  t.on(AUTH_FINGER_LOCKED, EV_MENU, AUTH_FINGER_LOCKED, ACT_RESET);
+  t.on(AUTH_FINGER_LOCKED, EV_PASSWORD_OK, AUTH_GRANTED, ACT_UNLOCK_OVERRIDE);
+  t.on(AUTH_FINGER_LOCKED, EV_PASSWORD_OK_2FA, AUTH_GRANTED, ACT_UNLOCK_OVERRIDE);
+  t.on(AUTH_FINGER_LOCKED, EV_PASSWORD_BAD, AUTH_FINGER_LOCKED, ACT_PASSWORD_BAD);
+  t.on(AUTH_FINGER_LOCKED, EV_TOO_MANY_PASSWORDS, AUTH_LOCKED, ACT_LOCKOUT);
+  t.on(AUTH_FINGER_LOCKED, EV_OVERHEAT, AUTH_OVERHEAT, ACT_SHUTDOWN);
+  t.stay(AUTH_FINGER_LOCKED, { EV_DIGIT, EV_INFO, EV_FINGER_OK, EV_FINGER_OK_2FA, EV_FINGER_BAD,
+                               EV_TOO_MANY_FINGERS, EV_TIMEOUT, EV_DOOR_LOCKED, EV_SOUND,
+                               EV_GUEST_END, EV_COOLED, EV_MENU_DONE });
+
+  // Quá nhiệt: chờ nguội
+  t.on(AUTH_OVERHEAT, EV_COOLED, AUTH_IDLE, ACT_RESUME);
+  t.stay(AUTH_OVERHEAT, { EV_DIGIT, EV_CLEAR, EV_HOME, EV_MODE, EV_INFO, EV_MENU,
+                          EV_PASSWORD_OK, EV_PASSWORD_OK_2FA, EV_PASSWORD_BAD,
+                          EV_TOO_MANY_PASSWORDS, EV_FINGER_OK, EV_FINGER_OK_2FA, EV_FINGER_BAD,
+                          EV_TOO_MANY_FINGERS, EV_TIMEOUT, EV_DOOR_LOCKED, EV_SOUND,
+                          EV_GUEST_END, EV_OVERHEAT, EV_MENU_DONE });
+
+  // Menu: phím đi thẳng vào uiFlow, chỉ thoát menu hoặc quá nhiệt đổi trạng thái
+  t.on(AUTH_MENU, EV_MENU_DONE, AUTH_IDLE);
+  t.on(AUTH_MENU, EV_OVERHEAT, AUTH_OVERHEAT, ACT_SHUTDOWN);
+  t.stay(AUTH_MENU, { EV_DIGIT, EV_CLEAR, EV_HOME, EV_MODE, EV_INFO, EV_MENU,
+                      EV_PASSWORD_OK, EV_PASSWORD_OK_2FA, EV_PASSWORD_BAD,
+                      EV_TOO_MANY_PASSWORDS, EV_FINGER_OK, EV_FINGER_OK_2FA, EV_FINGER_BAD,
+                      EV_TOO_MANY_FINGERS, EV_TIMEOUT, EV_DOOR_LOCKED, EV_SOUND,
+                      EV_GUEST_END, EV_COOLED });
+
+  return t;
+}
+
+static constexpr AuthTable table = buildTable();
+static_assert(table.complete(), "Bảng AuthFsm thiếu hoặc trùng ô [state][event]");
+
+// ==================== THUỘC TÍNH TRẠNG THÁI ====================
+//                                                 keys   finger fast   timeoutMs
+static constexpr AuthStateInfo stateInfo[] = {
+  /* AUTH_IDLE            */ { true,  true,  false, 0 },
+  /* AUTH_ENTRY           */ { true,  true,  false, 0 },
+  /* AUTH_SENSOR_INFO     */ { true,  true,  false, 0 },
+  /* AUTH_UPLINK_STATS    */ { true,  true,  false, 0 },
+  /* AUTH_GUEST           */ { true,  true,  false, 0 },
+  /* AUTH_2FA_PASSWORD_OK */ { true,  true,  true,  TWO_FACTOR_TIMEOUT },
+  /* AUTH_2FA_FINGER_OK   */ { true,  true,  false, TWO_FACTOR_TIMEOUT },
+  /* AUTH_GRANTED         */ { true,  true,  false, 0 },
+  /* AUTH_LOCKED          */ { false, false, false, LOCKOUT_TIME },
+  /* AUTH_FINGER_LOCKED   */ { true,  false, false, 0 },
+  /* AUTH_OVERHEAT        */ { false, false, false, 0 },
+  /* AUTH_MENU            */ { false, false, false, 0 },
+};
+static_assert(sizeof(stateInfo) / sizeof(stateInfo[0]) == AUTH_STATE_COUNT,
+              "stateInfo phải có đủ AUTH_STATE_COUNT dòng");
+
+static const char* const stateNames[] = {
+  "IDLE", "ENTRY", "SENSOR_INFO", "UPLINK_STATS", "GUEST", "2FA_PASSWORD_OK",
+  "2FA_FINGER_OK", "GRANTED", "LOCKED", "FINGER_LOCKED", "OVERHEAT", "MENU",
+};
+static_assert(sizeof(stateNames) / sizeof(stateNames[0]) == AUTH_STATE_COUNT,
+              "stateNames phải có đủ AUTH_STATE_COUNT tên");
+
+static const char* const eventNames[] = {
+  "DIGIT", "CLEAR", "HOME", "MODE", "INFO", "MENU", "PASSWORD_OK", "PASSWORD_OK_2FA",
+  "PASSWORD_BAD", "TOO_MANY_PASSWORDS", "FINGER_OK", "FINGER_OK_2FA", "FINGER_BAD",
+  "TOO_MANY_FINGERS", "TIMEOUT", "DOOR_LOCKED", "SOUND", "GUEST_END", "OVERHEAT", "COOLED",
+  "MENU_DONE",
+};
+static_assert(sizeof(eventNames) / sizeof(eventNames[0]) == AUTH_EVENT_COUNT,
+              "eventNames phải có đủ AUTH_EVENT_COUNT tên");
+
+// ==================== API ====================
+const AuthTransition& authTransition(AuthState state, AuthEvent event) {
+  return table.cells[state][event];
+}
+
+const AuthStateInfo& authStateInfo(AuthState state) {
+  return stateInfo[state];
+}
+
+const char* authStateName(AuthState state) {
+  return state < AUTH_STATE_COUNT ? stateNames[state] : "?";
+}
+
+const char* authEventName(AuthEvent event) {
+  return event < AUTH_EVENT_COUNT ? eventNames[event] : "?";
+}
@@ -0,0 +1,83 @@
+/*
+ * EVENT CLOCK - Thời điểm, mã lần khởi động và số thứ tự cho sự kiện
+ * Xem include/event_clock.h
+ */
+
+#include "event_clock.h"
+
+#if defined(ARDUINO)
+#include "hal.h"
+
+#include <Arduino.h>
+#include <time.h>
+#endif
+
+// ==================== TRẠNG THÁI ====================
+static uint32_t clockBootId = 0;
+static uint32_t clockSeq = 0;
+static EventClockSource clockNowMs = nullptr;
+static EventClockSource clockNowEpoch = nullptr;
+
+void eventClockBegin(uint32_t bootId, EventClockSource nowMs, EventClockSource nowEpoch) {
+  clockBootId = bootId;
+  clockSeq = 0;
+  clockNowMs = nowMs;
+  clockNowEpoch = nowEpoch;
+}
+
+static uint32_t currentEpoch() {
+  uint32_t epoch = clockNowEpoch ? clockNowEpoch() : 0;
+  return epoch >= EVENT_CLOCK_MIN_EPOCH ? epoch : 0;
+}
+
+// ==================== ĐÓNG DẤU ====================
+void eventClockResequence(LogEvent& ev) {
+  ev.bootId = clockBootId;
+  // Có thể gọi từ nhiều task -> tăng nguyên tử
+  ev.seq = __atomic_add_fetch(&clockSeq, 1, __ATOMIC_RELAXED);
+}
+
+void eventClockStamp(LogEvent& ev) {
+  eventClockResequence(ev);
+  ev.uptimeMs = clockNowMs ? clockNowMs() : 0;
+  ev.epoch = currentEpoch();
+}
+
+void eventClockResolve(LogEvent& ev) {
+  if (ev.epoch != 0 || ev.bootId != clockBootId || !clockNowMs) return;
+
+  uint32_t epoch = currentEpoch();
+  if (epoch == 0) return;
+  ev.epoch = epoch - (clockNowMs() - ev.uptimeMs) / 1000;
+}
+
+uint32_t eventClockBootId() {
+  return clockBootId;
+}
+
+bool eventClockSynced() {
+  return currentEpoch() != 0;
+}
+
+#if defined(ARDUINO)
+// ==================== ESP32: SNTP ====================
+static uint32_t espNowMs() {
+  return millis();
+}
+
+static uint32_t espNowEpoch() {
+  return (uint32_t)time(nullptr);
+}
+
+void eventClockBeginSntp() {
+  // 0 là giá trị "chưa đóng dấu" -> tránh dùng làm bootId
+  uint32_t bootId = esp_random();
+  if (bootId == 0) bootId = 1;
+  eventClockBegin(bootId, espNowMs, espNowEpoch);
+
+  // Giữ đồng hồ ở UTC; script tự đổi sang giờ Việt Nam.
+  // configTime() chỉ khởi động SNTP của lwIP, đồng bộ chạy nền
+  configTime(0, 0, EVENT_CLOCK_NTP_SERVER1, EVENT_CLOCK_NTP_SERVER2);
+  halConsole().printf("[Clock] Boot ID: %08x - SNTP đang đồng bộ nền\n", (unsigned)bootId);
+}
+#endif
@@ -0,0 +1,130 @@
+/*
+ * FINGER CONSENSUS - Xác thực vân tay nhiều mẫu, giới hạn thời gian
+ * Xem include/finger_consensus.h
+ */
+
+#include "finger_consensus.h"
+#include "finger_match.h"
+#include "hal.h"
+
+// ==================== PHIÊN ====================
+static bool active = false;
+static bool touched = false;            // Lần chạm đã kết luận, chưa nhấc tay
+static uint32_t startMs = 0;            // Lúc chạm (getImage OK đầu tiên)
+static uint32_t lastMs = 0;             // Lúc mẫu trước tìm xong
+static uint8_t samples = 0;
+
+static uint16_t acceptedId = 0;
+static uint16_t acceptedScore = 0;
+
+// Thống kê
+static uint32_t sessions = 0;
+static uint32_t acceptFirst = 0;        // Khớp ngay mẫu đầu
+static uint32_t acceptRetry = 0;        // Khớp sau mẫu trượt (trước đây: 1 lần sai)
+static uint32_t rejects = 0;
+static uint32_t drops = 0;
+static uint32_t acceptTotalMs = 0;
+static uint32_t acceptMaxMs = 0;
+static uint32_t rejectTotalMs = 0;
+static uint32_t rejectMaxMs = 0;
+
+static FingerVerdict finish(FingerVerdict verdict, uint32_t nowMs) {
+  active = false;
+  touched = true;
+  uint32_t ms = nowMs - startMs;
+  if (verdict == FINGER_VERDICT_ACCEPT) {
+    acceptTotalMs += ms;
+    if (ms > acceptMaxMs) acceptMaxMs = ms;
+  } else if (verdict == FINGER_VERDICT_REJECT) {
+    rejects++;
+    rejectTotalMs += ms;
+    if (ms > rejectMaxMs) rejectMaxMs = ms;
+  } else {
+    drops++;
+  }
+  return verdict;
+}
+
+static FingerVerdict accept(uint16_t id, uint16_t score, uint32_t& counter, uint32_t nowMs) {
+  acceptedId = id;
+  acceptedScore = score;
+  counter++;
+  return finish(FINGER_VERDICT_ACCEPT, nowMs);
+}
+
+// ==================== API ====================
+bool fingerConsensusStart(uint32_t nowMs) {
+  if (active) return true;
+  if (touched) return false;
+  active = true;
+  startMs = lastMs = nowMs;
+  samples = 0;
+  sessions++;
+  return true;
+}
+
+void fingerConsensusLifted() {
+  touched = false;
+}
+
+FingerVerdict fingerConsensusSample(const As608Result& r, uint32_t nowMs) {
+  if (!active) return FINGER_VERDICT_PENDING;
+
+  // Lỗi giao tiếp: không phải 1 mẫu
+  if (r.code != FINGERPRINT_OK && r.code != FINGERPRINT_NOTFOUND) {
+    return fingerConsensusCheck(nowMs);
+  }
+  samples++;
+  lastMs = nowMs;
+
+  // Chỉ mẫu đủ ngưỡng mới mở cửa; khớp dưới ngưỡng (finger_match.h trả
+  // NOTFOUND) là mẫu trượt, không cộng dồn
+  if (r.code == FINGERPRINT_OK && r.score >= CONFIDENCE_THRESHOLD) {
+    return accept(r.id, r.score, samples == 1 ? acceptFirst : acceptRetry, nowMs);
+  }
+
+  if (samples >= FINGER_CONSENSUS_SAMPLES) return finish(FINGER_VERDICT_REJECT, nowMs);
+  return fingerConsensusCheck(nowMs);
+}
+
+FingerVerdict fingerConsensusCheck(uint32_t nowMs) {
+  if (!active || nowMs - startMs < FINGER_CONSENSUS_BUDGET_MS) return FINGER_VERDICT_PENDING;
+  return finish(samples > 0 ? FINGER_VERDICT_REJECT : FINGER_VERDICT_DROP, nowMs);
+}
+
+bool fingerConsensusActive() {
+  return active;
+}
+
+bool fingerConsensusDue(uint32_t nowMs) {
+  return active && nowMs - lastMs >= FINGER_CONSENSUS_RETRY_MS;
+}
+
+uint8_t fingerConsensusSamples() {
+  return samples;
+}
+
+uint16_t fingerConsensusId() {
+  return acceptedId;
+}
+
+uint16_t fingerConsensusScore() {
+  return acceptedScore;
+}
+
+void fingerConsensusCancel() {
+  active = false;
+}
+
+void fingerConsensusPrint() {
+  uint32_t accepts = acceptFirst + acceptRetry;
+  HalConsole& out = halConsole();
+  out.printf("[Consensus] Phiên: %u | Chấp nhận: %u (mẫu đầu: %u, sau mẫu trượt: %u) | "
+             "Từ chối: %u | Bỏ: %u\n",
+             (unsigned)sessions, (unsigned)accepts, (unsigned)acceptFirst, (unsigned)acceptRetry,
+             (unsigned)rejects, (unsigned)drops);
+  out.printf("[Consensus] Chạm -> chấp nhận TB: %u ms, lâu nhất: %u ms | Chạm -> từ chối TB: %u ms, "
+             "lâu nhất: %u ms\n",
+             (unsigned)(accepts ? acceptTotalMs / accepts : 0), (unsigned)acceptMaxMs,
+             (unsigned)(rejects ? rejectTotalMs / rejects : 0), (unsigned)rejectMaxMs);
+}
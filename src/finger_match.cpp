@@ -0,0 +1,102 @@
+/*
+ * FINGER MATCH - Tìm vân tay: tìm nhanh trước, tìm đầy đủ khi cần
+ * Xem include/finger_match.h
+ */
+
+#include "finger_match.h"
+#include "hal.h"
+
+// ==================== THỐNG KÊ ====================
+struct MatchStats {
+  uint32_t runs;
+  uint32_t hits;          // Khớp, đủ ngưỡng
+  uint32_t misses;        // NOTFOUND
+  uint32_t lowScore;      // Khớp nhưng dưới ngưỡng
+  uint32_t errors;        // Lỗi giao tiếp / lỗi khác
+  uint32_t totalMs;
+  uint32_t maxMs;
+};
+
+static MatchStats stats[2];
+static uint32_t fallbacks = 0;      // Tìm nhanh không đủ -> tìm đầy đủ
+static uint32_t rescued = 0;        // ... và tìm đầy đủ khớp đủ ngưỡng
+
+static As608Callback doneCb = nullptr;
+static uint32_t startMs = 0;
+
+static bool accepted(const As608Result& r) {
+  return r.code == FINGERPRINT_OK && r.score >= CONFIDENCE_THRESHOLD;
+}
+
+static void count(FingerMatchKind kind, const As608Result& r) {
+  MatchStats& s = stats[kind];
+  s.runs++;
+  if (accepted(r)) {
+    s.hits++;
+  } else if (r.code == FINGERPRINT_OK) {
+    s.lowScore++;
+  } else if (r.code == FINGERPRINT_NOTFOUND) {
+    s.misses++;
+  } else {
+    s.errors++;
+  }
+  uint32_t ms = r.doneMs - r.sentMs;
+  s.totalMs += ms;
+  if (ms > s.maxMs) s.maxMs = ms;
+}
+
+static void finish(const As608Result& r) {
+  As608Result out = r;
+  out.sentMs = startMs;
+  if (out.code == FINGERPRINT_OK && out.score < CONFIDENCE_THRESHOLD) {
+    halConsole().printf("[Match] Độ tin cậy thấp: ID %u, %u < %d\n", out.id, out.score,
+                        CONFIDENCE_THRESHOLD);
+    out.code = FINGERPRINT_NOTFOUND;
+  }
+  As608Callback cb = doneCb;
+  doneCb = nullptr;
+  if (cb) cb(out);
+}
+
+static void onFull(const As608Result& r) {
+  count(FINGER_MATCH_FULL, r);
+  if (FINGER_MATCH_FAST && accepted(r)) rescued++;
+  finish(r);
+}
+
+static void onQuick(const As608Result& r) {
+  count(FINGER_MATCH_QUICK, r);
+  if (accepted(r) || (r.code != FINGERPRINT_OK && r.code != FINGERPRINT_NOTFOUND)) {
+    finish(r);
+    return;
+  }
+  fallbacks++;
+  as608Submit(AS608_SEARCH, 0, onFull);
+}
+
+// ==================== API ====================
+void fingerMatch(As608Callback done) {
+  doneCb = done;
+  startMs = halMillis();
+  if (FINGER_MATCH_FAST) {
+    as608Submit(AS608_FAST_SEARCH, 0, onQuick);
+  } else {
+    as608Submit(AS608_SEARCH, 0, onFull);
+  }
+}
+
+void fingerMatchPrint() {
+  HalConsole& out = halConsole();
+  static const char* const NAMES[] = { "Nhanh", "Đầy đủ" };
+  for (uint8_t k = 0; k < 2; k++) {
+    const MatchStats& s = stats[k];
+    out.printf("[Match] %s: %u lần | Trúng: %u (%u%%) | Trượt: %u | Tin cậy thấp: %u | Lỗi: %u | "
+               "TB: %u ms, lâu nhất: %u ms\n",
+               NAMES[k], (unsigned)s.runs, (unsigned)s.hits,
+               (unsigned)(s.runs ? s.hits * 100 / s.runs : 0), (unsigned)s.misses,
+               (unsigned)s.lowScore, (unsigned)s.errors,
+               (unsigned)(s.runs ? s.totalMs / s.runs : 0), (unsigned)s.maxMs);
+  }
+  out.printf("[Match] Ngưỡng tin cậy: %d | Phải tìm đầy đủ: %u | Tìm đầy đủ cứu được: %u\n",
+             CONFIDENCE_THRESHOLD, (unsigned)fallbacks, (unsigned)rescued);
+}
@@ -0,0 +1,117 @@
+/*
+ * FINGER POLL - Nhịp hỏi cảm biến AS608 theo dấu hiệu có người
+ * Xem include/finger_poll.h
+ */
+
+#include "finger_poll.h"
+#include "finger_touch.h"
+
+// ==================== TRẠNG THÁI ====================
+static FingerPollMode mode = FINGER_POLL_IDLE;
+static bool boosted = false;
+static uint32_t boostMs = 0;        // Lần có dấu hiệu người gần nhất
+static bool polled = false;
+static uint32_t pollMs = 0;         // Lúc gửi lệnh getImage gần nhất
+static bool emptySeen = false;
+static uint32_t emptyMs = 0;        // Lúc gửi lệnh gần nhất trả về không có ngón tay
+static bool fingerOn = false;       // Lệnh gần nhất thấy ngón tay
+
+// Thống kê
+static uint32_t commands = 0;
+static uint32_t detects = 0;
+static uint32_t latencySumMs = 0;
+
+static uint32_t intervalMs(FingerPollMode m) {
+  switch (m) {
+    case FINGER_POLL_FAST: return FINGER_POLL_FAST_MS;
+    case FINGER_POLL_DARK: return FINGER_POLL_DARK_MS;
+    default: return FINGER_POLL_IDLE_MS;
+  }
+}
+
+// ==================== API ====================
+void fingerPollBoost(uint32_t nowMs) {
+  boosted = true;
+  boostMs = nowMs;
+}
+
+bool fingerPollDue(uint32_t nowMs, bool expecting, bool dark) {
+  // Có chân WAK: mạch cảm ứng báo chạm, không cần đoán
+  if (fingerTouchEnabled()) {
+    mode = FINGER_POLL_TOUCH;
+    if (!fingerTouchWanted(nowMs)) return false;
+  } else {
+    if (boosted && nowMs - boostMs >= FINGER_POLL_BOOST_MS) boosted = false;
+
+    if (boosted || expecting || fingerOn) {
+      mode = FINGER_POLL_FAST;
+    } else if (dark) {
+      mode = FINGER_POLL_DARK;
+    } else {
+      mode = FINGER_POLL_IDLE;
+    }
+    if (polled && nowMs - pollMs < intervalMs(mode)) return false;
+  }
+
+  polled = true;
+  pollMs = nowMs;
+  return true;
+}
+
+uint32_t fingerPollWaitMs(uint32_t nowMs) {
+  if (mode == FINGER_POLL_TOUCH) return UINT32_MAX;
+  uint32_t sinceMs = nowMs - pollMs;
+  return sinceMs < intervalMs(mode) ? intervalMs(mode) - sinceMs : 0;
+}
+
+void fingerPollResult(uint32_t sentMs, uint32_t nowMs, bool on) {
+  commands++;
+
+  if (!on) {
+    fingerOn = false;
+    emptySeen = true;
+    emptyMs = sentMs;
+    return;
+  }
+  if (fingerOn) return;  // Vẫn là lần chạm đã tính
+  fingerOn = true;
+
+  // Mốc chạm: cạnh WAK nếu có, không thì lần hỏi cuối còn trống
+  bool wak = fingerTouchEnabled();
+  if (wak ? fingerTouchCount() == 0 : !emptySeen) return;  // Ngón tay có sẵn lúc khởi động
+  uint32_t touchMs = wak ? fingerTouchLastMs() : emptyMs;
+  detects++;
+  latencySumMs += nowMs - touchMs;
+}
+
+// ==================== THỐNG KÊ ====================
+FingerPollMode fingerPollMode() {
+  return mode;
+}
+
+const char* fingerPollModeName(FingerPollMode m) {
+  switch (m) {
+    case FINGER_POLL_TOUCH: return "WAK";
+    case FINGER_POLL_FAST: return "FAST";
+    case FINGER_POLL_IDLE: return "IDLE";
+    case FINGER_POLL_DARK: return "DARK";
+  }
+  return "?";
+}
+
+uint32_t fingerPollCommands() {
+  return commands;
+}
+
+uint32_t fingerPollCommandsPerHour(uint32_t nowMs) {
+  if (nowMs == 0) return 0;
+  return (uint32_t)((uint64_t)commands * 3600000UL / nowMs);
+}
+
+uint32_t fingerPollDetects() {
+  return detects;
+}
+
+uint32_t fingerPollLatencyAvgMs() {
+  return detects ? latencySumMs / detects : 0;
+}
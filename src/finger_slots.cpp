@@ -0,0 +1,155 @@
+/*
+ * FINGER SLOTS - Bảng ID vân tay đã dùng trong RAM
+ * Xem include/finger_slots.h
+ */
+
+#include <string.h>
+
+#include "finger_slots.h"
+#include "hal.h"
+
+#define PAGE_IDS (AS608_INDEX_BYTES * 8)
+
+static uint8_t bitmap[FINGER_SLOTS_MAX / 8];
+static uint16_t capacity = 0;       // Số ID dùng được (<= FINGER_SLOTS_MAX)
+static uint16_t used = 0;
+static bool ready = false;
+static bool loading = false;
+static bool reloadPending = false;  // Cần đọc lại sau lượt đang đọc
+static As608Callback doneCb = nullptr;
+
+// Thống kê
+static uint32_t loads = 0;          // Lượt đọc cả bảng (kể cả đọc lại)
+static uint32_t loadErrors = 0;
+static uint32_t loadMs = 0;         // Thời gian các lệnh đọc của lượt gần nhất
+static uint32_t queries = 0;        // Hỏi bitmap thay cho 1 lệnh UART
+
+static void setUsed(uint16_t id, bool on) {
+  if (id >= capacity) return;
+  uint8_t mask = 1 << (id % 8);
+  if (((bitmap[id / 8] & mask) != 0) == on) return;
+  bitmap[id / 8] ^= mask;
+  if (on) {
+    used++;
+  } else {
+    used--;
+  }
+}
+
+// ==================== ĐỌC BẢNG ====================
+static void readPage(uint8_t page);
+
+static void onPage(const As608Result& r) {
+  loadMs += r.doneMs - r.sentMs;
+  if (r.code != FINGERPRINT_OK || !r.data) {
+    loading = false;
+    loadErrors++;
+    halConsole().printf("[Slots] ✗ Không đọc được bảng chỉ mục trang %u (mã 0x%02X)\n", r.arg,
+                        r.code);
+  } else {
+    // Bit vượt quá số mẫu tối đa: bỏ
+    uint16_t first = r.arg * PAGE_IDS;
+    for (uint16_t i = 0; i < PAGE_IDS && first + i < capacity; i++) {
+      setUsed(first + i, r.data[i / 8] & (1 << (i % 8)));
+    }
+    if ((uint32_t)(r.arg + 1) * PAGE_IDS < capacity) {
+      readPage((uint8_t)(r.arg + 1));
+      return;
+    }
+    loading = false;
+    ready = true;
+  }
+
+  if (reloadPending) {
+    reloadPending = false;
+    fingerSlotsLoad(capacity, doneCb);
+    return;
+  }
+  As608Result out = r;
+  out.score = used;
+  As608Callback cb = doneCb;
+  doneCb = nullptr;
+  if (cb) cb(out);
+}
+
+static void readPage(uint8_t page) {
+  if (as608Submit(AS608_READ_INDEX, page, onPage)) return;
+  // Hàng lệnh đầy: báo như lệnh lỗi
+  As608Result r = { AS608_READ_INDEX, page, FINGERPRINT_TIMEOUT, 0, 0, nullptr, 0,
+                    halMillis(), halMillis() };
+  onPage(r);
+}
+
+// ==================== API ====================
+void fingerSlotsLoad(uint16_t cap, As608Callback done) {
+  // Đọc lại do fingerSlotsNote (done = nullptr) không được làm mất callback của
+  // lượt đang đọc (vd. onFingerBeginCount lúc khởi động)
+  if (done) doneCb = done;
+  if (loading) {
+    reloadPending = true;
+    return;
+  }
+  if (cap == 0) cap = PAGE_IDS;     // Chưa biết số mẫu tối đa: 1 trang
+  capacity = cap < FINGER_SLOTS_MAX ? cap : FINGER_SLOTS_MAX;
+  memset(bitmap, 0, sizeof(bitmap));
+  used = 0;
+  ready = false;
+  loading = true;
+  loads++;
+  loadMs = 0;
+  readPage(0);
+}
+
+bool fingerSlotsReady() {
+  return ready;
+}
+
+void fingerSlotsNote(const As608Result& r) {
+  if (r.op != AS608_STORE && r.op != AS608_DELETE && r.op != AS608_EMPTY) return;
+
+  if (r.code == FINGERPRINT_TIMEOUT || r.code == FINGERPRINT_BADPACKET) {
+    // Không biết cảm biến đã ghi / xóa chưa -> đọc lại
+    if (capacity) fingerSlotsLoad(capacity, nullptr);
+    return;
+  }
+  if (r.code != FINGERPRINT_OK) return;
+
+  if (r.op == AS608_EMPTY) {
+    memset(bitmap, 0, sizeof(bitmap));
+    used = 0;
+  } else {
+    setUsed(r.arg, r.op == AS608_STORE);
+  }
+}
+
+uint16_t fingerSlotsCount() {
+  queries++;
+  return used;
+}
+
+bool fingerSlotsUsed(uint16_t id) {
+  queries++;
+  return id < capacity && (bitmap[id / 8] & (1 << (id % 8)));
+}
+
+uint16_t fingerSlotsFirstFree(uint16_t from, uint16_t to) {
+  queries++;
+  if (capacity == 0) return 0;
+  if (to >= capacity) to = capacity - 1;
+  for (uint16_t id = from; id <= to; id++) {
+    // Cả byte đã dùng: bỏ qua 8 ID
+    if (id % 8 == 0 && bitmap[id / 8] == 0xFF && id + 7 <= to) {
+      id += 7;
+      continue;
+    }
+    if (!(bitmap[id / 8] & (1 << (id % 8)))) return id;
+  }
+  return 0;
+}
+
+void fingerSlotsPrint() {
+  halConsole().printf("[Slots] Đã dùng: %u / %u%s | Đọc bảng chỉ mục: %u lần (lỗi: %u, "
+                      "lần cuối: %u ms) | Truy vấn không qua UART: %u\n",
+                      used, capacity, ready ? "" : " (chưa khớp cảm biến)", (unsigned)loads,
+                      (unsigned)loadErrors, (unsigned)loadMs, (unsigned)queries);
+}
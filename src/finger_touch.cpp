@@ -0,0 +1,63 @@
+/*
+ * FINGER TOUCH - Ngắt từ chân chạm (WAK/TCH) của cảm biến AS608
+ * Xem include/finger_touch.h
+ */
+
+#include "finger_touch.h"
+#include "ring_buffer.h"
+#include "hal.h"
+
+// ==================== TRẠNG THÁI ====================
+static int8_t touchPin = -1;
+static uint8_t touchActiveLevel = HIGH;
+
+// ISR ghi thời điểm chạm, loop() đọc
+static SpscRing<uint32_t, FINGER_TOUCH_RING_LEN> touchRing;
+
+// Chỉ loop() dùng
+static bool touchSeen = false;
+static uint32_t lastTouchMs = 0;
+static uint32_t touchCount = 0;
+
+// ==================== NGẮT ====================
+static void IRAM_ATTR onTouchEdge() {
+  touchRing.push(halMillis());
+}
+
+// ==================== API ====================
+void fingerTouchBegin(int8_t pin, uint8_t activeLevel) {
+  touchPin = pin;
+  touchActiveLevel = activeLevel;
+  if (pin < 0) return;
+
+  // Chân WAK do mạch cảm ứng đẩy kéo (GPIO 34-39 không có điện trở kéo)
+  halPinMode(pin, INPUT);
+  halAttachInterrupt(pin, onTouchEdge, activeLevel == HIGH ? RISING : FALLING);
+}
+
+bool fingerTouchWanted(uint32_t nowMs) {
+  if (touchPin < 0) return true;
+
+  uint32_t at;
+  while (touchRing.pop(at)) {
+    touchSeen = true;
+    lastTouchMs = at;
+    touchCount++;
+  }
+
+  // Ngón tay vẫn đặt trên cảm biến (đọc thanh ghi GPIO, không qua UART)
+  if (halDigitalRead(touchPin) == touchActiveLevel) return true;
+  return touchSeen && nowMs - lastTouchMs < FINGER_TOUCH_WINDOW_MS;
+}
+
+bool fingerTouchEnabled() {
+  return touchPin >= 0;
+}
+
+uint32_t fingerTouchCount() {
+  return touchCount;
+}
+
+uint32_t fingerTouchLastMs() {
+  return lastTouchMs;
+}
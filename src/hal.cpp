@@ -0,0 +1,63 @@
+/*
+ * HAL - Phần dùng chung cho cả ESP32 và máy tính
+ * Xem include/hal.h
+ */
+
+#include "hal.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+// ==================== LCD ====================
+void HalDisplay::print(char c) {
+  char text[2] = { c, '\0' };
+  print(text);
+}
+
+void HalDisplay::print(int value) {
+  char text[12];
+  snprintf(text, sizeof(text), "%d", value);
+  print(text);
+}
+
+void HalDisplay::print(float value, int digits) {
+  char text[16];
+  snprintf(text, sizeof(text), "%.*f", digits, (double)value);
+  print(text);
+}
+
+// ==================== SERIAL ====================
+void HalConsole::print(char c) {
+  char text[2] = { c, '\0' };
+  write(text);
+}
+
+void HalConsole::print(int value) {
+  char text[12];
+  snprintf(text, sizeof(text), "%d", value);
+  write(text);
+}
+
+void HalConsole::println(const char* text) {
+  write(text);
+  write("\n");
+}
+
+void HalConsole::println(char c) {
+  print(c);
+  write("\n");
+}
+
+void HalConsole::println(int value) {
+  print(value);
+  write("\n");
+}
+
+void HalConsole::printf(const char* fmt, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(text, sizeof(text), fmt, args);
+  va_end(args);
+  write(text);
+}
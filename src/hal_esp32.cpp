@@ -0,0 +1,275 @@
+/*
+ * HAL ESP32 - Cài đặt giao diện phần cứng bằng thư viện Arduino
+ * Xem include/hal.h
+ */
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <LiquidCrystal_I2C.h>
+#include <Keypad.h>
+#include <DHT.h>
+#include <WiFi.h>
+#include <Preferences.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+
+#include "hal.h"
+#include "board.h"
+#include "event_clock.h"
+#include "journal.h"
+#include "uplink.h"
+
+// ==================== ĐỒNG HỒ + GPIO ====================
+uint32_t halMillis() {
+  return millis();
+}
+
+uint32_t halMicros() {
+  return micros();
+}
+
+void halDelay(uint32_t ms) {
+  delay(ms);
+}
+
+void halPinMode(uint8_t pin, uint8_t mode) {
+  pinMode(pin, mode);
+}
+
+void halDigitalWrite(uint8_t pin, uint8_t level) {
+  digitalWrite(pin, level);
+}
+
+int halDigitalRead(uint8_t pin) {
+  return digitalRead(pin);
+}
+
+int halAnalogRead(uint8_t pin) {
+  return analogRead(pin);
+}
+
+void halAttachInterrupt(uint8_t pin, HalIsr isr, uint8_t mode) {
+  attachInterrupt(digitalPinToInterrupt(pin), isr, mode);
+}
+
+// ==================== NGUỒN ====================
+static const uint8_t wakeRows[4] = {ROW1, ROW2, ROW3, ROW4};
+static const uint8_t wakeCols[4] = {COL1, COL2, COL3, COL4};
+
+void halSetCpuMhz(uint32_t mhz) {
+  if (getCpuFrequencyMhz() != mhz) setCpuFrequencyMhz(mhz);
+}
+
+uint32_t halCpuMhz() {
+  return getCpuFrequencyMhz();
+}
+
+// Chân có ngắt cạnh (attachInterrupt): tắt ngắt khi dùng làm chân đánh thức
+// mức, bật lại sau khi dậy. Cạnh trong lúc ngủ bị mất -> người dùng đọc lại mức
+static void wakeEnable(uint8_t pin, uint8_t level) {
+  gpio_intr_disable((gpio_num_t)pin);
+  gpio_wakeup_enable((gpio_num_t)pin, level == HIGH ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+}
+
+static void wakeRestore(uint8_t pin, uint8_t level) {
+  gpio_wakeup_disable((gpio_num_t)pin);
+  gpio_set_intr_type((gpio_num_t)pin, level == HIGH ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE);
+  gpio_intr_enable((gpio_num_t)pin);
+}
+
+HalWakeCause halLightSleep(uint32_t maxMs) {
+  if (digitalRead(SOUND_PIN) == HIGH) return HAL_WAKE_GPIO;
+#if FINGER_TOUCH_PIN >= 0
+  if (digitalRead(FINGER_TOUCH_PIN) == FINGER_TOUCH_ACTIVE) return HAL_WAKE_GPIO;
+#endif
+
+  // Keypad: kéo cả 4 cột xuống LOW -> nhấn phím bất kỳ kéo 1 hàng (pull-up) xuống LOW.
+  // Thư viện Keypad đặt lại chế độ chân cột ở lần quét kế tiếp
+  for (uint8_t col : wakeCols) {
+    pinMode(col, OUTPUT);
+    digitalWrite(col, LOW);
+  }
+  bool held = false;
+  for (uint8_t row : wakeRows) {
+    pinMode(row, INPUT_PULLUP);
+    if (digitalRead(row) == LOW) held = true;
+  }
+
+  HalWakeCause cause = HAL_WAKE_GPIO;
+  if (!held) {
+    for (uint8_t row : wakeRows) gpio_wakeup_enable((gpio_num_t)row, GPIO_INTR_LOW_LEVEL);
+    wakeEnable(SOUND_PIN, HIGH);
+#if FINGER_TOUCH_PIN >= 0
+    wakeEnable(FINGER_TOUCH_PIN, FINGER_TOUCH_ACTIVE);
+#endif
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)maxMs * 1000);
+
+    Serial.flush();  // UART ngừng khi ngủ: in hết trước
+    esp_light_sleep_start();
+
+    switch (esp_sleep_get_wakeup_cause()) {
+      case ESP_SLEEP_WAKEUP_TIMER: cause = HAL_WAKE_TIMER; break;
+      case ESP_SLEEP_WAKEUP_GPIO: cause = HAL_WAKE_GPIO; break;
+      default: cause = HAL_WAKE_OTHER; break;
+    }
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    for (uint8_t row : wakeRows) gpio_wakeup_disable((gpio_num_t)row);
+    wakeRestore(SOUND_PIN, HIGH);
+#if FINGER_TOUCH_PIN >= 0
+    wakeRestore(FINGER_TOUCH_PIN, FINGER_TOUCH_ACTIVE);
+#endif
+  }
+
+  for (uint8_t col : wakeCols) pinMode(col, INPUT);
+  return cause;
+}
+
+// ==================== LCD ====================
+class EspDisplay : public HalDisplay {
+ public:
+  void begin() override {
+    Wire.begin(LCD_SDA, LCD_SCL);
+    lcd.init();
+    lcd.backlight();
+  }
+  void clear() override { lcd.clear(); }
+  void setCursor(uint8_t col, uint8_t row) override { lcd.setCursor(col, row); }
+  void print(const char* text) override { lcd.print(text); }
+
+ private:
+  LiquidCrystal_I2C lcd{LCD_ADDR, 16, 2};
+};
+
+// ==================== KEYPAD ====================
+static char keyMap[4][4] = {
+  {'1', '2', '3', 'A'},
+  {'4', '5', '6', 'B'},
+  {'7', '8', '9', 'C'},
+  {'*', '0', '#', 'D'}
+};
+static byte rowPins[4] = {ROW1, ROW2, ROW3, ROW4};
+static byte colPins[4] = {COL1, COL2, COL3, COL4};
+
+class EspKeypad : public HalKeypad {
+ public:
+  char getKey() override { return keypad.getKey(); }
+
+ private:
+  Keypad keypad{makeKeymap(keyMap), rowPins, colPins, 4, 4};
+};
+
+// ==================== VÂN TAY ====================
+// Gói tin AS608 ở as608.cpp; UART2 có bộ đệm nhận 256 byte (gói trả lời <= 20 byte)
+class EspFingerPort : public HalFingerPort {
+ public:
+  void begin(uint32_t baud) override {
+    uart.begin(baud, SERIAL_8N1, FINGER_RX, FINGER_TX);
+  }
+  int read() override { return uart.available() > 0 ? uart.read() : -1; }
+  void write(const uint8_t* data, size_t len) override { uart.write(data, len); }
+
+ private:
+  HardwareSerial uart{2};
+};
+
+// ==================== DHT11 ====================
+class EspClimate : public HalClimate {
+ public:
+  void begin() override { dht.begin(); }
+  float readTemperature() override { return dht.readTemperature(); }
+  float readHumidity() override { return dht.readHumidity(); }
+
+ private:
+  DHT dht{DHT_PIN, DHT_TYPE};
+};
+
+// ==================== WIFI ====================
+class EspNetwork : public HalNetwork {
+ public:
+  void begin(const char* ssid, const char* password) override {
+    WiFi.begin(ssid, password);
+  }
+  bool connected() override { return WiFi.status() == WL_CONNECTED; }
+  const char* address() override {
+    snprintf(ip, sizeof(ip), "%s", WiFi.localIP().toString().c_str());
+    return ip;
+  }
+
+ private:
+  char ip[16];
+};
+
+// ==================== SERIAL ====================
+class EspConsole : public HalConsole {
+ public:
+  void begin(uint32_t baud) override { Serial.begin(baud); }
+  void write(const char* text) override { Serial.print(text); }
+  int read() override { return Serial.available() > 0 ? Serial.read() : -1; }
+};
+
+HalDisplay& halDisplay() {
+  static EspDisplay display;
+  return display;
+}
+
+HalKeypad& halKeypad() {
+  static EspKeypad keypad;
+  return keypad;
+}
+
+HalFingerPort& halFingerPort() {
+  static EspFingerPort finger;
+  return finger;
+}
+
+HalClimate& halClimate() {
+  static EspClimate climate;
+  return climate;
+}
+
+HalNetwork& halNetwork() {
+  static EspNetwork network;
+  return network;
+}
+
+HalConsole& halConsole() {
+  static EspConsole console;
+  return console;
+}
+
+// ==================== DỊCH VỤ ====================
+void halEventClockBegin() {
+  eventClockBeginSntp();
+}
+
+bool halJournalBegin() {
+  return journalBeginPartition("spiffs");
+}
+
+bool halUplinkBegin(const char* scriptUrl) {
+  // transport mặc định: kết nối HTTPS giữ lâu dài (uplink_conn.h)
+  return uplinkBegin(scriptUrl);
+}
+
+// Vùng NVS "settings", mở lần đầu dùng
+static Preferences settings;
+static bool settingsOpen = false;
+
+static bool settingsBegin() {
+  if (!settingsOpen) settingsOpen = settings.begin("settings", false);
+  return settingsOpen;
+}
+
+uint32_t halSettingGet(const char* key, uint32_t fallback) {
+  return settingsBegin() ? settings.getUInt(key, fallback) : fallback;
+}
+
+void halSettingPut(const char* key, uint32_t value) {
+  if (settingsBegin()) settings.putUInt(key, value);
+}
+
+#endif
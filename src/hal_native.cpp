@@ -0,0 +1,716 @@
+/*
+ * HAL NATIVE - Thiết bị giả + đồng hồ mô phỏng để chạy firmware trên máy tính
+ * Xem include/hal.h
+ *
+ * main() gọi setup() rồi đọc kịch bản (file hoặc stdin), mỗi dòng 1 lệnh:
+ *   wait <ms>          chạy loop() cho tới khi đồng hồ mô phỏng tăng thêm ms
+ *   key <phím...>      nhấn lần lượt các phím (vd. key 1234#), 1 phím / vòng loop()
+ *   finger <n> [tc]    đặt ngón tay số n lên cảm biến (n bất kỳ, 1 = đã đăng ký sẵn ở ID 1),
+ *                      tc = độ tin cậy khi khớp (mặc định 150; < 100: tìm nhanh trượt)
+ *   finger off         nhấc ngón tay
+ *   finger mute <n>    cảm biến không trả lời n lệnh kế tiếp (thử hết giờ / gửi lại)
+ *   temp <°C> [%RH]    nhiệt độ / độ ẩm DHT11 (nan = đọc lỗi)
+ *   light <adc>        giá trị analogRead() của LDR (> 2500 = tối)
+ *   sound              1 xung ở chân âm thanh
+ *   sound on|off       giữ chân âm thanh ở HIGH (tiếng kéo dài) / thả về LOW
+ *   http <code> [error] mã HTTP transport giả trả về (mặc định 200, 0 = mất mạng),
+ *                      error: script trả {"status":"error"} (doPost gặp exception)
+ *   serial <lệnh>      gõ lệnh Serial (vd. serial stats)
+ *   lcd                in nội dung LCD
+ *   # ...              chú thích
+ * Hết kịch bản -> thoát. LCD và chân ra (relay, LED, quạt) được in khi đổi.
+ *
+ * program --replay trace.txt: phát lại bản ghi đầu vào (input_trace.h) thay
+ * cho kịch bản, chỉ in kết quả so sánh; mã thoát 1 nếu có sai khác.
+ */
+
+#if !defined(ARDUINO)
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal.h"
+#include "board.h"
+#include "as608.h"
+#include "event_clock.h"
+#include "input_trace.h"
+#include "journal.h"
+#include "sensors.h"
+#include "uplink.h"
+
+void setup();
+void loop();
+
+// ==================== ĐỒNG HỒ MÔ PHỎNG ====================
+// Chỉ tăng khi firmware gọi halDelay() (cuối mỗi vòng loop(): 10 ms) / halLightSleep()
+#define SIM_EPOCH_START 1760000000u   // Giờ Unix lúc "khởi động"
+
+static uint32_t simMs = 0;
+
+// Phát lại bản ghi: chỉ in dòng "[Replay]"
+static bool simQuiet = false;
+
+// Lệnh "wait" đang chạy tới lúc này (lệnh kế tiếp có thể là đầu vào -> ngủ nhẹ dừng ở đây)
+static uint32_t simRunEnd = 0;
+static uint32_t simCpuMhz = 240;
+
+uint32_t halMillis() {
+  return simMs;
+}
+
+uint32_t halMicros() {
+  return simMs * 1000u;
+}
+
+void halDelay(uint32_t ms) {
+  simMs += ms;
+}
+
+// ==================== GPIO GIẢ ====================
+#define SIM_PINS 40
+
+static uint8_t pinModes[SIM_PINS];
+static uint8_t pinLevels[SIM_PINS];
+static int pinAnalog[SIM_PINS];
+static HalIsr pinIsr[SIM_PINS];
+static uint8_t pinIsrMode[SIM_PINS];
+
+static const char* pinName(uint8_t pin) {
+  switch (pin) {
+    case RELAY_PIN: return "RELAY/FAN";
+    case LED_PIN: return "LED";
+    case DOOR_LED_PIN: return "DOOR_LED";
+    case SOUND_LED_PIN: return "SOUND_LED";
+    default: return "GPIO";
+  }
+}
+
+void halPinMode(uint8_t pin, uint8_t mode) {
+  if (pin < SIM_PINS) pinModes[pin] = mode;
+}
+
+void halDigitalWrite(uint8_t pin, uint8_t level) {
+  if (pin >= SIM_PINS) return;
+  if (pinLevels[pin] != level && !simQuiet) {
+    printf("[Sim] %6u ms  %s(%u) -> %s\n", (unsigned)simMs, pinName(pin), pin,
+           level ? "HIGH" : "LOW");
+  }
+  pinLevels[pin] = level;
+}
+
+int halDigitalRead(uint8_t pin) {
+  return pin < SIM_PINS ? pinLevels[pin] : LOW;
+}
+
+int halAnalogRead(uint8_t pin) {
+  return pin < SIM_PINS ? pinAnalog[pin] : 0;
+}
+
+void halAttachInterrupt(uint8_t pin, HalIsr isr, uint8_t mode) {
+  if (pin >= SIM_PINS) return;
+  pinIsr[pin] = isr;
+  pinIsrMode[pin] = mode;
+}
+
+// Kịch bản đổi mức chân vào -> gọi "ngắt" nếu đúng cạnh
+static void simSetPin(uint8_t pin, uint8_t level) {
+  if (pin >= SIM_PINS) return;  // Chân không nối (-1)
+  uint8_t old = pinLevels[pin];
+  pinLevels[pin] = level;
+  if (!pinIsr[pin] || old == level) return;
+  if ((pinIsrMode[pin] == RISING && level == HIGH) ||
+      (pinIsrMode[pin] == FALLING && level == LOW)) {
+    pinIsr[pin]();
+  }
+}
+
+// ==================== LCD GIẢ ====================
+class SimDisplay : public HalDisplay {
+ public:
+  void begin() override { clear(); }
+
+  void clear() override {
+    memset(rows, ' ', sizeof(rows));
+    col = row = 0;
+    dirty = true;
+  }
+
+  void setCursor(uint8_t c, uint8_t r) override {
+    col = c;
+    row = r < 2 ? r : 1;
+  }
+
+  // Ký tự ngoài 16 cột bị bỏ (LCD thật ghi vào vùng không hiển thị)
+  void print(const char* text) override {
+    for (; *text; text++) {
+      if (col < 16 && rows[row][col] != *text) {
+        rows[row][col] = *text;
+        dirty = true;
+      }
+      col++;
+    }
+  }
+
+  void dump() {
+    if (!simQuiet) printf("[LCD] %6u ms  |%.16s|%.16s|\n", (unsigned)simMs, rows[0], rows[1]);
+    dirty = false;
+  }
+
+  bool dirty = false;
+
+ private:
+  char rows[2][16];
+  uint8_t col = 0;
+  uint8_t row = 0;
+};
+
+// ==================== KEYPAD GIẢ ====================
+class SimKeypad : public HalKeypad {
+ public:
+  char getKey() override {
+    if (head == tail) return 0;
+    return keys[tail++ % sizeof(keys)];
+  }
+
+  bool pending() const { return head != tail; }
+
+  void press(char key) {
+    if (head - tail < sizeof(keys)) keys[head++ % sizeof(keys)] = key;
+  }
+
+ private:
+  char keys[32];
+  uint32_t head = 0;
+  uint32_t tail = 0;
+};
+
+// ==================== VÂN TAY GIẢ ====================
+// AS608 giả nói đúng giao thức gói tin (as608.h): nhận gói lệnh, trả lời sau
+// thời gian gần đúng như AS608 thật (truyền gói theo baud + xử lý ảnh).
+// Hai đầu UART khác baud -> cảm biến không hiểu lệnh, không trả lời.
+// "Ngón tay" là 1 số nguyên > 0; templates[id] = ngón tay đã lưu ở ID đó
+#define SIM_FINGER_SLOTS 128
+#define SIM_GET_IMAGE_MS 60
+#define SIM_IMAGE2TZ_MS 120
+#define SIM_SEARCH_MS 150
+#define SIM_FAST_SEARCH_MS 40
+#define SIM_FINGER_SCORE 150          // Độ tin cậy mặc định khi khớp
+#define SIM_FAST_MIN_SCORE 100        // Ảnh kém hơn -> HighSpeedSearch trượt
+#define SIM_NOTEPAD_WRITE_MS 20       // Ghi flash của cảm biến
+#ifndef SIM_FINGER_BAUD
+#define SIM_FINGER_BAUD 57600         // Tốc độ cảm biến lúc "cấp nguồn" (-DSIM_FINGER_BAUD=...)
+#endif
+
+class SimFingerPort : public HalFingerPort {
+ public:
+  SimFingerPort() { templates[1] = 1; }
+
+  void begin(uint32_t baud) override {
+    hostBaud = baud;
+    outPos = outLen;
+  }
+
+  void write(const uint8_t* data, size_t len) override {
+    if (hostBaud != moduleBaud) return;
+    for (size_t i = 0; i < len; i++) {
+      if (!rx.feed(data[i]) || rx.bad || rx.pid != AS608_PID_COMMAND || rx.length == 0) continue;
+      // Cảm biến "bận": bỏ qua lệnh, không trả lời
+      if (muted > 0) {
+        muted--;
+        continue;
+      }
+      memcpy(cmd, rx.data, rx.length);
+      busy = true;
+      readyMs = simMs + wireMs(rx.length + 11) + latency(cmd[0]);
+    }
+  }
+
+  // Trả lời chỉ có sau khi cảm biến xử lý xong và truyền hết gói (đồng hồ mô phỏng)
+  int read() override {
+    if (busy && (int32_t)(simMs - readyMs) >= 0) {
+      busy = false;
+      uint8_t reply[AS608_MAX_PAYLOAD] = {};
+      uint8_t len = execute(reply);
+      outLen = as608Frame(out, AS608_PID_ACK, reply, len);
+      outPos = 0;
+      outMs = simMs + wireMs(outLen);
+      if (hostBaud != moduleBaud) outLen = 0;   // Bên nhận đã đổi tốc độ: chỉ thấy rác
+      // Đổi tốc độ sau khi gửi xong trả lời (ở tốc độ cũ)
+      moduleBaud = nextBaud;
+    }
+    if (outPos >= outLen || (int32_t)(simMs - outMs) < 0) return -1;
+    return out[outPos++];
+  }
+
+  int placed = 0;     // Ngón tay đang đặt trên cảm biến (0 = không có)
+  uint16_t score = SIM_FINGER_SCORE;  // Độ tin cậy khi khớp của lần đặt này
+  uint16_t muted = 0; // Số lệnh kế tiếp bị bỏ qua (thử hết giờ / gửi lại)
+
+ private:
+  static uint32_t latency(uint8_t code) {
+    switch (code) {
+      case AS608_CMD_GET_IMAGE: return SIM_GET_IMAGE_MS;
+      case AS608_CMD_IMAGE2TZ: return SIM_IMAGE2TZ_MS;
+      case AS608_CMD_SEARCH: return SIM_SEARCH_MS;
+      case AS608_CMD_FAST_SEARCH: return SIM_FAST_SEARCH_MS;
+      case AS608_CMD_WRITE_NOTEPAD: return SIM_NOTEPAD_WRITE_MS;
+      default: return 0;
+    }
+  }
+
+  // 10 bit / byte, làm tròn lên ms
+  uint32_t wireMs(size_t bytes) const {
+    return (uint32_t)((bytes * 10 * 1000 + moduleBaud - 1) / moduleBaud);
+  }
+
+  // Thực hiện lệnh trong cmd, trả về số byte dữ liệu của gói trả lời
+  uint8_t execute(uint8_t* reply) {
+    uint16_t id;
+    switch (cmd[0]) {
+      case AS608_CMD_GET_IMAGE:
+        image = placed;
+        imageScore = score;
+        reply[0] = placed ? FINGERPRINT_OK : FINGERPRINT_NOFINGER;
+        return 1;
+
+      case AS608_CMD_IMAGE2TZ:
+        if (!image) {
+          reply[0] = FINGERPRINT_IMAGEFAIL;
+          return 1;
+        }
+        charBuf[cmd[1] == 2 ? 1 : 0] = image;
+        charScore[cmd[1] == 2 ? 1 : 0] = imageScore;
+        reply[0] = FINGERPRINT_OK;
+        return 1;
+
+      case AS608_CMD_SEARCH:
+      case AS608_CMD_FAST_SEARCH:
+        reply[0] = FINGERPRINT_NOTFOUND;
+        if (cmd[0] == AS608_CMD_FAST_SEARCH && charScore[0] < SIM_FAST_MIN_SCORE) return 5;
+        for (id = 0; id < SIM_FINGER_SLOTS; id++) {
+          if (templates[id] != 0 && templates[id] == charBuf[0]) {
+            reply[0] = FINGERPRINT_OK;
+            reply[1] = (uint8_t)(id >> 8);
+            reply[2] = (uint8_t)id;
+            reply[3] = (uint8_t)(charScore[0] >> 8);
+            reply[4] = (uint8_t)charScore[0];
+            break;
+          }
+        }
+        return 5;
+
+      case AS608_CMD_CREATE:
+        reply[0] = charBuf[0] == charBuf[1] ? FINGERPRINT_OK : FINGERPRINT_ENROLLMISMATCH;
+        return 1;
+
+      case AS608_CMD_STORE:
+        id = (uint16_t)(cmd[2] << 8) | cmd[3];
+        reply[0] = FINGERPRINT_BADLOCATION;
+        if (id < SIM_FINGER_SLOTS) {
+          templates[id] = charBuf[0];
+          reply[0] = FINGERPRINT_OK;
+        }
+        return 1;
+
+      case AS608_CMD_DELETE:
+        id = (uint16_t)(cmd[1] << 8) | cmd[2];
+        reply[0] = FINGERPRINT_BADLOCATION;
+        if (id < SIM_FINGER_SLOTS) {
+          templates[id] = 0;
+          reply[0] = FINGERPRINT_OK;
+        }
+        return 1;
+
+      case AS608_CMD_EMPTY:
+        memset(templates, 0, sizeof(templates));
+        reply[0] = FINGERPRINT_OK;
+        return 1;
+
+      case AS608_CMD_VERIFY:
+        reply[0] = FINGERPRINT_OK;
+        return 1;
+
+      case AS608_CMD_COUNT:
+        id = 0;
+        for (uint16_t i = 0; i < SIM_FINGER_SLOTS; i++) {
+          if (templates[i] != 0) id++;
+        }
+        reply[0] = FINGERPRINT_OK;
+        reply[1] = (uint8_t)(id >> 8);
+        reply[2] = (uint8_t)id;
+        return 3;
+
+      case AS608_CMD_READ_INDEX:
+        for (uint16_t i = 0; i < 256; i++) {
+          id = (uint16_t)(cmd[1] * 256 + i);
+          if (id < SIM_FINGER_SLOTS && templates[id] != 0) reply[1 + i / 8] |= 1 << (i % 8);
+        }
+        reply[0] = FINGERPRINT_OK;
+        return 1 + AS608_INDEX_BYTES;
+
+      case AS608_CMD_READ_PARAMS:
+        reply[0] = FINGERPRINT_OK;
+        reply[6] = SIM_FINGER_SLOTS;                     // Số mẫu tối đa
+        reply[8] = 3;                                    // Mức bảo mật
+        memset(reply + 9, 0xFF, 4);                      // Địa chỉ
+        reply[14] = 2;                                   // Gói 128 byte
+        reply[16] = (uint8_t)(moduleBaud / AS608_BAUD_UNIT);
+        return 17;
+
+      case AS608_CMD_SET_PARAM:
+        reply[0] = FINGERPRINT_OK;
+        if (cmd[1] != AS608_PARAM_BAUD || cmd[2] < 1 || cmd[2] > 12) {
+          reply[0] = FINGERPRINT_PACKETRECIEVEERR;
+        } else {
+          nextBaud = cmd[2] * AS608_BAUD_UNIT;
+        }
+        return 1;
+
+      case AS608_CMD_WRITE_NOTEPAD:
+        memcpy(notepad[cmd[1] & 0x0F], cmd + 2, AS608_NOTEPAD_BYTES);
+        reply[0] = FINGERPRINT_OK;
+        return 1;
+
+      case AS608_CMD_READ_NOTEPAD:
+        memcpy(reply + 1, notepad[cmd[1] & 0x0F], AS608_NOTEPAD_BYTES);
+        reply[0] = FINGERPRINT_OK;
+        return 1 + AS608_NOTEPAD_BYTES;
+
+      default:
+        reply[0] = FINGERPRINT_PACKETRECIEVEERR;
+        return 1;
+    }
+  }
+
+  As608Parser rx;
+  uint8_t cmd[AS608_MAX_PAYLOAD];
+  bool busy = false;
+  uint32_t readyMs = 0;
+  uint8_t out[AS608_FRAME_MAX];
+  size_t outLen = 0;
+  size_t outPos = 0;
+  uint32_t outMs = 0;       // Trả lời đọc được từ lúc này (đã truyền hết gói)
+
+  uint32_t hostBaud = 0;
+  uint32_t moduleBaud = SIM_FINGER_BAUD;
+  uint32_t nextBaud = SIM_FINGER_BAUD;
+
+  int templates[SIM_FINGER_SLOTS] = {};
+  uint8_t notepad[16][AS608_NOTEPAD_BYTES] = {};
+  int image = 0;
+  uint16_t imageScore = 0;
+  int charBuf[2] = {};
+  uint16_t charScore[2] = {};
+};
+
+// ==================== DHT11 / WIFI / SERIAL GIẢ ====================
+class SimClimate : public HalClimate {
+ public:
+  void begin() override {}
+  float readTemperature() override { return temperature; }
+  float readHumidity() override { return humidity; }
+
+  float temperature = 25.0f;
+  float humidity = 60.0f;
+};
+
+class SimNetwork : public HalNetwork {
+ public:
+  void begin(const char*, const char*) override {}
+  bool connected() override { return true; }
+  const char* address() override { return "127.0.0.1"; }
+};
+
+class SimConsole : public HalConsole {
+ public:
+  void begin(uint32_t) override {}
+  void write(const char* text) override {
+    if (!simQuiet || strncmp(text, "[Replay]", 8) == 0) fputs(text, stdout);
+  }
+
+  int read() override {
+    if (tail == head) return -1;
+    return (unsigned char)input[tail++ % sizeof(input)];
+  }
+
+  void type(const char* text) {
+    for (; *text; text++) {
+      if (head - tail < sizeof(input)) input[head++ % sizeof(input)] = *text;
+    }
+  }
+
+ private:
+  char input[128];
+  uint32_t head = 0;
+  uint32_t tail = 0;
+};
+
+static SimDisplay simDisplay;
+static SimKeypad simKeypad;
+static SimFingerPort simFinger;
+static SimClimate simClimate;
+static SimNetwork simNetwork;
+static SimConsole simConsole;
+
+HalDisplay& halDisplay() { return simDisplay; }
+HalKeypad& halKeypad() { return simKeypad; }
+HalFingerPort& halFingerPort() { return simFinger; }
+HalClimate& halClimate() { return simClimate; }
+HalNetwork& halNetwork() { return simNetwork; }
+HalConsole& halConsole() { return simConsole; }
+
+// ==================== DỊCH VỤ ====================
+static uint32_t simEpoch() {
+  return SIM_EPOCH_START + simMs / 1000;
+}
+
+void halEventClockBegin() {
+  eventClockBegin(1, halMillis, simEpoch);
+}
+
+// Flash giả trong RAM (mất khi thoát)
+#define SIM_JOURNAL_SIZE (8 * JOURNAL_SECTOR_SIZE)
+static uint8_t simFlash[SIM_JOURNAL_SIZE];
+
+static bool simFlashRead(uint32_t addr, void* buf, size_t len) {
+  memcpy(buf, simFlash + addr, len);
+  return true;
+}
+
+static bool simFlashWrite(uint32_t addr, const void* buf, size_t len) {
+  // Flash chỉ đổi bit 1 -> 0
+  const uint8_t* src = (const uint8_t*)buf;
+  for (size_t i = 0; i < len; i++) simFlash[addr + i] &= src[i];
+  return true;
+}
+
+static bool simFlashErase(uint32_t addr) {
+  memset(simFlash + addr, 0xFF, JOURNAL_SECTOR_SIZE);
+  return true;
+}
+
+bool halJournalBegin() {
+  memset(simFlash, 0xFF, sizeof(simFlash));
+  JournalFlash flash = { SIM_JOURNAL_SIZE, simFlashRead, simFlashWrite, simFlashErase };
+  return journalBegin(flash);
+}
+
+// NVS giả trong RAM (mất khi thoát)
+#define SIM_SETTINGS 8
+
+struct SimSetting {
+  char key[16];
+  uint32_t value;
+};
+
+static SimSetting simSettings[SIM_SETTINGS];
+static uint8_t simSettingCount = 0;
+
+uint32_t halSettingGet(const char* key, uint32_t fallback) {
+  for (uint8_t i = 0; i < simSettingCount; i++) {
+    if (strcmp(simSettings[i].key, key) == 0) return simSettings[i].value;
+  }
+  return fallback;
+}
+
+void halSettingPut(const char* key, uint32_t value) {
+  for (uint8_t i = 0; i < simSettingCount; i++) {
+    if (strcmp(simSettings[i].key, key) == 0) {
+      simSettings[i].value = value;
+      return;
+    }
+  }
+  if (simSettingCount >= SIM_SETTINGS) return;
+  SimSetting& s = simSettings[simSettingCount++];
+  snprintf(s.key, sizeof(s.key), "%s", key);
+  s.value = value;
+}
+
+static int simHttpCode = 200;
+static bool simScriptError = false;
+
+static int simTransport(const char*, const char*, size_t len, bool* accepted) {
+  if (!simQuiet) {
+    printf("[Sim] %6u ms  POST %u byte -> %d%s\n", (unsigned)simMs, (unsigned)len, simHttpCode,
+           simScriptError ? " (script lỗi)" : "");
+  }
+  *accepted = !simScriptError;
+  return simHttpCode;
+}
+
+bool halUplinkBegin(const char* scriptUrl) {
+  return uplinkBegin(scriptUrl, simTransport);
+}
+
+// ==================== NGUỒN GIẢ ====================
+void halSetCpuMhz(uint32_t mhz) {
+  if (mhz != simCpuMhz && !simQuiet) {
+    printf("[Sim] %6u ms  CPU %u MHz\n", (unsigned)simMs, (unsigned)mhz);
+  }
+  simCpuMhz = mhz;
+}
+
+uint32_t halCpuMhz() {
+  return simCpuMhz;
+}
+
+// Ngủ bằng cách cho đồng hồ chạy thẳng, tối đa tới hết lệnh "wait" hiện tại.
+// Phát lại bản ghi: đầu vào tới theo giờ đã ghi -> không ngủ
+HalWakeCause halLightSleep(uint32_t maxMs) {
+  if (simKeypad.pending() || simFinger.placed || pinLevels[SOUND_PIN] == HIGH) return HAL_WAKE_GPIO;
+  if (simQuiet) return HAL_WAKE_OTHER;
+
+  uint32_t left = (int32_t)(simRunEnd - simMs) > 0 ? simRunEnd - simMs : 0;
+  if (maxMs <= left) {
+    simMs += maxMs;
+    return HAL_WAKE_TIMER;
+  }
+  simMs += left;
+  return HAL_WAKE_OTHER;
+}
+
+// ==================== VÒNG MÔ PHỎNG ====================
+// 1 vòng: việc của task cảm biến + loop() + việc của task uplink
+static void simStep() {
+  sensorsService(simMs);
+  uint32_t before = simMs;
+  loop();
+  if (simMs == before) simMs += 1;  // loop() luôn phải làm đồng hồ chạy
+  uplinkService(simMs);
+  if (simDisplay.dirty) simDisplay.dump();
+}
+
+static void simRun(uint32_t ms) {
+  uint32_t end = simMs + ms;
+  simRunEnd = end;
+  while ((int32_t)(simMs - end) < 0) simStep();
+}
+
+static void simCommand(char* line) {
+  char* arg = strchr(line, ' ');
+  if (arg) *arg++ = '\0';
+  else arg = line + strlen(line);
+
+  if (strcmp(line, "wait") == 0) {
+    simRun((uint32_t)strtoul(arg, nullptr, 10));
+  } else if (strcmp(line, "key") == 0) {
+    for (; *arg; arg++) {
+      if (*arg != ' ') simKeypad.press(*arg);
+    }
+  } else if (strcmp(line, "finger") == 0 && strncmp(arg, "mute ", 5) == 0) {
+    simFinger.muted = (uint16_t)atoi(arg + 5);
+  } else if (strcmp(line, "finger") == 0) {
+    char* end;
+    simFinger.placed = strcmp(arg, "off") == 0 ? 0 : (int)strtol(arg, &end, 10);
+    if (simFinger.placed) simFinger.score = *end ? (uint16_t)atoi(end) : SIM_FINGER_SCORE;
+    simSetPin(FINGER_TOUCH_PIN, simFinger.placed ? FINGER_TOUCH_ACTIVE : !FINGER_TOUCH_ACTIVE);
+  } else if (strcmp(line, "temp") == 0) {
+    char* end;
+    simClimate.temperature = strtof(arg, &end);
+    if (*end) simClimate.humidity = strtof(end, nullptr);
+  } else if (strcmp(line, "light") == 0) {
+    pinAnalog[LDR_ANALOG] = atoi(arg);
+  } else if (strcmp(line, "sound") == 0 && *arg) {
+    simSetPin(SOUND_PIN, strcmp(arg, "off") == 0 ? LOW : HIGH);
+  } else if (strcmp(line, "sound") == 0) {
+    simSetPin(SOUND_PIN, HIGH);
+    simSetPin(SOUND_PIN, LOW);
+  } else if (strcmp(line, "http") == 0) {
+    char* end;
+    simHttpCode = (int)strtol(arg, &end, 10);
+    simScriptError = strstr(end, "error") != nullptr;
+  } else if (strcmp(line, "serial") == 0) {
+    simConsole.type(arg);
+    simConsole.type("\n");
+  } else if (strcmp(line, "lcd") == 0) {
+    simDisplay.dump();
+  } else {
+    printf("[Sim] Lệnh không hợp lệ: %s\n", line);
+  }
+}
+
+void halSimSetup() {
+  simSetPin(FINGER_TOUCH_PIN, !FINGER_TOUCH_ACTIVE);
+  pinAnalog[LDR_ANALOG] = 1000;
+  setup();
+}
+
+void halSimCommand(const char* line) {
+  char buf[128];
+  snprintf(buf, sizeof(buf), "%s", line);
+  simCommand(buf);
+}
+
+// pio test: test/test_*/ có main() riêng của Unity
+#if !defined(PIO_UNIT_TESTING)
+
+#if INPUT_TRACE
+// Phát lại bản ghi, đo tốc độ xử lý của loop()
+static int simReplay(const char* path) {
+  if (!traceReplayLoad(path)) {
+    fprintf(stderr, "Không mở được %s\n", path);
+    return 1;
+  }
+  simQuiet = true;
+
+  timespec start;
+  timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  halSimSetup();
+  uint32_t loops = 0;
+  uint32_t endMs = traceReplayEndMs() + TRACE_MAX_SKEW_MS;
+  while ((int32_t)(simMs - endMs) < 0) {
+    // Giữ chân chạm WAK khi có lệnh AS608 đã ghi tới hạn
+    simSetPin(FINGER_TOUCH_PIN, traceReplayFingerDue(simMs) ? FINGER_TOUCH_ACTIVE
+                                                            : !FINGER_TOUCH_ACTIVE);
+    uint32_t before = simMs;
+    loop();
+    if (simMs == before) simMs += 1;
+    uplinkService(simMs);
+    loops++;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double wallMs = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+  if (wallMs <= 0) wallMs = 0.001;
+
+  uint32_t mismatches = traceReplayReport();
+  printf("[Replay] %.1f s mô phỏng trong %.1f ms (x%.0f) | %lu vòng loop() | %.0f vòng/s\n",
+         simMs / 1000.0, wallMs, simMs / wallMs, (unsigned long)loops, loops * 1000.0 / wallMs);
+  return mismatches ? 1 : 0;
+}
+#endif
+
+int main(int argc, char** argv) {
+#if INPUT_TRACE
+  if (argc > 2 && strcmp(argv[1], "--replay") == 0) return simReplay(argv[2]);
+#endif
+
+  FILE* script = stdin;
+  if (argc > 1) {
+    script = fopen(argv[1], "r");
+    if (!script) {
+      fprintf(stderr, "Không mở được %s\n", argv[1]);
+      return 1;
+    }
+  }
+
+  halSimSetup();
+
+  char line[128];
+  while (fgets(line, sizeof(line), script)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '\0' || line[0] == '#') continue;
+    printf("> %s\n", line);
+    simCommand(line);
+  }
+  return 0;
+}
+
+#endif  // PIO_UNIT_TESTING
+
+#endif
@@ -0,0 +1,489 @@
+/*
+ * INPUT TRACE - Ghi lại / phát lại mọi đầu vào của loop()
+ * Xem include/input_trace.h
+ */
+
+#include "input_trace.h"
+#include "as608.h"
+
+#if INPUT_TRACE
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ==================== BẢN GHI ====================
+struct TraceRecord {
+  uint32_t atMs;
+  char kind;      // K F S N W P L
+  uint8_t arg;
+  uint16_t a;
+  uint16_t b;
+  uint16_t c;
+};
+
+// Lệnh AS608 (arg của bản ghi F)
+enum TraceFingerOp : uint8_t {
+  TRACE_FP_BEGIN,
+  TRACE_FP_GET_IMAGE,
+  TRACE_FP_IMAGE2TZ,
+  TRACE_FP_SEARCH,
+  TRACE_FP_CREATE,
+  TRACE_FP_STORE,
+  TRACE_FP_DELETE,
+  TRACE_FP_EMPTY,
+  TRACE_FP_COUNT,
+  TRACE_FP_FAST_SEARCH
+};
+
+#define TRACE_PINS 40              // GPIO 0-39
+#define TRACE_NAN_TENTHS 0x8000    // Nhiệt độ / độ ẩm đọc lỗi
+
+// ==================== TRẠNG THÁI ====================
+// Ghi: bản ghi từ lúc khởi động. Phát lại: bản ghi đã nạp từ file
+static TraceRecord records[TRACE_RECORDS];
+static uint32_t recordCount = 0;
+static uint32_t recordDropped = 0;
+static bool live = false;
+
+static uint8_t pinLevel[TRACE_PINS];
+static bool pinKnown[TRACE_PINS];
+
+#if defined(ARDUINO)
+static const bool replaying = false;
+#else
+static bool replaying = false;
+#endif
+
+static void formatRecord(char* out, size_t len, const TraceRecord& r) {
+  snprintf(out, len, "T %lu %c %u %u %u %u", (unsigned long)r.atMs, r.kind, r.arg, r.a, r.b,
+           r.c);
+}
+
+static void printRecord(const TraceRecord& r) {
+  char line[48];
+  formatRecord(line, sizeof(line), r);
+  halConsole().println(line);
+}
+
+static void record(char kind, uint8_t arg, uint16_t a = 0, uint16_t b = 0, uint16_t c = 0) {
+  TraceRecord r = { halMillis(), kind, arg, a, b, c };
+  if (live) printRecord(r);
+  if (recordCount < TRACE_RECORDS) {
+    records[recordCount++] = r;
+  } else {
+    recordDropped++;
+  }
+}
+
+static uint16_t packTenths(float value) {
+  if (isnan(value)) return TRACE_NAN_TENTHS;
+  return (uint16_t)(int16_t)lroundf(value * 10.0f);
+}
+
+static float unpackTenths(uint16_t value) {
+  if (value == TRACE_NAN_TENTHS) return NAN;
+  return (int16_t)value / 10.0f;
+}
+
+// ==================== PHÁT LẠI ====================
+// Mỗi luồng đầu vào có con trỏ riêng, chạy dần qua các bản ghi cùng loại
+static uint32_t keyPos = 0;
+static uint32_t fingerPos = 0;
+static uint32_t sensorPos = 0;
+static uint32_t networkPos = 0;
+static uint32_t actionPos = 0;
+
+static bool networkUp = false;
+
+static uint32_t replayMismatches = 0;
+static uint32_t replayMatched = 0;
+static uint32_t replayMaxSkewMs = 0;
+
+#define TRACE_REPORT_MAX 20   // Số sai khác in chi tiết
+
+static const TraceRecord* peek(uint32_t& pos, const char* kinds) {
+  while (pos < recordCount && !strchr(kinds, records[pos].kind)) pos++;
+  return pos < recordCount ? &records[pos] : nullptr;
+}
+
+static bool due(const TraceRecord* r) {
+  return r && (int32_t)(halMillis() - r->atMs) >= 0;
+}
+
+static void mismatch(const char* what, const TraceRecord* expected, const TraceRecord& actual) {
+  if (replayMismatches++ >= TRACE_REPORT_MAX) return;
+  char line[48];
+  halConsole().printf("[Replay] ✗ %s tại %lu ms\n", what, (unsigned long)halMillis());
+  if (expected) {
+    formatRecord(line, sizeof(line), *expected);
+    halConsole().printf("[Replay]   đã ghi:  %s\n", line);
+  }
+  formatRecord(line, sizeof(line), actual);
+  halConsole().printf("[Replay]   thực tế: %s\n", line);
+}
+
+// So 1 hành động của loop() với hành động kế tiếp đã ghi
+static void replayAction(char kind, uint8_t arg, uint16_t a, uint16_t b, uint16_t c) {
+  TraceRecord actual = { halMillis(), kind, arg, a, b, c };
+  const TraceRecord* expected = peek(actionPos, "PL");
+  if (!expected) {
+    mismatch("Hành động thừa", nullptr, actual);
+    return;
+  }
+  actionPos++;
+
+  if (expected->kind != kind || expected->arg != arg || expected->a != a ||
+      expected->b != b || expected->c != c) {
+    mismatch("Hành động khác", expected, actual);
+    return;
+  }
+
+  uint32_t skew = actual.atMs > expected->atMs ? actual.atMs - expected->atMs
+                                               : expected->atMs - actual.atMs;
+  if (skew > replayMaxSkewMs) replayMaxSkewMs = skew;
+  if (skew > TRACE_MAX_SKEW_MS) {
+    mismatch("Hành động lệch giờ", expected, actual);
+    return;
+  }
+  replayMatched++;
+}
+
+static char replayKey() {
+  const TraceRecord* r = peek(keyPos, "K");
+  if (!due(r)) return 0;
+  keyPos++;
+  return (char)r->arg;
+}
+
+static bool replaySensor(SensorMsg& msg) {
+  const TraceRecord* r = peek(sensorPos, "SN");
+  if (!due(r)) return false;
+  sensorPos++;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.atMs = r->atMs;
+  if (r->kind == 'N') {
+    msg.kind = SENSOR_SOUND;
+  } else {
+    msg.kind = SENSOR_CLIMATE;
+    msg.temperature = unpackTenths(r->a);
+    msg.humidity = unpackTenths(r->b);
+    msg.lightLevel = r->c;
+  }
+  return true;
+}
+
+static bool replayConnected() {
+  const TraceRecord* r;
+  while (due(r = peek(networkPos, "W"))) {
+    networkUp = r->arg != 0;
+    networkPos++;
+  }
+  return networkUp;
+}
+
+// ==================== BỌC THIẾT BỊ ====================
+class TraceKeypad : public HalKeypad {
+ public:
+  explicit TraceKeypad(HalKeypad& inner) : inner(inner) {}
+
+  char getKey() override {
+    if (replaying) return replayKey();
+    char key = inner.getKey();
+    if (key) record('K', (uint8_t)key);
+    return key;
+  }
+
+ private:
+  HalKeypad& inner;
+};
+
+// Lệnh AS608 của 1 gói lệnh (-1: lệnh không ghi)
+static int fingerOp(uint8_t code) {
+  switch (code) {
+    case AS608_CMD_VERIFY: return TRACE_FP_BEGIN;
+    case AS608_CMD_GET_IMAGE: return TRACE_FP_GET_IMAGE;
+    case AS608_CMD_IMAGE2TZ: return TRACE_FP_IMAGE2TZ;
+    case AS608_CMD_SEARCH: return TRACE_FP_SEARCH;
+    case AS608_CMD_FAST_SEARCH: return TRACE_FP_FAST_SEARCH;
+    case AS608_CMD_CREATE: return TRACE_FP_CREATE;
+    case AS608_CMD_STORE: return TRACE_FP_STORE;
+    case AS608_CMD_DELETE: return TRACE_FP_DELETE;
+    case AS608_CMD_EMPTY: return TRACE_FP_EMPTY;
+    case AS608_CMD_COUNT: return TRACE_FP_COUNT;
+    default: return -1;
+  }
+}
+
+// Bọc UART của cảm biến: ghép gói lệnh gửi đi để biết lệnh nào, ghép gói
+// trả lời để ghi kết quả. Phát lại: gói trả lời dựng từ bản ghi; lệnh không
+// ghi (dò / đổi tốc độ UART, as608_link.h; bảng chỉ mục 32 byte / trang,
+// finger_slots.h) vẫn đi qua cảm biến thật / giả
+class TraceFingerPort : public HalFingerPort {
+ public:
+  explicit TraceFingerPort(HalFingerPort& inner) : inner(inner) {}
+
+  void begin(uint32_t baud) override {
+    inner.begin(baud);
+  }
+
+  void write(const uint8_t* data, size_t len) override {
+    for (size_t i = 0; i < len; i++) {
+      if (!tx.feed(data[i]) || tx.bad || tx.length == 0) continue;
+      op = fingerOp(tx.data[0]);
+      passthrough = op < 0;
+      if (replaying && op >= 0) replay();
+    }
+    if (!replaying || passthrough) inner.write(data, len);
+  }
+
+  int read() override {
+    if (replaying && !passthrough) {
+      if (outPos >= outLen || !due(&reply)) return -1;
+      return out[outPos++];
+    }
+    int byte = inner.read();
+    if (!replaying && byte >= 0 && rx.feed((uint8_t)byte) && !rx.bad &&
+        rx.pid == AS608_PID_ACK && rx.length > 0 && op >= 0) {
+      finish(rx.data, rx.length);
+    }
+    return byte;
+  }
+
+ private:
+  // Ghi kết quả lệnh vừa xong (bỏ các lần hỏi không có ngón tay)
+  void finish(const uint8_t* d, uint8_t len) {
+    uint8_t code = d[0];
+    uint16_t id = 0;
+    uint16_t c = 0;
+    if ((op == TRACE_FP_SEARCH || op == TRACE_FP_FAST_SEARCH) && len >= 5) {
+      id = (uint16_t)(d[1] << 8) | d[2];
+      c = (uint16_t)(d[3] << 8) | d[4];
+    } else if (op == TRACE_FP_COUNT && len >= 3) {
+      c = (uint16_t)(d[1] << 8) | d[2];
+    }
+    if (op == TRACE_FP_BEGIN) code = code == FINGERPRINT_OK ? 1 : 0;  // 1 = có cảm biến
+    if (op != TRACE_FP_GET_IMAGE || code != FINGERPRINT_NOFINGER || held) {
+      record('F', (uint8_t)op, code, id, c);
+    }
+    if (op == TRACE_FP_GET_IMAGE) hold(code);
+    op = -1;
+  }
+
+  // Ngón tay đặt (getImage OK) / nhấc ra (NOFINGER); mã khác giữ nguyên
+  void hold(uint8_t code) {
+    if (code == FINGERPRINT_OK) held = true;
+    if (code == FINGERPRINT_NOFINGER) held = false;
+  }
+
+  // getImage() chỉ lấy bản ghi đã tới hạn; các lệnh sau đó trong cùng
+  // lượt quét lấy bản ghi kế tiếp, trả lời đúng lúc đã ghi (lúc xong lệnh).
+  // Lần hỏi không có trong bản ghi: NOFINGER, hoặc IMAGEFAIL khi ngón tay
+  // vẫn đặt (chưa tới bản ghi nhấc tay) -> không ai tưởng đã nhấc tay
+  void replay() {
+    const TraceRecord* r = peek(fingerPos, "F");
+    uint8_t data[5] = {};
+    uint8_t len = 1;
+    reply.atMs = halMillis();
+
+    if (op == TRACE_FP_GET_IMAGE && !due(r)) {
+      data[0] = held ? FINGERPRINT_IMAGEFAIL : FINGERPRINT_NOFINGER;
+    } else if (!r || r->arg != op) {
+      TraceRecord actual = { halMillis(), 'F', (uint8_t)op, 0, 0, 0 };
+      mismatch("Lệnh AS608 khác", r, actual);
+      data[0] = FINGERPRINT_PACKETRECIEVEERR;
+    } else {
+      fingerPos++;
+      if (!due(r)) reply.atMs = r->atMs;
+      data[0] = (uint8_t)r->a;
+      if (op == TRACE_FP_BEGIN) {
+        data[0] = r->a ? FINGERPRINT_OK : FINGERPRINT_PASSFAIL;
+      } else if (op == TRACE_FP_SEARCH || op == TRACE_FP_FAST_SEARCH) {
+        data[1] = (uint8_t)(r->b >> 8);
+        data[2] = (uint8_t)r->b;
+        data[3] = (uint8_t)(r->c >> 8);
+        data[4] = (uint8_t)r->c;
+        len = 5;
+      } else if (op == TRACE_FP_COUNT) {
+        data[1] = (uint8_t)(r->c >> 8);
+        data[2] = (uint8_t)r->c;
+        len = 3;
+      } else if (op == TRACE_FP_GET_IMAGE) {
+        hold(data[0]);
+      }
+    }
+    outLen = as608Frame(out, AS608_PID_ACK, data, len);
+    outPos = 0;
+  }
+
+  HalFingerPort& inner;
+  As608Parser tx;
+  As608Parser rx;
+  int op = -1;              // Lệnh đang chờ trả lời (TraceFingerOp)
+  bool passthrough = false; // Lệnh đang chờ không ghi vào bản ghi
+  bool held = false;        // Ngón tay đang đặt: ghi cả lần getImage() NOFINGER kế tiếp
+
+  // Phát lại: gói trả lời dựng sẵn, đọc được từ reply.atMs
+  TraceRecord reply = {};
+  uint8_t out[AS608_FRAME_MAX];
+  size_t outLen = 0;
+  size_t outPos = 0;
+};
+
+class TraceNetwork : public HalNetwork {
+ public:
+  explicit TraceNetwork(HalNetwork& inner) : inner(inner) {}
+
+  void begin(const char* ssid, const char* password) override {
+    if (!replaying) inner.begin(ssid, password);
+  }
+
+  bool connected() override {
+    if (replaying) return replayConnected();
+    bool up = inner.connected();
+    if (!seen || up != last) record('W', up ? 1 : 0);
+    seen = true;
+    last = up;
+    return up;
+  }
+
+  const char* address() override {
+    return replaying ? "0.0.0.0" : inner.address();
+  }
+
+ private:
+  HalNetwork& inner;
+  bool seen = false;
+  bool last = false;
+};
+
+// ==================== API ====================
+HalKeypad& traceKeypad(HalKeypad& inner) {
+  static TraceKeypad keypad(inner);
+  return keypad;
+}
+
+HalFingerPort& traceFingerPort(HalFingerPort& inner) {
+  static TraceFingerPort finger(inner);
+  return finger;
+}
+
+HalNetwork& traceNetwork(HalNetwork& inner) {
+  static TraceNetwork network(inner);
+  return network;
+}
+
+bool traceSensorsReceive(SensorMsg& msg) {
+  if (replaying) return replaySensor(msg);
+  if (!sensorsReceive(msg)) return false;
+
+  if (msg.kind == SENSOR_SOUND) {
+    record('N', 0);
+  } else {
+    record('S', 0, packTenths(msg.temperature), packTenths(msg.humidity),
+           (uint16_t)msg.lightLevel);
+  }
+  return true;
+}
+
+void traceOutput(uint8_t pin, uint8_t level) {
+  if (pin >= TRACE_PINS) return;
+  if (pinKnown[pin] && pinLevel[pin] == level) return;
+  pinKnown[pin] = true;
+  pinLevel[pin] = level;
+
+  if (replaying) {
+    replayAction('P', pin, level, 0, 0);
+  } else {
+    record('P', pin, level);
+  }
+}
+
+void traceLog(LogEventType event, LogMethod method, LogUser user, LogStatus status,
+              uint16_t fingerId) {
+  uint16_t methodUser = (uint16_t)((method << 8) | user);
+  if (replaying) {
+    replayAction('L', event, methodUser, status, fingerId);
+  } else {
+    record('L', event, methodUser, status, fingerId);
+  }
+}
+
+void tracePrint() {
+  halConsole().printf("# trace: %lu bản ghi, %lu bỏ (bộ đệm đầy)\n",
+                      (unsigned long)recordCount, (unsigned long)recordDropped);
+  for (uint32_t i = 0; i < recordCount; i++) printRecord(records[i]);
+}
+
+void traceSetLive(bool on) {
+  live = on;
+}
+
+bool traceLive() {
+  return live;
+}
+
+#if !defined(ARDUINO)
+// ==================== NẠP BẢN GHI (MÁY TÍNH) ====================
+bool traceReplayLoad(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+
+  recordCount = 0;
+  char line[96];
+  while (fgets(line, sizeof(line), file)) {
+    unsigned long atMs;
+    char kind;
+    unsigned arg, a, b, c;
+    if (sscanf(line, "T %lu %c %u %u %u %u", &atMs, &kind, &arg, &a, &b, &c) != 6) continue;
+    if (recordCount >= TRACE_RECORDS) {
+      halConsole().printf("[Replay] Bản ghi quá dài, chỉ dùng %d dòng đầu\n", TRACE_RECORDS);
+      break;
+    }
+    records[recordCount++] = { (uint32_t)atMs, kind, (uint8_t)arg, (uint16_t)a, (uint16_t)b,
+                               (uint16_t)c };
+  }
+  fclose(file);
+
+  replaying = true;
+  return true;
+}
+
+bool traceReplayFingerDue(uint32_t nowMs) {
+  const TraceRecord* r = peek(fingerPos, "F");
+  return r && (int32_t)(nowMs - r->atMs) >= 0;
+}
+
+uint32_t traceReplayEndMs() {
+  return recordCount ? records[recordCount - 1].atMs : 0;
+}
+
+uint32_t traceReplayReport() {
+  // Hành động đã ghi nhưng loop() không tạo ra
+  const TraceRecord* r;
+  while ((r = peek(actionPos, "PL"))) {
+    if (replayMismatches++ < TRACE_REPORT_MAX) {
+      char line[48];
+      formatRecord(line, sizeof(line), *r);
+      halConsole().printf("[Replay] ✗ Thiếu hành động: %s\n", line);
+    }
+    actionPos++;
+  }
+
+  uint32_t unused = 0;
+  if (peek(keyPos, "K")) unused++;
+  if (peek(fingerPos, "F")) unused++;
+  if (peek(sensorPos, "SN")) unused++;
+
+  halConsole().printf("[Replay] %lu bản ghi | hành động khớp: %lu | sai khác: %lu | "
+                      "lệch giờ max: %lu ms%s\n",
+                      (unsigned long)recordCount, (unsigned long)replayMatched,
+                      (unsigned long)replayMismatches, (unsigned long)replayMaxSkewMs,
+                      unused ? " | còn đầu vào chưa dùng" : "");
+  return replayMismatches;
+}
+#endif
+
+#endif
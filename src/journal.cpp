@@ -0,0 +1,318 @@
+/*
+ * JOURNAL - Nhật ký sự kiện offline trên flash
+ * Xem include/journal.h
+ */
+
+#include "journal.h"
+#include "hal.h"
+
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <esp_partition.h>
+#endif
+
+// ==================== BỐ CỤC ====================
+struct JournalSectorHeader {
+  uint32_t magic;
+  uint32_t seq;       // Tăng dần mỗi lần dùng sector mới
+};
+
+struct JournalSlot {
+  uint32_t seq;       // Số thứ tự bản ghi (0xFFFFFFFF = ô rỗng)
+  LogEvent ev;
+  uint32_t crc;       // CRC32 của seq + ev
+  uint32_t consumed;  // 0xFFFFFFFF = chưa gửi, 0 = đã gửi
+};
+
+#define JOURNAL_ERASED 0xFFFFFFFFu
+#define JOURNAL_SLOTS_PER_SECTOR \
+  ((JOURNAL_SECTOR_SIZE - sizeof(JournalSectorHeader)) / sizeof(JournalSlot))
+
+// ==================== TRẠNG THÁI ====================
+static JournalFlash jf;
+static bool jReady = false;
+static uint32_t jSectors = 0;
+static uint32_t headSector = 0, headSlot = 0;  // Vị trí ghi tiếp theo
+static uint32_t tailSector = 0, tailSlot = 0;  // Sự kiện cũ nhất
+static uint32_t jCount = 0;
+static uint32_t jLost = 0;
+static uint32_t sectorSeq = 0;
+static uint32_t recordSeq = 0;
+
+// ==================== CRC32 ====================
+static uint32_t crc32(const void* data, size_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  uint32_t crc = 0xFFFFFFFF;
+  while (len--) {
+    crc ^= *p++;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+// ==================== TRUY CẬP FLASH ====================
+static uint32_t sectorAddr(uint32_t sector) {
+  return sector * JOURNAL_SECTOR_SIZE;
+}
+
+static uint32_t slotAddr(uint32_t sector, uint32_t slot) {
+  return sectorAddr(sector) + sizeof(JournalSectorHeader) + slot * sizeof(JournalSlot);
+}
+
+static bool sectorValid(uint32_t sector, uint32_t* seq = nullptr) {
+  JournalSectorHeader hdr;
+  if (!jf.read(sectorAddr(sector), &hdr, sizeof(hdr))) return false;
+  if (hdr.magic != JOURNAL_MAGIC) return false;
+  if (seq) *seq = hdr.seq;
+  return true;
+}
+
+static bool readSlot(uint32_t sector, uint32_t slot, JournalSlot& out) {
+  return jf.read(slotAddr(sector, slot), &out, sizeof(out));
+}
+
+// Ô có dữ liệu hợp lệ và chưa gửi
+static bool slotLive(const JournalSlot& s) {
+  if (s.seq == JOURNAL_ERASED || s.consumed != JOURNAL_ERASED) return false;
+  return s.crc == crc32(&s, offsetof(JournalSlot, crc));
+}
+
+static uint32_t nextSector(uint32_t sector) {
+  return (sector + 1) % jSectors;
+}
+
+// Dịch con trỏ đọc sang ô kế tiếp, bỏ qua sector rỗng.
+// Trả về false khi đã tới vị trí ghi (hết dữ liệu)
+static bool cursorAdvance(uint32_t& sector, uint32_t& slot) {
+  if (sector == headSector) {
+    if (slot < headSlot) slot++;
+    return slot < headSlot;
+  }
+  if (++slot < JOURNAL_SLOTS_PER_SECTOR) return true;
+  do {
+    sector = nextSector(sector);
+    slot = 0;
+  } while (sector != headSector && !sectorValid(sector));
+  return sector != headSector || slot < headSlot;
+}
+
+static bool cursorAtEnd(uint32_t sector, uint32_t slot) {
+  return sector == headSector && slot >= headSlot;
+}
+
+// ==================== KHỞI TẠO / KHÔI PHỤC ====================
+bool journalBegin(const JournalFlash& flash) {
+  jf = flash;
+  jReady = false;
+  jSectors = flash.size / JOURNAL_SECTOR_SIZE;
+  jCount = 0;
+  jLost = 0;
+  recordSeq = 0;
+  if (jSectors < 2 || !flash.read || !flash.write || !flash.eraseSector) return false;
+
+  // Sector mới nhất = sector có số thứ tự lớn nhất
+  bool found = false;
+  sectorSeq = 0;
+  for (uint32_t s = 0; s < jSectors; s++) {
+    uint32_t seq;
+    if (sectorValid(s, &seq) && (!found || seq > sectorSeq)) {
+      found = true;
+      sectorSeq = seq;
+      headSector = s;
+    }
+  }
+
+  if (!found) {
+    // Flash trống: lần ghi đầu tiên sẽ chuyển sang sector 0
+    headSector = jSectors - 1;
+    headSlot = JOURNAL_SLOTS_PER_SECTOR;
+    tailSector = 0;
+    tailSlot = 0;
+    jReady = true;
+    return true;
+  }
+
+  // Vị trí ghi = ô rỗng đầu tiên trong sector mới nhất
+  headSlot = JOURNAL_SLOTS_PER_SECTOR;
+  for (uint32_t i = 0; i < JOURNAL_SLOTS_PER_SECTOR; i++) {
+    uint32_t seq;
+    if (!jf.read(slotAddr(headSector, i), &seq, sizeof(seq))) return false;
+    if (seq == JOURNAL_ERASED) {
+      headSlot = i;
+      break;
+    }
+  }
+
+  // Duyệt từ sector cũ nhất tới mới nhất: đếm sự kiện chưa gửi, tìm tail
+  bool tailFound = false;
+  for (uint32_t i = 1; i <= jSectors; i++) {
+    uint32_t s = (headSector + i) % jSectors;
+    if (!sectorValid(s)) continue;
+    uint32_t last = (s == headSector) ? headSlot : JOURNAL_SLOTS_PER_SECTOR;
+    for (uint32_t slot = 0; slot < last; slot++) {
+      JournalSlot js;
+      if (!readSlot(s, slot, js)) return false;
+      if (js.seq != JOURNAL_ERASED && js.seq >= recordSeq) recordSeq = js.seq + 1;
+      if (!slotLive(js)) continue;
+      jCount++;
+      if (!tailFound) {
+        tailFound = true;
+        tailSector = s;
+        tailSlot = slot;
+      }
+    }
+  }
+  if (!tailFound) {
+    tailSector = headSector;
+    tailSlot = headSlot;
+  }
+
+  jReady = true;
+  return true;
+}
+
+bool journalReady() {
+  return jReady;
+}
+
+// ==================== GHI ====================
+// Chuyển vị trí ghi sang sector kế tiếp (xóa trước khi dùng)
+static bool advanceHead() {
+  uint32_t next = nextSector(headSector);
+
+  if (jCount == 0) {
+    tailSector = next;
+    tailSlot = 0;
+  } else if (next == tailSector) {
+    // Đầy: bỏ sector cũ nhất để có chỗ ghi
+    uint32_t dropped = 0;
+    for (uint32_t slot = tailSlot; slot < JOURNAL_SLOTS_PER_SECTOR; slot++) {
+      JournalSlot js;
+      if (readSlot(next, slot, js) && slotLive(js)) dropped++;
+    }
+    jCount -= dropped;
+    jLost += dropped;
+    tailSector = nextSector(next);
+    tailSlot = 0;
+    halConsole().printf("[Journal] ✗ Đầy - bỏ %u sự kiện cũ nhất\n", (unsigned)dropped);
+  }
+
+  if (!jf.eraseSector(sectorAddr(next))) return false;
+
+  JournalSectorHeader hdr = {JOURNAL_MAGIC, ++sectorSeq};
+  if (!jf.write(sectorAddr(next), &hdr, sizeof(hdr))) return false;
+
+  headSector = next;
+  headSlot = 0;
+  return true;
+}
+
+bool journalAppend(const LogEvent& ev) {
+  if (!jReady) return false;
+  if (headSlot >= JOURNAL_SLOTS_PER_SECTOR && !advanceHead()) return false;
+
+  JournalSlot js;
+  memset(&js, 0xFF, sizeof(js));  // Byte đệm cố định -> CRC ổn định
+  js.seq = recordSeq++;
+  js.ev = ev;
+  js.crc = crc32(&js, offsetof(JournalSlot, crc));
+  js.consumed = JOURNAL_ERASED;
+
+  // Không ghi word consumed -> giữ 0xFF để sau này đánh dấu đã gửi
+  bool ok = jf.write(slotAddr(headSector, headSlot), &js, offsetof(JournalSlot, consumed));
+  headSlot++;
+  if (ok) jCount++;
+  return ok;
+}
+
+// ==================== ĐỌC / ĐÁNH DẤU ĐÃ GỬI ====================
+uint8_t journalPeek(LogEvent* out, uint8_t max) {
+  if (!jReady || jCount == 0) return 0;
+
+  uint32_t sector = tailSector, slot = tailSlot;
+  uint8_t n = 0;
+  while (n < max && !cursorAtEnd(sector, slot)) {
+    JournalSlot js;
+    if (readSlot(sector, slot, js) && slotLive(js)) out[n++] = js.ev;
+    if (!cursorAdvance(sector, slot)) break;
+  }
+  return n;
+}
+
+void journalConsume(uint8_t n) {
+  if (!jReady) return;
+
+  static const uint32_t consumed = 0;
+  while (n > 0 && jCount > 0 && !cursorAtEnd(tailSector, tailSlot)) {
+    JournalSlot js;
+    if (readSlot(tailSector, tailSlot, js) && slotLive(js)) {
+      jf.write(slotAddr(tailSector, tailSlot) + offsetof(JournalSlot, consumed),
+               &consumed, sizeof(consumed));
+      jCount--;
+      n--;
+    }
+
+    uint32_t oldSector = tailSector;
+    cursorAdvance(tailSector, tailSlot);
+    // Rời khỏi sector đã gửi hết -> xóa luôn để lần khởi động sau quét nhanh
+    if (tailSector != oldSector) jf.eraseSector(sectorAddr(oldSector));
+  }
+}
+
+uint32_t journalCount() {
+  return jCount;
+}
+
+uint32_t journalCapacity() {
+  return jSectors * JOURNAL_SLOTS_PER_SECTOR;
+}
+
+uint32_t journalLost() {
+  return jLost;
+}
+
+#if defined(ARDUINO)
+// ==================== ESP32: PHÂN VÙNG FLASH ====================
+static const esp_partition_t* journalPart = nullptr;
+
+static bool partRead(uint32_t addr, void* buf, size_t len) {
+  return esp_partition_read(journalPart, addr, buf, len) == ESP_OK;
+}
+
+static bool partWrite(uint32_t addr, const void* buf, size_t len) {
+  return esp_partition_write(journalPart, addr, buf, len) == ESP_OK;
+}
+
+static bool partErase(uint32_t addr) {
+  return esp_partition_erase_range(journalPart, addr, JOURNAL_SECTOR_SIZE) == ESP_OK;
+}
+
+bool journalBeginPartition(const char* label) {
+  journalPart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                         ESP_PARTITION_SUBTYPE_ANY, label);
+  if (!journalPart) {
+    halConsole().printf("[Journal] ✗ Không tìm thấy phân vùng '%s'!\n", label);
+    return false;
+  }
+
+  JournalFlash flash;
+  flash.size = journalPart->size - journalPart->size % JOURNAL_SECTOR_SIZE;
+  flash.read = partRead;
+  flash.write = partWrite;
+  flash.eraseSector = partErase;
+
+  if (!journalBegin(flash)) {
+    halConsole().println("[Journal] ✗ Không khởi tạo được nhật ký offline!");
+    return false;
+  }
+
+  halConsole().printf("[Journal] ✓ Phân vùng '%s': %u KB, tối đa %u sự kiện, %u chờ gửi lại\n",
+                      label, (unsigned)(flash.size / 1024), (unsigned)journalCapacity(),
+                      (unsigned)journalCount());
+  return true;
+}
+#endif
@@ -0,0 +1,131 @@
+/*
+ * LOG AGGREGATE - Gộp chuỗi lỗi giống nhau thành 1 sự kiện tổng hợp
+ * Xem include/log_aggregate.h
+ */
+
+#include "log_aggregate.h"
+#include "event_clock.h"
+
+// ==================== TRẠNG THÁI ====================
+struct AggSlot {
+  bool used;
+  LogEvent first;       // Sự kiện đầu tiên của nhóm (giữ nguyên nội dung)
+  uint16_t count;
+  uint32_t firstMs;     // Thời điểm nhận lần đầu / lần cuối (đồng hồ bộ gộp)
+  uint32_t lastMs;
+  uint32_t lastUptimeMs;  // Dấu thời gian của lần cuối (event_clock)
+  uint32_t lastEpoch;
+};
+
+static AggSlot slots[LOG_AGG_SLOTS];
+static LogSink aggSink = nullptr;
+static uint32_t aggSuppressed = 0;
+
+void logAggregateBegin(LogSink sink) {
+  aggSink = sink;
+  aggSuppressed = 0;
+  for (uint8_t i = 0; i < LOG_AGG_SLOTS; i++) slots[i].used = false;
+}
+
+static bool aggregatable(const LogEvent& ev) {
+  return ev.status == LOG_FAILED;
+}
+
+static bool sameKind(const LogEvent& a, const LogEvent& b) {
+  return a.event == b.event && a.method == b.method && a.user == b.user &&
+         a.status == b.status && a.fingerId == b.fingerId;
+}
+
+// ==================== GỬI NHÓM ====================
+static void emit(AggSlot& s) {
+  s.used = false;
+  if (!aggSink) return;
+
+  // Thời điểm của nhóm = lần xảy ra cuối cùng
+  LogEvent ev = s.first;
+  eventClockResequence(ev);
+  ev.uptimeMs = s.lastUptimeMs;
+  ev.epoch = s.lastEpoch;
+  ev.count = s.count;
+  ev.spanMs = s.lastUptimeMs - s.first.uptimeMs;
+  aggSink(ev);
+}
+
+// Gửi các nhóm theo thứ tự lần đầu xuất hiện
+static void emitAll() {
+  for (;;) {
+    AggSlot* oldest = nullptr;
+    for (uint8_t i = 0; i < LOG_AGG_SLOTS; i++) {
+      if (slots[i].used && (!oldest || (int32_t)(slots[i].firstMs - oldest->firstMs) < 0)) {
+        oldest = &slots[i];
+      }
+    }
+    if (!oldest) return;
+    emit(*oldest);
+  }
+}
+
+// ==================== API ====================
+void logAggregateSubmit(const LogEvent& ev, uint32_t nowMs) {
+  if (!aggregatable(ev)) {
+    emitAll();
+    if (aggSink) {
+      // Script lọc trùng theo seq tăng dần -> seq phải theo đúng thứ tự gửi,
+      // nhóm vừa gửi ở trên phải có seq nhỏ hơn sự kiện này
+      LogEvent out = ev;
+      eventClockResequence(out);
+      aggSink(out);
+    }
+    return;
+  }
+
+  AggSlot* freeSlot = nullptr;
+  AggSlot* oldest = nullptr;
+  for (uint8_t i = 0; i < LOG_AGG_SLOTS; i++) {
+    AggSlot& s = slots[i];
+    if (!s.used) {
+      if (!freeSlot) freeSlot = &s;
+      continue;
+    }
+    if (sameKind(s.first, ev)) {
+      s.count++;
+      s.lastMs = nowMs;
+      s.lastUptimeMs = ev.uptimeMs;
+      s.lastEpoch = ev.epoch;
+      aggSuppressed++;
+      if (s.count == UINT16_MAX) emit(s);
+      return;
+    }
+    if (!oldest || (int32_t)(s.firstMs - oldest->firstMs) < 0) oldest = &s;
+  }
+
+  if (!freeSlot) {
+    emit(*oldest);
+    freeSlot = oldest;
+  }
+  freeSlot->used = true;
+  freeSlot->first = ev;
+  freeSlot->count = 1;
+  freeSlot->firstMs = nowMs;
+  freeSlot->lastMs = nowMs;
+  freeSlot->lastUptimeMs = ev.uptimeMs;
+  freeSlot->lastEpoch = ev.epoch;
+}
+
+void logAggregateService(uint32_t nowMs) {
+  for (uint8_t i = 0; i < LOG_AGG_SLOTS; i++) {
+    AggSlot& s = slots[i];
+    if (!s.used) continue;
+    if (nowMs - s.lastMs >= LOG_AGG_QUIET_MS || nowMs - s.firstMs >= LOG_AGG_MAX_SPAN_MS) {
+      emit(s);
+    }
+  }
+}
+
+void logAggregateFlush() {
+  emitAll();
+}
+
+uint32_t logAggregateSuppressed() {
+  return aggSuppressed;
+}
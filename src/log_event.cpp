@@ -0,0 +1,197 @@
+/*
+ * LOG EVENT - Bản ghi sự kiện gọn và định dạng không cấp phát heap
+ * Xem include/log_event.h
+ */
+
+#include "log_event.h"
+
+// ==================== BẢNG TÊN ====================
+static const char* const EVENT_NAMES[LOG_EVENT_TYPE_COUNT] = {
+  "DOOR_OPEN",
+  "SYSTEM_LOCKED",
+  "FINGER_LOCKED",
+};
+
+static const char* const METHOD_NAMES[LOG_METHOD_COUNT] = {
+  "PASSWORD",
+  "FINGERPRINT",
+  "2FA",
+};
+
+static const char* const USER_NAMES[LOG_USER_COUNT] = {
+  "Unknown",
+  "ADMIN",
+  "USER",
+  "Finger_ID_",
+};
+
+static const char* const STATUS_NAMES[LOG_STATUS_COUNT] = {
+  "SUCCESS",
+  "SUCCESS_AFTER_FINGER_LOCK",
+  "FAILED",
+  "LOCKED_3_ATTEMPTS",
+};
+
+const char* logEventName(LogEventType event) {
+  return event < LOG_EVENT_TYPE_COUNT ? EVENT_NAMES[event] : "UNKNOWN";
+}
+
+const char* logMethodName(LogMethod method) {
+  return method < LOG_METHOD_COUNT ? METHOD_NAMES[method] : "UNKNOWN";
+}
+
+const char* logStatusName(LogStatus status) {
+  return status < LOG_STATUS_COUNT ? STATUS_NAMES[status] : "UNKNOWN";
+}
+
+LogEvent logEventMake(LogEventType event, LogMethod method, LogUser user,
+                      LogStatus status, uint16_t fingerId,
+                      float temperature, float humidity) {
+  LogEvent ev;
+  ev.event = event;
+  ev.method = method;
+  ev.user = user;
+  ev.status = status;
+  ev.fingerId = fingerId;
+
+  // NaN (cảm biến lỗi) -> 0; làm tròn thay vì cắt
+  if (!(temperature == temperature)) temperature = 0;
+  if (!(humidity == humidity)) humidity = 0;
+  float t = temperature * 10.0f;
+  ev.tempTenths = (int16_t)(t >= 0 ? t + 0.5f : t - 0.5f);
+  ev.humidity = humidity <= 0 ? 0 : humidity >= 100 ? 100 : (uint8_t)(humidity + 0.5f);
+
+  ev.count = 1;
+  ev.spanMs = 0;
+  ev.bootId = 0;
+  ev.seq = 0;
+  ev.epoch = 0;
+  ev.uptimeMs = 0;
+  return ev;
+}
+
+// ==================== BỘ GHI BUFFER ====================
+// Ghi tuần tự vào buffer cố định, tràn -> đánh dấu lỗi và ngừng ghi
+struct BufWriter {
+  char* out;
+  size_t cap;
+  size_t pos;
+  bool overflow;
+
+  BufWriter(char* o, size_t c) : out(o), cap(c), pos(0), overflow(c == 0) {
+    if (c) out[0] = '\0';
+  }
+
+  void put(char c) {
+    if (overflow || pos + 1 >= cap) {
+      overflow = true;
+      return;
+    }
+    out[pos++] = c;
+    out[pos] = '\0';
+  }
+
+  void puts(const char* s) {
+    while (*s && !overflow) put(*s++);
+  }
+
+  void putUint(uint32_t v) {
+    char tmp[10];
+    int n = 0;
+    do {
+      tmp[n++] = (char)('0' + v % 10);
+      v /= 10;
+    } while (v);
+    while (n) put(tmp[--n]);
+  }
+
+  // 8 chữ số hex chữ thường (bootId)
+  void putHex32(uint32_t v) {
+    static const char digits[] = "0123456789abcdef";
+    for (int shift = 28; shift >= 0; shift -= 4) put(digits[(v >> shift) & 0xF]);
+  }
+
+  // Số thập phân 1 chữ số sau dấu phẩy từ giá trị x10 (285 -> "28.5")
+  void putTenths(int32_t v) {
+    if (v < 0) {
+      put('-');
+      v = -v;
+    }
+    putUint((uint32_t)v / 10);
+    put('.');
+    put((char)('0' + v % 10));
+  }
+
+  int result() const {
+    return overflow ? -1 : (int)pos;
+  }
+};
+
+static void putUser(BufWriter& w, const LogEvent& ev) {
+  w.puts(ev.user < LOG_USER_COUNT ? USER_NAMES[ev.user] : "Unknown");
+  if (ev.user == LOG_USER_FINGER) w.putUint(ev.fingerId);
+}
+
+// ==================== ĐỊNH DẠNG ====================
+int logFormatUser(const LogEvent& ev, char* out, size_t outLen) {
+  BufWriter w(out, outLen);
+  putUser(w, ev);
+  return w.result();
+}
+
+int logFormatQuery(const LogEvent& ev, char* out, size_t outLen) {
+  // Mọi tên đều chỉ gồm chữ, số và '_' -> không cần mã hóa URL
+  BufWriter w(out, outLen);
+  w.puts("event=");
+  w.puts(logEventName(ev.event));
+  w.puts("&method=");
+  w.puts(logMethodName(ev.method));
+  w.puts("&user=");
+  putUser(w, ev);
+  w.puts("&status=");
+  w.puts(logStatusName(ev.status));
+  w.puts("&temp=");
+  w.putTenths(ev.tempTenths);
+  w.puts("&humidity=");
+  w.putUint(ev.humidity);
+  w.puts("&boot=");
+  w.putHex32(ev.bootId);
+  w.puts("&seq=");
+  w.putUint(ev.seq);
+  w.puts("&ts=");
+  w.putUint(ev.epoch);
+  w.puts("&count=");
+  w.putUint(ev.count);
+  w.puts("&span=");
+  w.putUint(ev.spanMs / 1000);
+  return w.result();
+}
+
+int logFormatJsonRow(const LogEvent& ev, char* out, size_t outLen) {
+  // Tên cố định không chứa '"' hay '\' -> không cần escape JSON
+  BufWriter w(out, outLen);
+  w.puts("[\"");
+  w.puts(logEventName(ev.event));
+  w.puts("\",\"");
+  w.puts(logMethodName(ev.method));
+  w.puts("\",\"");
+  putUser(w, ev);
+  w.puts("\",\"");
+  w.puts(logStatusName(ev.status));
+  w.puts("\",");
+  w.putTenths(ev.tempTenths);
+  w.put(',');
+  w.putUint(ev.humidity);
+  w.puts(",\"");
+  w.putHex32(ev.bootId);
+  w.puts("\",");
+  w.putUint(ev.seq);
+  w.put(',');
+  w.putUint(ev.epoch);
+  w.put(',');
+  w.putUint(ev.count);
+  w.put(',');
+  w.putUint(ev.spanMs / 1000);
+  w.put(']');
+  return w.result();
+}
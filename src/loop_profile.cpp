@@ -0,0 +1,127 @@
+/*
+ * LOOP PROFILE - Đo thời gian từng hàm xử lý trong loop()
+ * Xem include/loop_profile.h
+ */
+
+#include "loop_profile.h"
+
+#if LOOP_PROFILE
+
+#include "hal.h"
+
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <time.h>
+#endif
+
+// ==================== TRẠNG THÁI ====================
+// Chỉ loop() ghi -> không cần đồng bộ
+struct ProfilePoint {
+  const char* name;
+  uint32_t count;
+  uint64_t sumNs;
+  uint32_t minNs;
+  uint32_t maxNs;
+  uint32_t hist[PROFILE_BUCKETS];
+};
+
+static ProfilePoint points[PROFILE_MAX_POINTS];
+static uint8_t pointCount = 0;
+
+// ==================== ĐỒNG HỒ ====================
+#if defined(ARDUINO)
+uint32_t profileNow() {
+  return ESP.getCycleCount();
+}
+
+// Tần số lúc ghi: đo trọn trong 1 vòng loop(), powerIdle() chỉ đổi xung cuối vòng
+static uint32_t ticksPerUs() {
+  return halCpuMhz();
+}
+#else
+// Máy tính: đếm theo ns
+uint32_t profileNow() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+static uint32_t ticksPerUs() {
+  return 1000;
+}
+#endif
+
+// ==================== GHI ====================
+uint8_t profileRegister(const char* name) {
+  // Cùng tên ở nhiều chỗ (vd. getImage khi xác thực và khi đăng ký) -> gộp chung
+  for (uint8_t i = 0; i < pointCount; i++) {
+    if (strcmp(points[i].name, name) == 0) return i;
+  }
+  if (pointCount >= PROFILE_MAX_POINTS) return PROFILE_MAX_POINTS;
+  ProfilePoint& p = points[pointCount];
+  memset(&p, 0, sizeof(p));
+  p.name = name;
+  p.minNs = UINT32_MAX;
+  return pointCount++;
+}
+
+static uint8_t bucketOf(uint32_t us) {
+  if (us < 2) return 0;
+  uint8_t b = 31 - __builtin_clz(us);
+  return b < PROFILE_BUCKETS ? b : PROFILE_BUCKETS - 1;
+}
+
+void profileRecord(uint8_t id, uint32_t ticks) {
+  if (id >= pointCount) return;
+  uint64_t ns64 = (uint64_t)ticks * 1000 / ticksPerUs();
+  uint32_t ns = ns64 > UINT32_MAX ? UINT32_MAX : (uint32_t)ns64;
+
+  ProfilePoint& p = points[id];
+  p.count++;
+  p.sumNs += ns;
+  if (ns < p.minNs) p.minNs = ns;
+  if (ns > p.maxNs) p.maxNs = ns;
+  p.hist[bucketOf(ns / 1000)]++;
+}
+
+void profileReset() {
+  for (uint8_t i = 0; i < pointCount; i++) {
+    const char* name = points[i].name;
+    memset(&points[i], 0, sizeof(points[i]));
+    points[i].name = name;
+    points[i].minNs = UINT32_MAX;
+  }
+}
+
+// ==================== IN ====================
+void profilePrint() {
+  HalConsole& console = halConsole();
+
+  console.printf("[Prof] %-19s %8s %9s %9s %9s (us)\n", "Điểm đo", "Lần", "Min", "TB", "Max");
+  for (uint8_t i = 0; i < pointCount; i++) {
+    const ProfilePoint& p = points[i];
+    if (p.count == 0) {
+      console.printf("[Prof] %-16s %8u\n", p.name, 0u);
+      continue;
+    }
+    console.printf("[Prof] %-16s %8u %9.1f %9.1f %9.1f\n", p.name, (unsigned)p.count,
+                   p.minNs / 1000.0, (double)p.sumNs / p.count / 1000.0, p.maxNs / 1000.0);
+
+    // Histogram: chỉ in ô khác 0, nhãn là cận trên của ô
+    console.printf("[Prof]   ");
+    for (uint8_t b = 0; b < PROFILE_BUCKETS; b++) {
+      if (p.hist[b] == 0) continue;
+      if (b == PROFILE_BUCKETS - 1) {
+        console.printf(" >=%uus:%u", 1u << b, (unsigned)p.hist[b]);
+      } else {
+        console.printf(" <%uus:%u", 1u << (b + 1), (unsigned)p.hist[b]);
+      }
+    }
+    console.printf("\n");
+  }
+}
+
+#endif
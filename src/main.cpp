@@ -24,7 +24,7 @@
  * 
  * Hướng dẫn sử dụng phím:
  *    A: Chuyển chế độ Thường/Bảo mật cao (2FA)
- *    B: Xem thông tin cảm biến
+ *    B: Xem thông tin cảm biến (nhấn lần nữa: trạng thái gửi log)
  *    C: Xóa mật khẩu đang nhập
  *    D: Đổi mật khẩu (nhập mật khẩu cũ trước, rồi nhấn D)
  *    #: Xác nhận mật khẩu
@@ -37,16 +37,52 @@
  *    3: Xóa TẤT CẢ vân tay
  *    4: Xem số vân tay đã lưu
  *    *: Thoát Admin Menu
+ * 
+ * PHÂN CHIA TASK (ESP32 2 nhân):
+ *    core 1 - loop(): xác thực, keypad, vân tay, LCD, relay/LED/quạt
+ *    core 0 - task "sensors": DHT11, LDR, âm thanh (sensors.h)
+ *    core 0 - task "uplink": gửi log lên Google Sheets (uplink.h)
+ *    Các task chỉ trao đổi qua hàng đợi không khóa (ring_buffer.h); trạng
+ *    thái cửa, nhiệt độ... bên dưới chỉ loop() đọc/ghi.
+ * 
+ * LỆNH SERIAL (gõ rồi Enter):
+ *    stats: In thống kê gửi log (hàng đợi, HTTP code, độ trễ)
+ *    prof: In thời gian từng hàm trong loop() (prof reset: xóa số liệu)
+ *    trace: In bản ghi đầu vào để phát lại trên máy tính (input_trace.h,
+ *           cần build flag INPUT_TRACE=1; trace live: in ngay từng bản ghi)
+ * 
+ * PHẦN CỨNG (hal.h, board.h):
+ *    File này chỉ dùng lớp HAL, không gọi thẳng thư viện Arduino.
+ *    [env:esp32dev]: src/hal_esp32.cpp (phần cứng thật)
+ *    [env:native]:   src/hal_native.cpp (thiết bị giả, chạy trên máy tính)
+ *      pio run -e native && .pio/build/native/program kichban.txt
+ *      (cú pháp kịch bản: xem đầu src/hal_native.cpp)
  */
 
-#include <Arduino.h>
-#include <Wire.h>
-#include <LiquidCrystal_I2C.h>
-#include <Keypad.h>
-#include <Adafruit_Fingerprint.h>
-#include <DHT.h>
-#include <WiFi.h>
-#include <HTTPClient.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+#include "board.h"
+#include "uplink.h"
+#include "journal.h"
+#include "uplink_metrics.h"
+#include "event_clock.h"
+#include "log_aggregate.h"
+#include "sensors.h"
+#include "finger_touch.h"
+#include "finger_poll.h"
+#include "loop_profile.h"
+#include "input_trace.h"
+#include "auth_fsm.h"
+#include "timer_wheel.h"
+#include "power.h"
+#include "as608.h"
+#include "as608_link.h"
+#include "finger_consensus.h"
+#include "finger_match.h"
+#include "finger_slots.h"
 
 // ==================== WIFI & GOOGLE SHEETS ====================
 // Thay đổi thông tin WiFi của bạn
@@ -56,56 +92,14 @@ const char* WIFI_PASSWORD = "Dk@17092004";  // Mật khẩu WiFi
 // Google Apps Script Web App URL 
 const char* GOOGLE_SCRIPT_URL = "https://script.google.com/macros/s/AKfycbxpWsXbtsYM9pqvpQ1TKvVOsREGitNTL8hjFoy099yIT25H9sNSvytg11tf-HpvJYTo/exec";
 
-// ==================== PIN DEFINITIONS ====================
-// LCD I2C
-#define LCD_SDA 21
-#define LCD_SCL 22
-
-// Fingerprint Sensor (UART2)
-#define FINGER_RX 16
-#define FINGER_TX 17
-
-// Keypad 4x4
-#define ROW1 13
-#define ROW2 12
-#define ROW3 14
-#define ROW4 27
-#define COL1 26
-#define COL2 25
-#define COL3 33
-#define COL4 32
-
-// Relay (Door Lock) - Hiện không dùng vì chỉ có 1 relay
-#define RELAY_PIN 4
-
-// LDR Light Sensor
-#define LDR_ANALOG 34
-#define LDR_DIGITAL 35
-
-// Sound Sensor
-#define SOUND_PIN 5
-
-// DHT11
-#define DHT_PIN 15
-#define DHT_TYPE DHT11
-
-// LED (Đèn chiếu sáng tự động)
-#define LED_PIN 18
-
-// LED CỬA (Sáng khi mở cửa)
-#define DOOR_LED_PIN 19
-
-// LED ÂM THANH (Sáng khi có âm thanh)
-#define SOUND_LED_PIN 23
-
-// FAN/MOTOR (Quạt làm mát) - Relay nối vào D4 (cùng relay cửa)
-#define FAN_PIN 4
-
 // ==================== SYSTEM SETTINGS ====================
 // Mật khẩu mặc định
 #define DEFAULT_ADMIN_PASSWORD "1234"
 #define DEFAULT_USER_PASSWORD "0000"
 
+// Độ dài tối đa mật khẩu
+#define PASSWORD_MAX_LEN 10
+
 // Ngưỡng cảnh báo nhiệt độ (°C)
 #define TEMP_WARNING_THRESHOLD 40.0
 
@@ -118,88 +112,98 @@ const char* GOOGLE_SCRIPT_URL = "https://script.google.com/macros/s/AKfycbxpWsXb
 // Số lần nhập sai tối đa
 #define MAX_WRONG_ATTEMPTS 3
 
-// Thời gian khóa sau khi nhập sai (ms)
-#define LOCKOUT_TIME 30000
-
 // Thời gian mở cửa (ms)
 #define DOOR_OPEN_TIME 5000
 
 // Thời gian đèn sáng khi có âm thanh (ms)
 #define SOUND_LIGHT_DURATION 10000
 
-// ==================== OBJECTS ====================
-LiquidCrystal_I2C lcd(0x27, 16, 2);
-
-const byte ROWS = 4;
-const byte COLS = 4;
-char keys[ROWS][COLS] = {
-  {'1', '2', '3', 'A'},
-  {'4', '5', '6', 'B'},
-  {'7', '8', '9', 'C'},
-  {'*', '0', '#', 'D'}
-};
-byte rowPins[ROWS] = {ROW1, ROW2, ROW3, ROW4};
-byte colPins[COLS] = {COL1, COL2, COL3, COL4};
-Keypad keypad = Keypad(makeKeymap(keys), rowPins, colPins, ROWS, COLS);
+// Thời gian tối đa cho 1 vòng loop() (không tính delay cuối vòng).
+// Vượt quá -> cảnh báo qua Serial (tối đa 1 lần / LOOP_WARN_INTERVAL)
+#define LOOP_BUDGET_MS 10
+#define LOOP_WARN_INTERVAL 10000
 
-HardwareSerial fingerSerial(2);
-Adafruit_Fingerprint finger = Adafruit_Fingerprint(&fingerSerial);
+// loop() (task điều khiển) chạy trên core này, core 0 dành cho mạng + cảm biến
+#define CONTROL_TASK_CORE 1
+#if defined(CONFIG_ARDUINO_RUNNING_CORE) && CONFIG_ARDUINO_RUNNING_CORE != CONTROL_TASK_CORE
+#warning "loop() khong chay tren CONTROL_TASK_CORE - kiem tra CONFIG_ARDUINO_RUNNING_CORE"
+#endif
 
-DHT dht(DHT_PIN, DHT_TYPE);
+// ==================== OBJECTS ====================
+// Thiết bị ngoại vi qua lớp HAL (hal.h): ESP32 thật hoặc bản giả trên máy tính.
+// Sơ đồ chân: board.h. Keypad, UART vân tay, WiFi đi qua lớp ghi đầu vào (input_trace.h).
+// Lệnh vân tay: hàng lệnh không chặn as608.h, kết quả về qua callback
+HalDisplay& lcd = halDisplay();
+HalKeypad& keypad = traceKeypad(halKeypad());
+HalFingerPort& fingerPort = traceFingerPort(halFingerPort());
+HalNetwork& network = traceNetwork(halNetwork());
+HalConsole& console = halConsole();
 
 // ==================== SYSTEM VARIABLES ====================
-// Mật khẩu hiện tại
-String adminPassword = DEFAULT_ADMIN_PASSWORD;
-String userPassword = DEFAULT_USER_PASSWORD;
-String inputPassword = "";
+// Chỉ loop() (core 1) dùng các biến dưới đây; task khác gửi dữ liệu qua ring
+// Mật khẩu hiện tại (chuỗi chữ số, tối đa PASSWORD_MAX_LEN)
+char adminPassword[PASSWORD_MAX_LEN + 1] = DEFAULT_ADMIN_PASSWORD;
+char userPassword[PASSWORD_MAX_LEN + 1] = DEFAULT_USER_PASSWORD;
+char inputPassword[PASSWORD_MAX_LEN + 1] = "";
 
 // Trạng thái hệ thống
-bool highSecurityMode = false;      // Chế độ bảo mật cao (2FA)
+bool highSecurityMode = false;      // Chế độ bảo mật cao (2FA), chỉ đổi qua ACT_MODE
 bool doorUnlocked = false;          // Trạng thái cửa
-bool systemLocked = false;          // Hệ thống bị khóa do nhập sai
-bool overheated = false;            // Trạng thái quá nhiệt
-bool guestDetected = false;         // Phát hiện có khách
+bool overheated = false;            // Nhiệt độ vượt ngưỡng (có trễ 5°C), máy trạng thái đọc
 
-// Xác thực 2FA
-bool passwordVerified = false;      // Đã xác thực mật khẩu (cho 2FA)
-bool fingerprintVerified = false;   // Đã xác thực vân tay (cho 2FA)
+// Xác thực / màn hình: 1 trạng thái duy nhất (auth_fsm.h), chỉ authDispatch() đổi
+AuthState authState = AUTH_IDLE;
+LogUser authUser = LOG_USER_UNKNOWN;  // Mật khẩu vừa đúng là Admin hay User
+uint16_t authFingerId = 0;          // ID vân tay vừa khớp
 
 // Đếm số lần sai
 int wrongAttempts = 0;              // Số lần nhập mật khẩu sai
 int wrongFingerprintAttempts = 0;   // Số lần quét vân tay sai
-bool fingerprintLocked = false;     // Vân tay bị khóa sau 3 lần sai
 
-// Thời gian
-unsigned long lockoutStartTime = 0;
-unsigned long doorOpenStartTime = 0;
-unsigned long soundLightStartTime = 0;
-unsigned long lastSensorReadTime = 0;
-unsigned long lastDisplayUpdateTime = 0;
-unsigned long twoFactorStartTime = 0;
+// Màn hình
+bool displayDue = true;             // Cần vẽ lại (định kỳ hoặc vừa đổi nội dung)
+bool messageActive = false;         // Đang hiện thông báo tạm thời
 
-// Dữ liệu cảm biến
+// Dữ liệu cảm biến (bản sao từ task cảm biến, cập nhật trong readSensors())
 float temperature = 0;
 float humidity = 0;
 int lightLevel = 0;
 bool isDark = false;
 bool soundLightOn = false;
 bool fanRunning = false;         // Trạng thái quạt
+bool soundHeard = false;         // Task cảm biến báo có âm thanh, chờ handleAutomation()
 
-// Trạng thái hiển thị
-enum DisplayState {
-  DISPLAY_WELCOME,
-  DISPLAY_ENTER_PASSWORD,
-  DISPLAY_SCAN_FINGER,
-  DISPLAY_2FA_PASSWORD,
-  DISPLAY_2FA_FINGER,
-  DISPLAY_ACCESS_GRANTED,
-  DISPLAY_ACCESS_DENIED,
-  DISPLAY_SYSTEM_LOCKED,
-  DISPLAY_OVERHEAT_WARNING,
-  DISPLAY_GUEST_DETECTED,
-  DISPLAY_SENSOR_INFO
+// Luồng giao diện nhiều bước (menu Admin, đổi mật khẩu, đăng ký vân tay).
+// Mỗi bước chỉ xử lý phím / kiểm tra timeout rồi trả về ngay, loop() vẫn
+// chạy đọc cảm biến, chống quá nhiệt, tự khóa cửa trong lúc chờ
+enum UiFlow {
+  UI_NONE,
+  UI_PWD_CHOOSE,            // Đổi mật khẩu: chọn Admin/User
+  UI_PWD_ENTER,             // Đổi mật khẩu: nhập mật khẩu mới
+  UI_ADMIN_MENU,
+  UI_ADMIN_ENROLL_ID,       // Nhập ID để đăng ký vân tay
+  UI_ADMIN_DELETE_ID,       // Nhập ID để xóa vân tay
+  UI_ADMIN_ENROLL_USED,     // ID đã có vân tay: xác nhận ghi đè
+  UI_ADMIN_DELETE_ALL,      // Xác nhận xóa tất cả
+  UI_ENROLL_FIRST,          // Đăng ký: chờ quét lần 1
+  UI_ENROLL_REMOVE,         // Đăng ký: chờ nhấc ngón tay
+  UI_ENROLL_SECOND          // Đăng ký: chờ quét lần 2
 };
-DisplayState currentDisplay = DISPLAY_WELCOME;
+UiFlow uiFlow = UI_NONE;
+UiFlow authMenuFlow = UI_NONE;      // Luồng ACT_MENU sẽ mở (phím * hoặc D)
+unsigned long uiFlowStartTime = 0;
+unsigned long uiPollTime = 0;       // Lần hỏi cảm biến vân tay gần nhất
+bool uiDrawPending = false;         // Cần vẽ màn hình của bước hiện tại
+bool pwdChangingAdmin = false;
+char newPassword[PASSWORD_MAX_LEN + 1] = "";
+char uiIdBuf[4];                    // ID vân tay đang nhập (tối đa 3 chữ số)
+uint8_t uiIdLen = 0;
+uint8_t enrollId = 0;
+
+// Đo thời gian vòng loop()
+unsigned long loopMaxUs = 0;
+unsigned long loopOverBudget = 0;
+unsigned long lastLoopWarnTime = 0;
 
 // ==================== FUNCTION PROTOTYPES ====================
 void initSystem();
@@ -213,33 +217,80 @@ void unlockDoor();
 void lockDoor();
 void resetAuthentication();
 void switchSecurityMode();
+void authDispatch(AuthEvent event);
+void authRun(AuthAction action);
 void showMessage(const char* line1, const char* line2, int delayMs = 2000);
+void cancelMessage();
+bool passwordAppend(char* password, char key);
+bool fingerGetImage(As608Callback done);
+void setOutput(uint8_t pin, uint8_t level);
+unsigned lcdCap(uint32_t value, unsigned maxValue);
+void handleSerialCommands();
+void checkLoopBudget(unsigned long elapsedUs);
+
+// Luồng nhiều bước (menu Admin, đổi mật khẩu, đăng ký vân tay)
+void uiEnter(UiFlow flow);
+void uiReset();
+void uiExit();
+void handleUiFlowKey(char key);
+void handleUiFlow();
+void enrollFinish();
 
 // Admin functions
 void adminMenu();
-bool enrollFingerprint(uint8_t id);
-bool deleteFingerprint(uint8_t id);
+void enrollFingerprint(uint8_t id);
+void deleteFingerprint(uint8_t id);
 void deleteAllFingerprints();
 void showFingerprintCount();
+void showStoredCount(uint16_t count);
+
+// Kết quả lệnh vân tay (as608.h), chạy trong as608Service()
+void onFingerBeginCount(const As608Result& r);
+void onFingerImage(const As608Result& r);
+void onAuthImage(const As608Result& r);
+void onAuthTz(const As608Result& r);
+void onAuthSearch(const As608Result& r);
+void fingerVerdict(FingerVerdict verdict);
+void onEnrollImage(const As608Result& r);
+void onEnrollTz(const As608Result& r);
+void onEnrollLifted(const As608Result& r);
+void onEnrollModel(const As608Result& r);
+void onEnrollStored(const As608Result& r);
+void onFingerDeleted(const As608Result& r);
+void onFingersEmptied(const As608Result& r);
+void onFingerCount(const As608Result& r);
 
 // WiFi & Google Sheets functions
 void connectWiFi();
-void sendToGoogleSheets(String event, String method, String user, String status);
+void sendToGoogleSheets(LogEventType event, LogMethod method, LogUser user,
+                        LogStatus status, uint16_t fingerId = 0);
+
+// ==================== TIMERS ====================
+// Hạn chót của loop() (timer_wheel.h): callback chạy trong timerService()
+void onAuthTimeout();
+void onSoundLightEnd();
+void onDisplayRefresh();
+
+Timer doorTimer(lockDoor);              // Tự khóa cửa sau DOOR_OPEN_TIME
+Timer authTimer(onAuthTimeout);         // Hết giờ khóa / chờ lớp 2FA (authStateInfo)
+Timer soundLightTimer(onSoundLightEnd); // Tắt đèn báo khách
+Timer displayTimer(onDisplayRefresh);   // Vẽ lại màn hình mỗi 500 ms
+Timer messageTimer(cancelMessage);      // Hết thông báo tạm thời
 
 // ==================== INITIALIZATION ====================
 void initSystem() {
-  Serial.begin(115200);
-  Serial.println("\n");
-  Serial.println("╔════════════════════════════════════════════════════════╗");
-  Serial.println("║   HỆ THỐNG AN NINH ĐA LỚP ESP32                        ║");
-  Serial.println("║   Multi-Layer Security System                          ║");
-  Serial.println("╚════════════════════════════════════════════════════════╝");
-  Serial.println();
+  timerBegin(halMillis());
+  powerBegin(halMillis());
+  console.begin(115200);
+  console.println("\n");
+  console.println("╔════════════════════════════════════════════════════════╗");
+  console.println("║   HỆ THỐNG AN NINH ĐA LỚP ESP32                        ║");
+  console.println("║   Multi-Layer Security System                          ║");
+  console.println("╚════════════════════════════════════════════════════════╝");
+  console.println();
   
   // Khởi tạo I2C và LCD
-  Wire.begin(LCD_SDA, LCD_SCL);
-  lcd.init();
-  lcd.backlight();
+  lcd.begin();
   lcd.clear();
   lcd.setCursor(0, 0);
   lcd.print("Security System");
@@ -247,398 +298,270 @@ void initSystem() {
   lcd.print("Initializing...");
   
   // Khởi tạo GPIO
-  pinMode(RELAY_PIN, OUTPUT);
-  pinMode(LED_PIN, OUTPUT);
-  pinMode(DOOR_LED_PIN, OUTPUT);
-  pinMode(SOUND_LED_PIN, OUTPUT);
-  pinMode(FAN_PIN, OUTPUT);
-  pinMode(LDR_DIGITAL, INPUT);
-  pinMode(SOUND_PIN, INPUT);
+  halPinMode(RELAY_PIN, OUTPUT);
+  halPinMode(LED_PIN, OUTPUT);
+  halPinMode(DOOR_LED_PIN, OUTPUT);
+  halPinMode(SOUND_LED_PIN, OUTPUT);
+  halPinMode(FAN_PIN, OUTPUT);
+  halPinMode(LDR_DIGITAL, INPUT);
   
   // Đảm bảo cửa khóa, đèn tắt, quạt tắt
-  digitalWrite(RELAY_PIN, LOW);
-  digitalWrite(LED_PIN, LOW);
-  digitalWrite(DOOR_LED_PIN, LOW);
-  digitalWrite(SOUND_LED_PIN, LOW);
-  digitalWrite(FAN_PIN, LOW);
+  setOutput(RELAY_PIN, LOW);
+  setOutput(LED_PIN, LOW);
+  setOutput(DOOR_LED_PIN, LOW);
+  setOutput(SOUND_LED_PIN, LOW);
+  setOutput(FAN_PIN, LOW);
   
-  // Khởi tạo DHT11
-  dht.begin();
+  // Task đọc DHT11 / LDR / âm thanh trên core 0 (gửi số liệu qua ring)
+  sensorsBegin(halClimate(), LDR_ANALOG, SOUND_PIN);
   
   // Kết nối WiFi
   connectWiFi();
   
-  // Khởi tạo cảm biến vân tay
-  fingerSerial.begin(57600, SERIAL_8N1, FINGER_RX, FINGER_TX);
-  delay(100);
+  // Mã lần khởi động + đồng bộ giờ SNTP chạy nền (đóng dấu sự kiện)
+  halEventClockBegin();
   
-  if (finger.verifyPassword()) {
-    Serial.println("✓ Cảm biến vân tay: OK");
-    finger.getTemplateCount();
-    Serial.print("  Số vân tay đã lưu: ");
-    Serial.println(finger.templateCount);
+  // Nhật ký offline trên phân vùng spiffs (giữ log khi mất WiFi)
+  halJournalBegin();
+  
+  // Khởi động task gửi log (chạy nền, không chặn mở cửa)
+  halUplinkBegin(GOOGLE_SCRIPT_URL);
+  
+  // Gộp chuỗi lỗi giống nhau (sai PIN/vân tay liên tục) trước khi gửi
+  logAggregateBegin(uplinkLog);
+  
+  // Khởi tạo cảm biến vân tay: dò / nâng tốc độ UART (as608_link.h)
+  as608Begin(fingerPort, FINGER_BAUD);
+  if (as608LinkBegin()) {
+    console.println("✓ Cảm biến vân tay: OK");
+    fingerSlotsLoad(as608LinkCapacity(), onFingerBeginCount);
   } else {
-    Serial.println("✗ Cảm biến vân tay: Không tìm thấy!");
+    console.println("✗ Cảm biến vân tay: Không tìm thấy!");
+  }
+  
+  // Ngắt chạm: chỉ hỏi cảm biến qua UART khi có ngón tay
+  fingerTouchBegin(FINGER_TOUCH_PIN, FINGER_TOUCH_ACTIVE);
+  if (fingerTouchEnabled()) {
+    console.printf("  Chân chạm WAK: GPIO %d\n", FINGER_TOUCH_PIN);
   }
   
-  delay(1000);
+  halDelay(1000);
   
   // Hiển thị hướng dẫn
-  Serial.println("\n╔═══════════════ HƯỚNG DẪN SỬ DỤNG ═══════════════╗");
-  Serial.println("║ Phím A: Chuyển chế độ Thường/Bảo mật cao (2FA)  ║");
-  Serial.println("║ Phím B: Xem thông tin cảm biến                  ║");
-  Serial.println("║ Phím C: Xóa mật khẩu đang nhập                  ║");
-  Serial.println("║ Phím D: Đổi mật khẩu (nhập MK cũ trước)         ║");
-  Serial.println("║ Phím #: Xác nhận mật khẩu                       ║");
-  Serial.println("║ Phím *: Quay lại / VÀO ADMIN (sau khi nhập MK)  ║");
-  Serial.println("║ 0-9  : Nhập mật khẩu                            ║");
-  Serial.println("╠═══════════════════════════════════════════════════╣");
-  Serial.println("║ ADMIN MENU (nhập đúng MK + nhấn *):              ║");
-  Serial.println("║   1: Thêm vân tay | 2: Xóa vân tay               ║");
-  Serial.println("║   3: Xóa tất cả   | 4: Xem số vân tay đã lưu     ║");
-  Serial.println("╚═════════════════════════════════════════════════╝");
-  Serial.println("\n╔═══════════════ MẬT KHẨU MẶC ĐỊNH ════════════════╗");
-  Serial.println("║ Admin: " + String(DEFAULT_ADMIN_PASSWORD) + " (mở cửa + vào Admin Menu)       ║");
-  Serial.println("║ User:  " + String(DEFAULT_USER_PASSWORD) + " (chỉ mở cửa)                    ║");
-  Serial.println("╚═════════════════════════════════════════════════════╝");
-  Serial.println("Chế độ hiện tại: THƯỜNG (Vân tay HOẶC Mật khẩu)\n");
-  
-  currentDisplay = DISPLAY_WELCOME;
+  console.println("\n╔═══════════════ HƯỚNG DẪN SỬ DỤNG ═══════════════╗");
+  console.println("║ Phím A: Chuyển chế độ Thường/Bảo mật cao (2FA)  ║");
+  console.println("║ Phím B: Xem cảm biến (lần 2: trạng thái gửi log)║");
+  console.println("║ Phím C: Xóa mật khẩu đang nhập                  ║");
+  console.println("║ Phím D: Đổi mật khẩu (nhập MK cũ trước)         ║");
+  console.println("║ Phím #: Xác nhận mật khẩu                       ║");
+  console.println("║ Phím *: Quay lại / VÀO ADMIN (sau khi nhập MK)  ║");
+  console.println("║ 0-9  : Nhập mật khẩu                            ║");
+  console.println("╠═══════════════════════════════════════════════════╣");
+  console.println("║ ADMIN MENU (nhập đúng MK + nhấn *):              ║");
+  console.println("║   1: Thêm vân tay | 2: Xóa vân tay               ║");
+  console.println("║   3: Xóa tất cả   | 4: Xem số vân tay đã lưu     ║");
+  console.println("╠═══════════════════════════════════════════════════╣");
+  console.println("║ Lệnh Serial: stats (thống kê gửi log)            ║");
+  console.println("╚═════════════════════════════════════════════════╝");
+  console.println("\n╔═══════════════ MẬT KHẨU MẶC ĐỊNH ════════════════╗");
+  console.printf("║ Admin: %s (mở cửa + vào Admin Menu)       ║\n", DEFAULT_ADMIN_PASSWORD);
+  console.printf("║ User:  %s (chỉ mở cửa)                    ║\n", DEFAULT_USER_PASSWORD);
+  console.println("╚═════════════════════════════════════════════════════╝");
+  console.println("Chế độ hiện tại: THƯỜNG (Vân tay HOẶC Mật khẩu)");
+#if defined(ARDUINO)
+  console.printf("[Tasks] loop(): core %d | sensors: core %d | uplink: core %d\n",
+                 (int)xPortGetCoreID(), SENSOR_TASK_CORE, UPLINK_TASK_CORE);
+#endif
+  console.println();
+  
+  timerArm(displayTimer, halMillis(), 500);
 }
 
 // ==================== SENSOR READING ====================
+// Nhận số liệu từ task cảm biến (sensors.h), không đọc phần cứng ở đây
 void readSensors() {
-  if (millis() - lastSensorReadTime < 2000) return;
-  lastSensorReadTime = millis();
-  
-  // Đọc DHT11
-  float newTemp = dht.readTemperature();
-  float newHum = dht.readHumidity();
-  
-  if (!isnan(newTemp) && !isnan(newHum)) {
-    temperature = newTemp;
-    humidity = newHum;
+  SensorMsg msg;
+  while (traceSensorsReceive(msg)) {
+    if (msg.kind == SENSOR_SOUND) {
+      soundHeard = true;
+      continue;
+    }
+    
+    if (!isnan(msg.temperature) && !isnan(msg.humidity)) {
+      temperature = msg.temperature;
+      humidity = msg.humidity;
+    }
+    
+    lightLevel = msg.lightLevel;
+    isDark = (lightLevel > LDR_DARK_THRESHOLD);
+    
+    // In ra Serial (mỗi 2 giây)
+    console.printf("[Sensors] Temp: %.1f°C | Hum: %.0f%% | Light: %d (%s) | Fan: %s\n", 
+                  temperature, humidity, lightLevel, isDark ? "Tối" : "Sáng", fanRunning ? "ON" : "OFF");
   }
-  
-  // Đọc LDR
-  lightLevel = analogRead(LDR_ANALOG);
-  isDark = (lightLevel > LDR_DARK_THRESHOLD);
-  
-  // In ra Serial (mỗi 2 giây)
-  Serial.printf("[Sensors] Temp: %.1f°C | Hum: %.0f%% | Light: %d (%s) | Fan: %s\n", 
-                temperature, humidity, lightLevel, isDark ? "Tối" : "Sáng", fanRunning ? "ON" : "OFF");
 }
 
 // ==================== KEYPAD HANDLING ====================
+// Phím -> sự kiện cho máy trạng thái (auth_fsm.h); trạng thái quyết định phần còn lại
 void handleKeypad() {
   char key = keypad.getKey();
   if (!key) return;
   
-  Serial.print("[Keypad] Phím: ");
-  Serial.println(key);
+  console.print("[Keypad] Phím: ");
+  console.println(key);
   
-  // Nếu hệ thống bị khóa
-  if (systemLocked) {
-    if (millis() - lockoutStartTime >= LOCKOUT_TIME) {
-      systemLocked = false;
-      wrongAttempts = 0;
-      showMessage("System Unlocked", "Try again");
-      currentDisplay = DISPLAY_WELCOME;
-    } else {
-      int remainingSec = (LOCKOUT_TIME - (millis() - lockoutStartTime)) / 1000;
-      lcd.clear();
-      lcd.setCursor(0, 0);
-      lcd.print("System Locked!");
-      lcd.setCursor(0, 1);
-      lcd.print("Wait ");
-      lcd.print(remainingSec);
-      lcd.print(" sec");
-    }
-    return;
-  }
+  // Nhấn phím -> bỏ thông báo tạm thời đang hiện, có người: hỏi vân tay nhịp nhanh
+  cancelMessage();
+  fingerPollBoost(halMillis());
+  powerActivity(halMillis());
   
-  // Nếu đang quá nhiệt
-  if (overheated) {
-    showMessage("OVERHEAT!", "System disabled");
+  // Đang trong menu / luồng nhiều bước
+  if (uiFlow != UI_NONE) {
+    handleUiFlowKey(key);
     return;
   }
   
+  // Đang khóa / quá nhiệt: màn hình đã báo, bỏ qua phím
+  if (!authStateInfo(authState).keys) return;
+  
+  bool isAdmin = (strcmp(inputPassword, adminPassword) == 0);
+  bool isUser = !isAdmin && (strcmp(inputPassword, userPassword) == 0);
+  
   // Xử lý phím chức năng
   switch (key) {
     case 'A':  // Chuyển đổi chế độ bảo mật
-      switchSecurityMode();
+      authDispatch(EV_MODE);
       return;
       
-    case 'B':  // Hiển thị thông tin cảm biến
-      currentDisplay = DISPLAY_SENSOR_INFO;
+    case 'B':  // Hiển thị thông tin cảm biến, nhấn lần nữa -> trạng thái gửi log
+      authDispatch(EV_INFO);
       return;
       
     case 'C':  // Xóa mật khẩu đang nhập
-      inputPassword = "";
-      if (highSecurityMode && passwordVerified) {
-        currentDisplay = DISPLAY_2FA_FINGER;
-      } else if (highSecurityMode) {
-        currentDisplay = DISPLAY_2FA_PASSWORD;
-      } else {
-        currentDisplay = DISPLAY_ENTER_PASSWORD;
-      }
-      showMessage("Password cleared", "", 1000);
+      authDispatch(EV_CLEAR);
       return;
       
     case 'D':  // Đổi mật khẩu (chỉ Admin mới đổi được)
-      if (inputPassword == adminPassword) {
-        showMessage("Change which?", "1:Admin 2:User");
-        
-        // Chờ chọn loại mật khẩu
-        unsigned long waitStart = millis();
-        char choice = 0;
-        while (millis() - waitStart < 5000) {
-          choice = keypad.getKey();
-          if (choice == '1' || choice == '2') break;
-        }
-        
-        if (choice != '1' && choice != '2') {
-          showMessage("Timeout!", "");
-          inputPassword = "";
-          currentDisplay = DISPLAY_WELCOME;
-          return;
-        }
-        
-        bool changingAdmin = (choice == '1');
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print(changingAdmin ? "New ADMIN pass:" : "New USER pass:");
-        
-        String newPass = "";
-        unsigned long startTime = millis();
-        
-        while (millis() - startTime < 15000) {
-          char k = keypad.getKey();
-          if (k) {
-            if (k == '#') {
-              if (newPass.length() >= 4) {
-                if (changingAdmin) {
-                  adminPassword = newPass;
-                  Serial.println("[System] Mật khẩu ADMIN đã đổi thành: " + adminPassword);
-                } else {
-                  userPassword = newPass;
-                  Serial.println("[System] Mật khẩu USER đã đổi thành: " + userPassword);
-                }
-                showMessage("Password changed", "Success!");
-              } else {
-                showMessage("Too short!", "Min 4 digits");
-              }
-              break;
-            } else if (k == '*') {
-              showMessage("Cancelled", "");
-              break;
-            } else if (k >= '0' && k <= '9') {
-              newPass += k;
-              lcd.setCursor(0, 1);
-              for (unsigned int i = 0; i < newPass.length(); i++) lcd.print('*');
-              lcd.print("        ");
-            }
-          }
-        }
-        inputPassword = "";
-        currentDisplay = DISPLAY_WELCOME;
-      } else if (inputPassword == userPassword) {
+      if (isAdmin) {
+        // Chọn loại mật khẩu rồi nhập mật khẩu mới (xem handleUiFlowKey)
+        authMenuFlow = UI_PWD_CHOOSE;
+        authDispatch(EV_MENU);
+      } else if (isUser) {
         showMessage("No permission!", "Need Admin pass");
-        inputPassword = "";
+        inputPassword[0] = '\0';
       } else {
         showMessage("Enter Admin pass", "first, then D");
       }
       return;
       
     case '*':  // Quay lại màn hình chính HOẶC vào Admin Menu
-      if (inputPassword == adminPassword) {
+      if (isAdmin) {
         // Mật khẩu ADMIN đúng -> vào Admin Menu
-        Serial.println("[Admin] Vào Admin Menu với quyền ADMIN...");
-        inputPassword = "";
-        adminMenu();
-        currentDisplay = DISPLAY_WELCOME;
-      } else if (inputPassword == userPassword) {
+        console.println("[Admin] Vào Admin Menu với quyền ADMIN...");
+        authMenuFlow = UI_ADMIN_MENU;
+        authDispatch(EV_MENU);
+      } else if (isUser) {
         // Mật khẩu USER -> KHÔNG cho vào Admin
-        Serial.println("[Auth] Mật khẩu User không có quyền Admin!");
+        console.println("[Auth] Mật khẩu User không có quyền Admin!");
+        authDispatch(EV_HOME);
         showMessage("No Admin access", "User password!", 2000);
-        inputPassword = "";
-        currentDisplay = DISPLAY_WELCOME;
       } else {
-        // Quay lại màn hình chính
-        inputPassword = "";
-        resetAuthentication();
-        currentDisplay = DISPLAY_WELCOME;
-        guestDetected = false;
+        authDispatch(EV_HOME);
       }
       return;
       
     case '#':  // Xác nhận mật khẩu
-      if (inputPassword.length() > 0) {
-        // Kiểm tra mật khẩu Admin hoặc User
-        bool isAdmin = (inputPassword == adminPassword);
-        bool isUser = (inputPassword == userPassword);
-        
-        if (isAdmin || isUser) {
-          Serial.printf("[Auth] ✓ Mật khẩu %s đúng!\n", isAdmin ? "ADMIN" : "USER");
-          
-          // Nếu vân tay bị khóa -> mở cửa bằng mật khẩu
-          if (fingerprintLocked) {
-            fingerprintLocked = false;
-            wrongFingerprintAttempts = 0;
-            wrongAttempts = 0;
-            Serial.println("[Auth] ✓ Vân tay bị khóa - Mở cửa bằng mật khẩu!");
-            sendToGoogleSheets("DOOR_OPEN", "PASSWORD", isAdmin ? "ADMIN" : "USER", "SUCCESS_AFTER_FINGER_LOCK");
-            unlockDoor();  // Mở cửa (đèn sáng)
-          } else if (highSecurityMode) {
-            // Chế độ 2FA: cần thêm vân tay
-            passwordVerified = true;
-            twoFactorStartTime = millis();
-            showMessage("Password OK!", "Scan finger...");
-            currentDisplay = DISPLAY_2FA_FINGER;
-          } else {
-            // Chế độ thường: mở cửa ngay
-            wrongAttempts = 0;
-            sendToGoogleSheets("DOOR_OPEN", "PASSWORD", isAdmin ? "ADMIN" : "USER", "SUCCESS");
-            unlockDoor();
-          }
-        } else {
-          // Mật khẩu sai (không phải Admin cũng không phải User)
-          Serial.println("[Auth] ✗ Mật khẩu sai!");
-          wrongAttempts++;
-          
-          // Gửi log thất bại
-          sendToGoogleSheets("DOOR_OPEN", "PASSWORD", "Unknown", "FAILED");
-          
-          if (wrongAttempts >= MAX_WRONG_ATTEMPTS) {
-            systemLocked = true;
-            lockoutStartTime = millis();
-            showMessage("3 wrong tries!", "Locked 30 sec");
-            currentDisplay = DISPLAY_SYSTEM_LOCKED;
-            Serial.println("[Security] !!! HỆ THỐNG BỊ KHÓA 30 GIÂY !!!");
-            sendToGoogleSheets("SYSTEM_LOCKED", "PASSWORD", "Unknown", "LOCKED_3_ATTEMPTS");
-          } else {
-            lcd.clear();
-            lcd.setCursor(0, 0);
-            lcd.print("Wrong password!");
-            lcd.setCursor(0, 1);
-            lcd.print("Attempts: ");
-            lcd.print(wrongAttempts);
-            lcd.print("/3");
-            delay(2000);
-            currentDisplay = highSecurityMode ? DISPLAY_2FA_PASSWORD : DISPLAY_ENTER_PASSWORD;
-          }
-        }
-        inputPassword = "";
+      if (inputPassword[0] == '\0') return;
+      if (isAdmin || isUser) {
+        console.printf("[Auth] ✓ Mật khẩu %s đúng!\n", isAdmin ? "ADMIN" : "USER");
+        authUser = isAdmin ? LOG_USER_ADMIN : LOG_USER_USER;
+        authDispatch(highSecurityMode ? EV_PASSWORD_OK_2FA : EV_PASSWORD_OK);
+      } else {
+        console.println("[Auth] ✗ Mật khẩu sai!");
+        authDispatch(EV_PASSWORD_BAD);
       }
+      inputPassword[0] = '\0';
       return;
       
     default:  // Phím số 0-9
-      if (key >= '0' && key <= '9') {
-        if (currentDisplay == DISPLAY_WELCOME || currentDisplay == DISPLAY_SENSOR_INFO) {
-          currentDisplay = highSecurityMode ? DISPLAY_2FA_PASSWORD : DISPLAY_ENTER_PASSWORD;
-        }
-        
-        if (inputPassword.length() < 10) {
-          inputPassword += key;
-          
-          // Hiển thị dấu *
-          lcd.setCursor(0, 1);
-          lcd.print("Pass: ");
-          for (unsigned int i = 0; i < inputPassword.length(); i++) {
-            lcd.print('*');
-          }
-          lcd.print("      ");
-        }
+      if (key >= '0' && key <= '9' && passwordAppend(inputPassword, key)) {
+        authDispatch(EV_DIGIT);
+        displayDue = true;  // Hiện thêm dấu * ngay
       }
       return;
   }
 }
 
 // ==================== FINGERPRINT HANDLING ====================
+void onFingerBeginCount(const As608Result& r) {
+  if (r.code != FINGERPRINT_OK) return;
+  console.print("  Số vân tay đã lưu: ");
+  console.println(r.score);
+}
+
+// Quét xác thực: getImage -> image2Tz -> tìm (finger_match.h), mỗi bước gửi từ callback của bước trước.
+// Mỗi lần chạm lấy tới vài mẫu trước khi kết luận (finger_consensus.h)
 void handleFingerprint() {
-  // Không xử lý nếu hệ thống bị khóa hoặc quá nhiệt
-  if (systemLocked || overheated) return;
+  // Khóa, vân tay bị khóa, quá nhiệt, menu: không hỏi cảm biến
+  if (!authStateInfo(authState).finger) {
+    fingerConsensusCancel();
+    return;
+  }
   
-  // Không xử lý nếu vân tay bị khóa (cần nhập mật khẩu)
-  if (fingerprintLocked) return;
+  // Lượt quét trước / lệnh của menu Admin chưa xong
+  if (as608Pending()) return;
   
-  // Kiểm tra timeout 2FA (30 giây)
-  if (highSecurityMode && (passwordVerified || fingerprintVerified)) {
-    if (millis() - twoFactorStartTime > 30000) {
-      showMessage("2FA Timeout!", "Try again");
-      resetAuthentication();
-      currentDisplay = DISPLAY_WELCOME;
-      Serial.println("[2FA] Timeout - đã hết thời gian xác thực");
+  uint32_t now = halMillis();
+  if (fingerConsensusActive()) {
+    // Đang lấy mẫu: hết thời gian -> kết luận, chưa -> mẫu kế tiếp
+    FingerVerdict verdict = fingerConsensusCheck(now);
+    if (verdict != FINGER_VERDICT_PENDING) {
+      fingerVerdict(verdict);
       return;
     }
+    if (!fingerConsensusDue(now)) return;
+  } else if (!fingerPollDue(now, authStateInfo(authState).fingerFast, isDark)) {
+    // Chưa tới nhịp hỏi (chân WAK / dấu hiệu có người, finger_poll.h)
+    return;
   }
   
-  // Đọc vân tay
-  int result = finger.getImage();
-  if (result != FINGERPRINT_OK) return;
-  
-  result = finger.image2Tz();
-  if (result != FINGERPRINT_OK) return;
-  
-  result = finger.fingerSearch();
-  
-  if (result == FINGERPRINT_OK) {
-    Serial.printf("[Auth] ✓ Vân tay khớp! ID: %d | Độ tin cậy: %d\n", 
-                  finger.fingerID, finger.confidence);
-    
-    // Reset số lần sai vân tay
-    wrongFingerprintAttempts = 0;
-    
-    if (highSecurityMode) {
-      if (passwordVerified) {
-        // 2FA hoàn tất - đã có mật khẩu, giờ có vân tay
-        fingerprintVerified = true;
-        wrongAttempts = 0;
-        Serial.println("[2FA] ✓ Xác thực 2 lớp hoàn tất!");
-        sendToGoogleSheets("DOOR_OPEN", "2FA", "Finger_ID_" + String(finger.fingerID), "SUCCESS");
-        unlockDoor();
-      } else {
-        // Chưa nhập mật khẩu - quét vân tay trước
-        fingerprintVerified = true;
-        twoFactorStartTime = millis();
-        showMessage("Finger OK!", "Enter password");
-        currentDisplay = DISPLAY_2FA_PASSWORD;
-        Serial.println("[2FA] Vân tay OK, chờ mật khẩu...");
-      }
-    } else {
-      // Chế độ thường: mở cửa ngay
-      wrongAttempts = 0;
-      sendToGoogleSheets("DOOR_OPEN", "FINGERPRINT", "Finger_ID_" + String(finger.fingerID), "SUCCESS");
-      unlockDoor();
-    }
-  } else if (result == FINGERPRINT_NOTFOUND) {
-    Serial.println("[Auth] ✗ Vân tay không khớp!");
-    
-    // Tăng số lần sai vân tay
-    wrongFingerprintAttempts++;
-    Serial.printf("[Auth] Số lần sai vân tay: %d/3\n", wrongFingerprintAttempts);
-    
-    // Gửi log thất bại
-    sendToGoogleSheets("DOOR_OPEN", "FINGERPRINT", "Unknown", "FAILED");
-    
-    // Khóa vân tay nếu sai quá 3 lần
-    if (wrongFingerprintAttempts >= 3) {
-      fingerprintLocked = true;
-      Serial.println("[Security] !!! VÂN TAY BỊ KHÓA - NHẬP MẬT KHẨU ĐỂ MỞ !!!");
-      sendToGoogleSheets("FINGER_LOCKED", "FINGERPRINT", "Unknown", "LOCKED_3_ATTEMPTS");
-      showMessage("Finger LOCKED!", "Enter password", 2000);
-      currentDisplay = DISPLAY_ENTER_PASSWORD;
-    } else {
-      // Hiển thị thông báo
-      lcd.clear();
-      lcd.setCursor(0, 0);
-      lcd.print("Wrong finger!");
-      lcd.setCursor(0, 1);
-      lcd.print("Attempts: ");
-      lcd.print(wrongFingerprintAttempts);
-      lcd.print("/3");
-      delay(1500);
-    }
+  fingerGetImage(onAuthImage);
+}
+
+void onAuthImage(const As608Result& r) {
+  if (r.code == FINGERPRINT_NOFINGER) fingerConsensusLifted();
+  if (r.code != FINGERPRINT_OK) return;
+  // Ngón tay vẫn đặt từ lần đã kết luận -> chờ nhấc tay
+  if (!fingerConsensusStart(r.doneMs)) return;
+  as608Submit(AS608_IMAGE2TZ, 1, onAuthTz);
+}
+
+void onAuthTz(const As608Result& r) {
+  if (r.code != FINGERPRINT_OK) return;
+  fingerMatch(onAuthSearch);
+}
+
+void onAuthSearch(const As608Result& r) {
+  // Trong lúc quét đã khóa / quá nhiệt / vào menu -> bỏ kết quả
+  if (!authStateInfo(authState).finger) return;
+  
+  FingerVerdict verdict = fingerConsensusSample(r, halMillis());
+  if (verdict == FINGER_VERDICT_PENDING && r.code == FINGERPRINT_NOTFOUND) {
+    console.printf("[Auth] Mẫu %u chưa khớp, quét lại...\n", fingerConsensusSamples());
+    showMessage("Scanning...", "Hold finger", 800);
+  }
+  fingerVerdict(verdict);
+}
+
+void fingerVerdict(FingerVerdict verdict) {
+  if (verdict == FINGER_VERDICT_ACCEPT) {
+    console.printf("[Auth] ✓ Vân tay khớp! ID: %d | Độ tin cậy: %d\n", fingerConsensusId(),
+                  fingerConsensusScore());
+    authFingerId = fingerConsensusId();
+    authDispatch(highSecurityMode ? EV_FINGER_OK_2FA : EV_FINGER_OK);
+  } else if (verdict == FINGER_VERDICT_REJECT) {
+    console.println("[Auth] ✗ Vân tay không khớp!");
+    authDispatch(EV_FINGER_BAD);
   }
 }
 
@@ -646,127 +569,114 @@ void handleFingerprint() {
 void handleAutomation() {
   // === Tự động bật đèn khi trời tối ===
   if (isDark && !soundLightOn && !overheated) {
-    digitalWrite(LED_PIN, HIGH);
+    setOutput(LED_PIN, HIGH);
   } else if (!isDark && !soundLightOn) {
-    digitalWrite(LED_PIN, LOW);
+    setOutput(LED_PIN, LOW);
   }
   
   // === Điều khiển quạt theo nhiệt độ ===
   if (temperature >= TEMP_FAN_THRESHOLD && !fanRunning && !overheated) {
     fanRunning = true;
-    digitalWrite(FAN_PIN, HIGH);
-    Serial.printf("[Auto] 🌀 Bật quạt làm mát (Nhiệt độ: %.1f°C >= %.1f°C)\n", 
+    setOutput(FAN_PIN, HIGH);
+    console.printf("[Auto] 🌀 Bật quạt làm mát (Nhiệt độ: %.1f°C >= %.1f°C)\n", 
                   temperature, TEMP_FAN_THRESHOLD);
   } else if (temperature < (TEMP_FAN_THRESHOLD - 2) && fanRunning) {
     // Tắt quạt khi nhiệt độ giảm 2 độ dưới ngưỡng (tránh bật/tắt liên tục)
     fanRunning = false;
-    digitalWrite(FAN_PIN, LOW);
-    Serial.printf("[Auto] 🌀 Tắt quạt (Nhiệt độ: %.1f°C < %.1f°C)\n", 
+    setOutput(FAN_PIN, LOW);
+    console.printf("[Auto] 🌀 Tắt quạt (Nhiệt độ: %.1f°C < %.1f°C)\n", 
                   temperature, TEMP_FAN_THRESHOLD - 2);
   }
   
-  // === Phát hiện âm thanh ===
-  int soundDetected = digitalRead(SOUND_PIN);
-  
-  if (soundDetected == HIGH) {
-    Serial.println("[Auto] 🔔 Phát hiện âm thanh!");
+  // === Phát hiện âm thanh (task cảm biến lấy mẫu chân SOUND_PIN) ===
+  if (soundHeard) {
+    soundHeard = false;
+    console.println("[Auto] 🔔 Phát hiện âm thanh!");
     
     // Bật LED âm thanh
-    digitalWrite(SOUND_LED_PIN, HIGH);
+    setOutput(SOUND_LED_PIN, HIGH);
     
-    guestDetected = true;
     soundLightOn = true;
-    soundLightStartTime = millis();
+    fingerPollBoost(halMillis());
+    powerActivity(halMillis());
+    timerArm(soundLightTimer, halMillis(), SOUND_LIGHT_DURATION);
     
     // Bật thêm LED chính nếu trời tối
     if (isDark) {
-      digitalWrite(LED_PIN, HIGH);
+      setOutput(LED_PIN, HIGH);
     }
     
-    // Hiển thị thông báo có khách
-    if (currentDisplay == DISPLAY_WELCOME || currentDisplay == DISPLAY_SENSOR_INFO) {
-      currentDisplay = DISPLAY_GUEST_DETECTED;
-    }
+    // Hiển thị thông báo có khách (chỉ từ màn hình chính / thông tin)
+    authDispatch(EV_SOUND);
   }
+}
+
+// Tắt đèn sau SOUND_LIGHT_DURATION (soundLightTimer)
+void onSoundLightEnd() {
+  soundLightOn = false;
   
-  // Tắt đèn sau thời gian cài đặt
-  if (soundLightOn && (millis() - soundLightStartTime >= SOUND_LIGHT_DURATION)) {
-    soundLightOn = false;
-    
-    // Tắt LED âm thanh
-    digitalWrite(SOUND_LED_PIN, LOW);
-    
-    if (!isDark) {
-      digitalWrite(LED_PIN, LOW);
-    }
-    if (currentDisplay == DISPLAY_GUEST_DETECTED) {
-      guestDetected = false;
-      currentDisplay = DISPLAY_WELCOME;
-    }
+  // Tắt LED âm thanh
+  setOutput(SOUND_LED_PIN, LOW);
+  
+  if (!isDark) {
+    setOutput(LED_PIN, LOW);
   }
+  authDispatch(EV_GUEST_END);
 }
 
 // ==================== OVERHEAT PROTECTION ====================
 void handleOverheatProtection() {
   if (temperature >= TEMP_WARNING_THRESHOLD && !overheated) {
     overheated = true;
-    Serial.println("[Safety] 🔥 CẢNH BÁO: NHIỆT ĐỘ QUÁ CAO!");
-    Serial.println("[Safety] Ngắt tất cả thiết bị điện (trừ quạt)!");
+    console.println("[Safety] 🔥 CẢNH BÁO: NHIỆT ĐỘ QUÁ CAO!");
+    console.println("[Safety] Ngắt tất cả thiết bị điện (trừ quạt)!");
     
     // Ngắt Relay và LED, nhưng giữ quạt chạy để làm mát
-    digitalWrite(RELAY_PIN, LOW);
-    digitalWrite(LED_PIN, LOW);
+    setOutput(RELAY_PIN, LOW);
+    setOutput(LED_PIN, LOW);
     // Bật quạt để làm mát khi quá nhiệt
-    digitalWrite(FAN_PIN, HIGH);
+    setOutput(FAN_PIN, HIGH);
     fanRunning = true;
     doorUnlocked = false;
-    
-    currentDisplay = DISPLAY_OVERHEAT_WARNING;
+    timerCancel(doorTimer);
   }
   
   // Reset khi nhiệt độ giảm xuống dưới ngưỡng an toàn (40-5=35°C)
   if (overheated && temperature < (TEMP_WARNING_THRESHOLD - 5)) {
     overheated = false;
-    Serial.println("[Safety] ✓ Nhiệt độ đã an toàn, hệ thống hoạt động lại");
-    showMessage("Temp normal", "System resumed");
-    currentDisplay = DISPLAY_WELCOME;
   }
+  
+  // Gửi mỗi vòng: đang LOCKED sẽ chuyển sang OVERHEAT ngay khi hết khóa
+  authDispatch(overheated ? EV_OVERHEAT : EV_COOLED);
 }
 
 // ==================== DOOR CONTROL ====================
 void unlockDoor() {
-  Serial.println("[Door] 🔓 MỞ CỬA!");
+  console.println("[Door] 🔓 MỞ CỬA!");
   doorUnlocked = true;
-  doorOpenStartTime = millis();
+  timerArm(doorTimer, halMillis(), DOOR_OPEN_TIME);
   
   // Bật LED cửa
-  digitalWrite(DOOR_LED_PIN, HIGH);
+  setOutput(DOOR_LED_PIN, HIGH);
   
-  currentDisplay = DISPLAY_ACCESS_GRANTED;
-  
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("ACCESS GRANTED!");
-  lcd.setCursor(0, 1);
-  lcd.print("Door unlocked");
+  // Màn hình ACCESS GRANTED hiện ngay, không chờ thông báo cũ
+  cancelMessage();
 }
 
 void lockDoor() {
-  Serial.println("[Door] 🔒 KHÓA CỬA!");
+  console.println("[Door] 🔒 KHÓA CỬA!");
   doorUnlocked = false;
+  timerCancel(doorTimer);
   
   // Tắt LED cửa
-  digitalWrite(DOOR_LED_PIN, LOW);
+  setOutput(DOOR_LED_PIN, LOW);
   
-  resetAuthentication();
-  currentDisplay = DISPLAY_WELCOME;
+  authDispatch(EV_DOOR_LOCKED);
 }
 
 // ==================== AUTHENTICATION RESET ====================
 void resetAuthentication() {
-  passwordVerified = false;
-  fingerprintVerified = false;
-  inputPassword = "";
+  inputPassword[0] = '\0';
 }
 
 // ==================== SECURITY MODE SWITCH ====================
@@ -775,38 +685,200 @@ void switchSecurityMode() {
   resetAuthentication();
   
   if (highSecurityMode) {
-    Serial.println("[Mode] Chế độ: BẢO MẬT CAO (2FA) - Cần Vân tay VÀ Mật khẩu");
+    console.println("[Mode] Chế độ: BẢO MẬT CAO (2FA) - Cần Vân tay VÀ Mật khẩu");
   } else {
-    Serial.println("[Mode] Chế độ: THƯỜNG - Chỉ cần Vân tay HOẶC Mật khẩu");
+    console.println("[Mode] Chế độ: THƯỜNG - Chỉ cần Vân tay HOẶC Mật khẩu");
   }
   
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Security Mode:");
-  lcd.setCursor(0, 1);
-  if (highSecurityMode) {
-    lcd.print("HIGH (2FA)");
-  } else {
-    lcd.print("NORMAL");
+  showMessage("Security Mode:", highSecurityMode ? "HIGH (2FA)" : "NORMAL");
+}
+
+// ==================== AUTH STATE MACHINE ====================
+// Chuyển trạng thái theo bảng (auth_fsm.h) rồi làm hành động kèm theo.
+// Hành động có thể gửi tiếp sự kiện (sai lần thứ 3 -> khóa)
+void authDispatch(AuthEvent event) {
+  const AuthTransition& t = authTransition(authState, event);
+  if (t.next != authState) {
+    console.printf("[FSM] %s --%s--> %s\n", authStateName(authState), authEventName(event),
+                  authStateName(t.next));
+    authState = t.next;
+    uint32_t timeoutMs = authStateInfo(authState).timeoutMs;
+    if (timeoutMs > 0) {
+      timerArm(authTimer, halMillis(), timeoutMs);
+    } else {
+      timerCancel(authTimer);
+    }
+    if (!messageActive) lcd.clear();
+    displayDue = true;  // Vẽ màn hình mới ngay
+  }
+  authRun(t.action);
+}
+
+void authRun(AuthAction action) {
+  char attempts[17];
+  
+  switch (action) {
+    case ACT_RESET:
+      resetAuthentication();
+      break;
+      
+    case ACT_CLEAR:
+      resetAuthentication();
+      showMessage("Password cleared", "", 1000);
+      break;
+      
+    case ACT_MODE:
+      switchSecurityMode();
+      break;
+      
+    case ACT_MENU:
+      resetAuthentication();
+      if (authMenuFlow == UI_ADMIN_MENU) {
+        adminMenu();
+      } else {
+        uiEnter(authMenuFlow);
+      }
+      break;
+      
+    case ACT_UNLOCK_PASSWORD:
+      wrongAttempts = 0;
+      sendToGoogleSheets(LOG_DOOR_OPEN, LOG_BY_PASSWORD, authUser, LOG_SUCCESS);
+      unlockDoor();
+      break;
+      
+    case ACT_UNLOCK_FINGER:
+      wrongAttempts = 0;
+      wrongFingerprintAttempts = 0;
+      sendToGoogleSheets(LOG_DOOR_OPEN, LOG_BY_FINGERPRINT, LOG_USER_FINGER, LOG_SUCCESS, authFingerId);
+      unlockDoor();
+      break;
+      
+    case ACT_UNLOCK_2FA:
+      wrongAttempts = 0;
+      wrongFingerprintAttempts = 0;
+      console.println("[2FA] ✓ Xác thực 2 lớp hoàn tất!");
+      sendToGoogleSheets(LOG_DOOR_OPEN, LOG_BY_2FA, LOG_USER_FINGER, LOG_SUCCESS, authFingerId);
+      unlockDoor();
+      break;
+      
+    case ACT_UNLOCK_OVERRIDE:
+      wrongAttempts = 0;
+      wrongFingerprintAttempts = 0;
+      console.println("[Auth] ✓ Vân tay bị khóa - Mở cửa bằng mật khẩu!");
+      sendToGoogleSheets(LOG_DOOR_OPEN, LOG_BY_PASSWORD, authUser, LOG_SUCCESS_AFTER_FINGER_LOCK);
+      unlockDoor();
+      break;
+      
+    case ACT_2FA_PASSWORD:
+      showMessage("Password OK!", "Scan finger...");
+      break;
+      
+    case ACT_2FA_FINGER:
+      wrongFingerprintAttempts = 0;
+      showMessage("Finger OK!", "Enter password");
+      console.println("[2FA] Vân tay OK, chờ mật khẩu...");
+      break;
+      
+    case ACT_PASSWORD_BAD:
+      wrongAttempts++;
+      sendToGoogleSheets(LOG_DOOR_OPEN, LOG_BY_PASSWORD, LOG_USER_UNKNOWN, LOG_FAILED);
+      if (wrongAttempts >= MAX_WRONG_ATTEMPTS) {
+        authDispatch(EV_TOO_MANY_PASSWORDS);
+      } else {
+        snprintf(attempts, sizeof(attempts), "Attempts: %u/%u",
+                 lcdCap(wrongAttempts, MAX_WRONG_ATTEMPTS), MAX_WRONG_ATTEMPTS);
+        showMessage("Wrong password!", attempts);
+      }
+      break;
+      
+    case ACT_LOCKOUT:
+      showMessage("3 wrong tries!", "Locked 30 sec");
+      console.println("[Security] !!! HỆ THỐNG BỊ KHÓA 30 GIÂY !!!");
+      sendToGoogleSheets(LOG_SYSTEM_LOCKED, LOG_BY_PASSWORD, LOG_USER_UNKNOWN, LOG_LOCKED_3_ATTEMPTS);
+      break;
+      
+    case ACT_LOCKOUT_END:
+      wrongAttempts = 0;
+      showMessage("System Unlocked", "Try again");
+      break;
+      
+    case ACT_FINGER_BAD:
+      wrongFingerprintAttempts++;
+      console.printf("[Auth] Số lần sai vân tay: %d/3\n", wrongFingerprintAttempts);
+      sendToGoogleSheets(LOG_DOOR_OPEN, LOG_BY_FINGERPRINT, LOG_USER_UNKNOWN, LOG_FAILED);
+      if (wrongFingerprintAttempts >= MAX_WRONG_ATTEMPTS) {
+        authDispatch(EV_TOO_MANY_FINGERS);
+      } else {
+        snprintf(attempts, sizeof(attempts), "Attempts: %u/%u",
+                 lcdCap(wrongFingerprintAttempts, MAX_WRONG_ATTEMPTS), MAX_WRONG_ATTEMPTS);
+        showMessage("Wrong finger!", attempts, 1500);
+      }
+      break;
+      
+    case ACT_FINGER_LOCK:
+      console.println("[Security] !!! VÂN TAY BỊ KHÓA - NHẬP MẬT KHẨU ĐỂ MỞ !!!");
+      sendToGoogleSheets(LOG_FINGER_LOCKED, LOG_BY_FINGERPRINT, LOG_USER_UNKNOWN, LOG_LOCKED_3_ATTEMPTS);
+      showMessage("Finger LOCKED!", "Enter password", 2000);
+      break;
+      
+    case ACT_2FA_TIMEOUT:
+      resetAuthentication();
+      showMessage("2FA Timeout!", "Try again");
+      console.println("[2FA] Timeout - đã hết thời gian xác thực");
+      break;
+      
+    case ACT_SHUTDOWN:
+      // Thoát menu / đăng ký đang dở để hiện cảnh báo
+      if (uiFlow != UI_NONE) {
+        console.println("[Admin] Thoát menu do quá nhiệt");
+        uiReset();
+      }
+      resetAuthentication();
+      cancelMessage();
+      break;
+      
+    case ACT_RESUME:
+      console.println("[Safety] ✓ Nhiệt độ đã an toàn, hệ thống hoạt động lại");
+      showMessage("Temp normal", "System resumed");
+      break;
+      
+    case ACT_NONE:
+    case AUTH_ACTION_COUNT:
+      break;
   }
-  delay(2000);
-  currentDisplay = DISPLAY_WELCOME;
+}
+
+// Hết thời gian của trạng thái hiện tại (khóa, chờ lớp 2FA)
+void onAuthTimeout() {
+  authDispatch(EV_TIMEOUT);
 }
 
 // ==================== DISPLAY UPDATE ====================
+// Dòng 2: mật khẩu đang nhập dạng dấu *
+void drawPasswordRow() {
+  char line[17];
+  snprintf(line, sizeof(line), "Pass: %-10.*s", (int)strlen(inputPassword), "**********");
+  lcd.setCursor(0, 1);
+  lcd.print(line);
+}
+
+// Cập nhật màn hình định kỳ (số liệu cảm biến, đếm ngược)
+void onDisplayRefresh() {
+  displayDue = true;
+  timerArm(displayTimer, halMillis(), 500);
+}
+
+// Vẽ theo authState (cùng số liệu cảm biến / mật khẩu đang nhập)
 void updateDisplay() {
-  // Kiểm tra nếu cửa đang mở và hết thời gian
-  if (doorUnlocked && (millis() - doorOpenStartTime >= DOOR_OPEN_TIME)) {
-    lockDoor();
-    return;
-  }
+  // Đang hiện thông báo tạm thời / menu tự vẽ màn hình
+  if (messageActive) return;
+  if (authState == AUTH_MENU) return;
   
-  // Cập nhật màn hình định kỳ
-  if (millis() - lastDisplayUpdateTime < 500) return;
-  lastDisplayUpdateTime = millis();
+  if (!displayDue) return;
+  displayDue = false;
   
-  switch (currentDisplay) {
-    case DISPLAY_WELCOME:
+  switch (authState) {
+    case AUTH_IDLE:
       lcd.setCursor(0, 0);
       if (highSecurityMode) {
         lcd.print("[2FA] Welcome!  ");
@@ -821,64 +893,51 @@ void updateDisplay() {
       lcd.print("%  ");
       break;
       
-    case DISPLAY_ENTER_PASSWORD:
-      lcd.setCursor(0, 0);
-      lcd.print("Enter Password: ");
-      break;
-      
-    case DISPLAY_SCAN_FINGER:
+    case AUTH_ENTRY:
       lcd.setCursor(0, 0);
-      lcd.print("Scan your finger");
-      lcd.setCursor(0, 1);
-      lcd.print("or press key    ");
+      lcd.print(highSecurityMode ? "[2FA] Password: " : "Enter Password: ");
+      drawPasswordRow();
       break;
       
-    case DISPLAY_2FA_PASSWORD:
-      lcd.setCursor(0, 0);
-      if (fingerprintVerified) {
-        lcd.print("[2FA] Finger OK!");
-      } else {
-        lcd.print("[2FA] Password: ");
-      }
-      break;
-      
-    case DISPLAY_2FA_FINGER:
+    case AUTH_2FA_PASSWORD_OK:
       lcd.setCursor(0, 0);
       lcd.print("[2FA] Pass OK!  ");
       lcd.setCursor(0, 1);
       lcd.print("Scan finger now ");
       break;
       
-    case DISPLAY_ACCESS_GRANTED:
-      // Đã hiển thị trong unlockDoor()
+    case AUTH_2FA_FINGER_OK:
+      lcd.setCursor(0, 0);
+      lcd.print("[2FA] Finger OK!");
+      drawPasswordRow();
       break;
       
-    case DISPLAY_ACCESS_DENIED:
+    case AUTH_GRANTED:
       lcd.setCursor(0, 0);
-      lcd.print("ACCESS DENIED!  ");
+      lcd.print("ACCESS GRANTED! ");
       lcd.setCursor(0, 1);
-      lcd.print("Try again       ");
+      lcd.print("Door unlocked   ");
       break;
       
-    case DISPLAY_SYSTEM_LOCKED:
+    case AUTH_LOCKED:
       {
-        int remainingSec = (LOCKOUT_TIME - (millis() - lockoutStartTime)) / 1000;
-        if (remainingSec <= 0) {
-          systemLocked = false;
-          wrongAttempts = 0;
-          currentDisplay = DISPLAY_WELCOME;
-        } else {
-          lcd.setCursor(0, 0);
-          lcd.print("SYSTEM LOCKED!  ");
-          lcd.setCursor(0, 1);
-          lcd.print("Wait ");
-          lcd.print(remainingSec);
-          lcd.print(" seconds  ");
-        }
+        int remainingSec = (timerRemainingMs(authTimer, halMillis()) + 999) / 1000;
+        lcd.setCursor(0, 0);
+        lcd.print("SYSTEM LOCKED!  ");
+        lcd.setCursor(0, 1);
+        lcd.print("Wait ");
+        lcd.print(remainingSec);
+        lcd.print(" seconds  ");
       }
       break;
       
-    case DISPLAY_OVERHEAT_WARNING:
+    case AUTH_FINGER_LOCKED:
+      lcd.setCursor(0, 0);
+      lcd.print("Finger LOCKED!  ");
+      drawPasswordRow();
+      break;
+      
+    case AUTH_OVERHEAT:
       lcd.setCursor(0, 0);
       lcd.print("!! OVERHEAT !!  ");
       lcd.setCursor(0, 1);
@@ -887,14 +946,14 @@ void updateDisplay() {
       lcd.print("C     ");
       break;
       
-    case DISPLAY_GUEST_DETECTED:
+    case AUTH_GUEST:
       lcd.setCursor(0, 0);
       lcd.print("** CO KHACH! ** ");
       lcd.setCursor(0, 1);
       lcd.print("Sound detected  ");
       break;
       
-    case DISPLAY_SENSOR_INFO:
+    case AUTH_SENSOR_INFO:
       lcd.setCursor(0, 0);
       lcd.print("T:");
       lcd.print(temperature, 1);
@@ -908,349 +967,688 @@ void updateDisplay() {
       lcd.print(" F:");
       lcd.print(fanRunning ? "ON " : "OFF");
       break;
+      
+    case AUTH_UPLINK_STATS:
+      {
+        // Q: hàng đợi, J: nhật ký offline, X: bị bỏ, OK: đã gửi, p95: độ trễ.
+        // Số lớn hơn độ rộng ô thì hiện giá trị trần (lệnh "stats" in số đủ)
+        char line[17];
+        snprintf(line, sizeof(line), "Q%-2u J%-4u X%-4u", lcdCap(uplinkPending(), 99),
+                 lcdCap(journalCount(), 9999), lcdCap(uplinkDropped(), 9999));
+        lcd.setCursor(0, 0);
+        lcd.print(line);
+        
+        uint32_t p95 = metricsLatencyPercentile(95);
+        if (p95 == UINT32_MAX) {
+          snprintf(line, sizeof(line), "OK%-4u p95>32s  ", lcdCap(uplinkMetrics.delivered, 9999));
+        } else {
+          snprintf(line, sizeof(line), "OK%-4u p95:%-5u", lcdCap(uplinkMetrics.delivered, 9999),
+                   lcdCap(p95, 99999));
+        }
+        lcd.setCursor(0, 1);
+        lcd.print(line);
+      }
+      break;
+      
+    case AUTH_MENU:
+      // Luồng nhiều bước tự vẽ (drawUiFlow)
+    case AUTH_STATE_COUNT:
+      break;
+  }
+}
+
+// ==================== SERIAL COMMANDS ====================
+// Đọc không chặn từng ký tự, xử lý khi gặp Enter
+void handleSerialCommands() {
+  static char cmd[16];
+  static uint8_t len = 0;
+  
+  int ch;
+  while ((ch = console.read()) >= 0) {
+    char c = (char)ch;
+    if (c != '\n' && c != '\r') {
+      if (len < sizeof(cmd) - 1) cmd[len++] = c;
+      continue;
+    }
+    if (len == 0) continue;
+    cmd[len] = '\0';
+    len = 0;
+    powerActivity(halMillis());
+    
+    if (strcmp(cmd, "stats") == 0) {
+      metricsPrint(uplinkPending(), journalCount());
+      console.printf("[Sheets] Lỗi đã gộp (không gửi riêng): %u\n",
+                    (unsigned)logAggregateSuppressed());
+      console.printf("[Sensors] Số liệu bị bỏ (loop() đọc không kịp): %u\n",
+                    (unsigned)sensorsDropped());
+      console.printf("[Finger] Lệnh getImage: %u (%u/giờ, nhịp %s) | Lần chạm: %u%s\n",
+                    (unsigned)fingerPollCommands(),
+                    (unsigned)fingerPollCommandsPerHour(halMillis()),
+                    fingerPollModeName(fingerPollMode()), (unsigned)fingerTouchCount(),
+                    fingerTouchEnabled() ? "" : " (không nối chân WAK)");
+      console.printf("[Finger] Phát hiện chạm: %u | Trễ chạm -> phát hiện TB: %u ms%s\n",
+                    (unsigned)fingerPollDetects(), (unsigned)fingerPollLatencyAvgMs(),
+                    fingerTouchEnabled() ? "" : " (cận trên)");
+      console.printf("[Loop] Vòng lâu nhất: %lu us | Vượt %d ms: %lu lần\n",
+                    loopMaxUs, LOOP_BUDGET_MS, loopOverBudget);
+      console.printf("[Auth] Trạng thái: %s | Hẹn giờ đang chạy: %u\n", authStateName(authState),
+                    (unsigned)timerCount());
+      console.printf("[AS608] Lệnh: %u | Gửi lại: %u | Hết giờ: %u | Gói hỏng: %u | Lỗi: %u | "
+                    "Lâu nhất: %u ms\n",
+                    (unsigned)as608Commands(), (unsigned)as608Retries(),
+                    (unsigned)as608Timeouts(), (unsigned)as608BadFrames(),
+                    (unsigned)as608Failures(), (unsigned)as608LatencyMaxMs());
+      as608LinkPrint();
+      fingerMatchPrint();
+      fingerConsensusPrint();
+      fingerSlotsPrint();
+      powerPrint(halMillis());
+#if LOOP_PROFILE
+    } else if (strcmp(cmd, "prof") == 0) {
+      profilePrint();
+    } else if (strcmp(cmd, "prof reset") == 0) {
+      profileReset();
+      console.println("[Prof] Đã xóa số liệu");
+#endif
+#if INPUT_TRACE
+    } else if (strcmp(cmd, "trace") == 0) {
+      tracePrint();
+    } else if (strcmp(cmd, "trace live") == 0) {
+      traceSetLive(!traceLive());
+      console.printf("[Trace] In từng bản ghi: %s\n", traceLive() ? "BẬT" : "TẮT");
+#endif
+    } else {
+      console.print("[Serial] Lệnh không hợp lệ: ");
+      console.println(cmd);
+      console.print("[Serial] Lệnh: stats");
+      if (LOOP_PROFILE) console.print(", prof, prof reset");
+      if (INPUT_TRACE) console.print(", trace, trace live");
+      console.println();
+    }
   }
 }
 
 // ==================== HELPER FUNCTIONS ====================
+// Relay / LED / quạt: ghi chân ra và ghi lại hành động (input_trace.h)
+void setOutput(uint8_t pin, uint8_t level) {
+  halDigitalWrite(pin, level);
+  traceOutput(pin, level);
+}
+
+// Số in lên LCD: chặn trên để dòng snprintf luôn vừa 16 ô (không bị cắt)
+unsigned lcdCap(uint32_t value, unsigned maxValue) {
+  return value > maxValue ? maxValue : (unsigned)value;
+}
+
+// Thêm 1 chữ số vào mật khẩu đang nhập, false nếu đã đủ PASSWORD_MAX_LEN
+bool passwordAppend(char* password, char key) {
+  size_t len = strlen(password);
+  if (len >= PASSWORD_MAX_LEN) return false;
+  password[len] = key;
+  password[len + 1] = '\0';
+  return true;
+}
+
+// Chụp ảnh vân tay (1 lệnh UART, chạy nền). Kết quả được ghi nhận cho thống kê
+// nhịp hỏi (có ngón tay = có người) rồi chuyển cho done
+As608Callback fingerImageDone = nullptr;
+
+bool fingerGetImage(As608Callback done) {
+  if (!as608Submit(AS608_GET_IMAGE, 0, onFingerImage)) return false;
+  fingerImageDone = done;
+  return true;
+}
+
+void onFingerImage(const As608Result& r) {
+  fingerPollResult(r.sentMs, r.doneMs, r.code == FINGERPRINT_OK);
+  if (r.code == FINGERPRINT_OK) powerActivity(r.doneMs);
+  fingerImageDone(r);
+}
+
+// Hiện thông báo trong delayMs rồi tự quay lại màn hình hiện tại.
+// Không chặn: loop() vẫn chạy, nhấn phím bất kỳ để bỏ qua thông báo
 void showMessage(const char* line1, const char* line2, int delayMs) {
   lcd.clear();
   lcd.setCursor(0, 0);
   lcd.print(line1);
   lcd.setCursor(0, 1);
   lcd.print(line2);
-  if (delayMs > 0) {
-    delay(delayMs);
-  }
+  messageActive = delayMs > 0;
+  if (messageActive) timerArm(messageTimer, halMillis(), delayMs);
 }
 
-// ==================== ADMIN MENU ====================
-void adminMenu() {
+// Bỏ thông báo đang hiện (trước khi vẽ màn hình khác lên LCD, hoặc hết giờ)
+void cancelMessage() {
+  if (!messageActive) return;
+  messageActive = false;
+  timerCancel(messageTimer);
+  lcd.clear();
+  displayDue = true;  // Vẽ lại màn hình ngay
+  uiDrawPending = uiFlow != UI_NONE;
+}
+
+// ==================== UI FLOW (MENU NHIỀU BƯỚC) ====================
+void drawAdminMenu() {
   lcd.clear();
   lcd.setCursor(0, 0);
   lcd.print("=== ADMIN MENU ===");
   lcd.setCursor(0, 1);
   lcd.print("1Add 2Del 3All 4#");
-  
-  Serial.println("\n╔═══════════════ ADMIN MENU ═══════════════╗");
-  Serial.println("║ 1: Thêm vân tay mới                      ║");
-  Serial.println("║ 2: Xóa vân tay theo ID                   ║");
-  Serial.println("║ 3: Xóa TẤT CẢ vân tay                    ║");
-  Serial.println("║ 4: Xem số vân tay đã lưu                 ║");
-  Serial.println("║ *: Thoát Admin Menu                      ║");
-  Serial.println("╚══════════════════════════════════════════╝\n");
-  
-  while (true) {
-    char key = keypad.getKey();
-    if (!key) continue;
-    
-    switch (key) {
-      case '1': {
-        // Thêm vân tay mới
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Enter ID (1-127)");
-        lcd.setCursor(0, 1);
-        lcd.print("ID: ");
-        
-        Serial.println("[Admin] Nhập ID vân tay (1-127):");
-        
-        String idStr = "";
-        unsigned long startTime = millis();
-        
-        while (millis() - startTime < 10000) {
-          char k = keypad.getKey();
-          if (k) {
-            if (k == '#') {
-              int id = idStr.toInt();
-              if (id >= 1 && id <= 127) {
-                if (enrollFingerprint(id)) {
-                  showMessage("Enroll Success!", "ID saved", 2000);
-                }
-              } else {
-                showMessage("Invalid ID!", "Use 1-127", 2000);
-              }
-              break;
-            } else if (k == '*') {
-              break;
-            } else if (k >= '0' && k <= '9') {
-              idStr += k;
-              lcd.setCursor(4, 1);
-              lcd.print(idStr);
-              lcd.print("   ");
-            }
-          }
-        }
-        
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("=== ADMIN MENU ===");
-        lcd.setCursor(0, 1);
-        lcd.print("1Add 2Del 3All 4#");
-        break;
+}
+
+void drawIdPrompt(const char* title) {
+  lcd.clear();
+  lcd.setCursor(0, 0);
+  lcd.print(title);
+  lcd.setCursor(0, 1);
+  lcd.print("ID: ");
+}
+
+// Sau ô ID: ID đang nhập đã có vân tay chưa, ô trống -> ID trống đầu tiên
+// khi đăng ký (finger_slots.h, không hỏi cảm biến)
+void drawIdHint() {
+  char hint[11] = "";   // "next:" + uint16_t
+  int id = atoi(uiIdBuf);
+  if (!fingerSlotsReady()) {
+    // Chưa đọc được bảng chỉ mục: không gợi ý
+  } else if (uiIdLen == 0 && uiFlow == UI_ADMIN_ENROLL_ID) {
+    uint16_t free = fingerSlotsFirstFree(1, 127);
+    if (free) snprintf(hint, sizeof(hint), "next:%u", free);
+  } else if (id >= 1 && id <= 127) {
+    snprintf(hint, sizeof(hint), fingerSlotsUsed(id) ? "used" : "free");
+  }
+  char field[9];
+  snprintf(field, sizeof(field), "%-8.8s", hint);
+  lcd.setCursor(8, 1);
+  lcd.print(field);
+}
+
+// Vẽ màn hình của bước hiện tại (sau khi vào bước hoặc hết thông báo)
+void drawUiFlow() {
+  switch (uiFlow) {
+    case UI_PWD_CHOOSE:
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print("Change which?");
+      lcd.setCursor(0, 1);
+      lcd.print("1:Admin 2:User");
+      break;
+      
+    case UI_PWD_ENTER:
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print(pwdChangingAdmin ? "New ADMIN pass:" : "New USER pass:");
+      lcd.setCursor(0, 1);
+      for (unsigned int i = 0; i < strlen(newPassword); i++) lcd.print('*');
+      break;
+      
+    case UI_ADMIN_MENU:
+      drawAdminMenu();
+      break;
+      
+    case UI_ADMIN_ENROLL_ID:
+      drawIdPrompt("Enter ID (1-127)");
+      lcd.print(uiIdBuf);
+      drawIdHint();
+      break;
+      
+    case UI_ADMIN_DELETE_ID:
+      drawIdPrompt("Delete ID:");
+      lcd.print(uiIdBuf);
+      drawIdHint();
+      break;
+      
+    case UI_ADMIN_ENROLL_USED:
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print("ID ");
+      lcd.print(enrollId);
+      lcd.print(" in use!");
+      lcd.setCursor(0, 1);
+      lcd.print("#=Replace *=No");
+      break;
+      
+    case UI_ADMIN_DELETE_ALL:
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print("Delete ALL?");
+      lcd.setCursor(0, 1);
+      lcd.print("#=Yes *=No");
+      break;
+      
+    case UI_ENROLL_FIRST:
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print("Place finger...");
+      lcd.setCursor(0, 1);
+      lcd.print("(1st scan)");
+      break;
+      
+    case UI_ENROLL_REMOVE:
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print("Remove finger...");
+      break;
+      
+    case UI_ENROLL_SECOND:
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print("Place same");
+      lcd.setCursor(0, 1);
+      lcd.print("finger again...");
+      break;
+      
+    case UI_NONE:
+      break;
+  }
+}
+
+void uiEnter(UiFlow flow) {
+  uiFlow = flow;
+  uiFlowStartTime = halMillis();
+  uiPollTime = 0;
+  uiDrawPending = true;
+  uiIdLen = 0;
+  uiIdBuf[0] = '\0';
+  if (flow == UI_PWD_ENTER) newPassword[0] = '\0';
+}
+
+// Bỏ luồng đang dở, không đổi authState (quá nhiệt đã chuyển sang OVERHEAT)
+void uiReset() {
+  uiFlow = UI_NONE;
+  uiDrawPending = false;
+  inputPassword[0] = '\0';
+  newPassword[0] = '\0';
+}
+
+void uiExit() {
+  uiReset();
+  authDispatch(EV_MENU_DONE);
+}
+
+// Nhận 1 chữ số vào ô ID đang nhập
+void uiIdAppend(char key) {
+  if (uiIdLen >= sizeof(uiIdBuf) - 1) return;
+  uiIdBuf[uiIdLen++] = key;
+  uiIdBuf[uiIdLen] = '\0';
+  lcd.setCursor(4, 1);
+  lcd.print(uiIdBuf);
+  lcd.print("   ");
+  drawIdHint();
+}
+
+void handleUiFlowKey(char key) {
+  switch (uiFlow) {
+    case UI_PWD_CHOOSE:
+      if (key == '1' || key == '2') {
+        pwdChangingAdmin = (key == '1');
+        uiEnter(UI_PWD_ENTER);
       }
+      break;
       
-      case '2': {
-        // Xóa vân tay theo ID
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Delete ID:");
-        lcd.setCursor(0, 1);
-        lcd.print("ID: ");
-        
-        Serial.println("[Admin] Nhập ID vân tay cần xóa:");
-        
-        String idStr = "";
-        unsigned long startTime = millis();
-        
-        while (millis() - startTime < 10000) {
-          char k = keypad.getKey();
-          if (k) {
-            if (k == '#') {
-              int id = idStr.toInt();
-              if (id >= 1 && id <= 127) {
-                if (deleteFingerprint(id)) {
-                  showMessage("Deleted!", "", 2000);
-                } else {
-                  showMessage("Delete failed!", "", 2000);
-                }
-              } else {
-                showMessage("Invalid ID!", "", 2000);
-              }
-              break;
-            } else if (k == '*') {
-              break;
-            } else if (k >= '0' && k <= '9') {
-              idStr += k;
-              lcd.setCursor(4, 1);
-              lcd.print(idStr);
-              lcd.print("   ");
-            }
+    case UI_PWD_ENTER:
+      if (key == '#') {
+        if (strlen(newPassword) >= 4) {
+          if (pwdChangingAdmin) {
+            strcpy(adminPassword, newPassword);
+            console.printf("[System] Mật khẩu ADMIN đã đổi thành: %s\n", adminPassword);
+          } else {
+            strcpy(userPassword, newPassword);
+            console.printf("[System] Mật khẩu USER đã đổi thành: %s\n", userPassword);
           }
+          uiExit();
+          showMessage("Password changed", "Success!");
+        } else {
+          uiExit();
+          showMessage("Too short!", "Min 4 digits");
         }
-        
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("=== ADMIN MENU ===");
+      } else if (key == '*') {
+        uiExit();
+        showMessage("Cancelled", "");
+      } else if (key >= '0' && key <= '9' && passwordAppend(newPassword, key)) {
         lcd.setCursor(0, 1);
-        lcd.print("1Add 2Del 3All 4#");
-        break;
+        for (unsigned int i = 0; i < strlen(newPassword); i++) lcd.print('*');
+        lcd.print("        ");
       }
+      break;
       
-      case '3': {
-        // Xóa tất cả vân tay
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("Delete ALL?");
-        lcd.setCursor(0, 1);
-        lcd.print("#=Yes *=No");
-        
-        Serial.println("[Admin] Xóa TẤT CẢ vân tay? # = Có, * = Không");
-        
-        while (true) {
-          char k = keypad.getKey();
-          if (k == '#') {
-            deleteAllFingerprints();
-            showMessage("All deleted!", "", 2000);
-            break;
-          } else if (k == '*') {
-            showMessage("Cancelled", "", 1000);
-            break;
+    case UI_ADMIN_MENU:
+      switch (key) {
+        case '1':  // Thêm vân tay mới
+          if (fingerSlotsReady()) {
+            console.printf("[Admin] Nhập ID vân tay (1-127), ID trống đầu tiên: %u\n",
+                          fingerSlotsFirstFree(1, 127));
+          } else {
+            console.println("[Admin] Nhập ID vân tay (1-127):");
           }
+          uiEnter(UI_ADMIN_ENROLL_ID);
+          break;
+        case '2':  // Xóa vân tay theo ID
+          console.println("[Admin] Nhập ID vân tay cần xóa:");
+          uiEnter(UI_ADMIN_DELETE_ID);
+          break;
+        case '3':  // Xóa tất cả vân tay
+          console.println("[Admin] Xóa TẤT CẢ vân tay? # = Có, * = Không");
+          uiEnter(UI_ADMIN_DELETE_ALL);
+          break;
+        case '4':  // Xem số vân tay đã lưu
+          showFingerprintCount();  // Hết thông báo -> tự vẽ lại menu
+          break;
+        case '*':  // Thoát Admin Menu
+          console.println("[Admin] Thoát Admin Menu");
+          uiExit();
+          showMessage("Exit Admin", "", 1000);
+          break;
+      }
+      break;
+      
+    case UI_ADMIN_ENROLL_ID:
+    case UI_ADMIN_DELETE_ID:
+      if (key == '#') {
+        int id = atoi(uiIdBuf);
+        bool enrolling = (uiFlow == UI_ADMIN_ENROLL_ID);
+        uiEnter(UI_ADMIN_MENU);
+        if (id < 1 || id > 127) {
+          showMessage("Invalid ID!", enrolling ? "Use 1-127" : "", 2000);
+        } else if (enrolling && fingerSlotsReady() && fingerSlotsUsed(id)) {
+          // Đăng ký đè lên vân tay đã có -> hỏi lại
+          console.printf("[Admin] ⚠ ID %d đã có vân tay. Ghi đè? # = Có, * = Không\n", id);
+          enrollId = id;
+          uiEnter(UI_ADMIN_ENROLL_USED);
+        } else if (enrolling) {
+          enrollFingerprint(id);
+        } else if (fingerSlotsReady() && !fingerSlotsUsed(id)) {
+          console.printf("[Admin] ID %d chưa có vân tay\n", id);
+          showMessage("ID empty!", "", 2000);
+        } else {
+          deleteFingerprint(id);
         }
-        
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("=== ADMIN MENU ===");
-        lcd.setCursor(0, 1);
-        lcd.print("1Add 2Del 3All 4#");
-        break;
+      } else if (key == '*') {
+        uiEnter(UI_ADMIN_MENU);
+      } else if (key >= '0' && key <= '9') {
+        uiIdAppend(key);
       }
+      break;
       
-      case '4': {
-        // Xem số vân tay đã lưu
-        showFingerprintCount();
-        delay(3000);
-        
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("=== ADMIN MENU ===");
-        lcd.setCursor(0, 1);
-        lcd.print("1Add 2Del 3All 4#");
-        break;
+    case UI_ADMIN_ENROLL_USED:
+      if (key == '#') {
+        enrollFingerprint(enrollId);
+      } else if (key == '*') {
+        uiEnter(UI_ADMIN_MENU);
+        showMessage("Cancelled", "", 1000);
       }
+      break;
       
-      case '*':
-        // Thoát Admin Menu
-        Serial.println("[Admin] Thoát Admin Menu");
-        showMessage("Exit Admin", "", 1000);
-        return;
-    }
+    case UI_ADMIN_DELETE_ALL:
+      if (key == '#') {
+        uiEnter(UI_ADMIN_MENU);
+        deleteAllFingerprints();
+      } else if (key == '*') {
+        uiEnter(UI_ADMIN_MENU);
+        showMessage("Cancelled", "", 1000);
+      }
+      break;
+      
+    case UI_ENROLL_FIRST:
+    case UI_ENROLL_REMOVE:
+    case UI_ENROLL_SECOND:
+      if (key == '*') {
+        console.println("[Enroll] Đã hủy");
+        uiEnter(UI_ADMIN_MENU);
+        showMessage("Cancelled", "", 1000);
+      }
+      break;
+      
+    case UI_NONE:
+      break;
   }
 }
 
-// ==================== ENROLL FINGERPRINT ====================
-bool enrollFingerprint(uint8_t id) {
-  Serial.printf("[Enroll] Bắt đầu đăng ký vân tay ID: %d\n", id);
-  
-  // Bước 1: Quét lần 1
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Place finger...");
-  lcd.setCursor(0, 1);
-  lcd.print("(1st scan)");
-  
-  Serial.println("[Enroll] Đặt ngón tay lên cảm biến (lần 1)...");
-  
-  int p = -1;
-  unsigned long startTime = millis();
-  
-  while (p != FINGERPRINT_OK && millis() - startTime < 10000) {
-    p = finger.getImage();
-    if (p == FINGERPRINT_OK) {
-      Serial.println("[Enroll] ✓ Đã chụp ảnh lần 1");
-    }
-    delay(50);
-  }
-  
-  if (p != FINGERPRINT_OK) {
-    showMessage("Timeout!", "Try again", 2000);
-    return false;
-  }
-  
-  p = finger.image2Tz(1);
-  if (p != FINGERPRINT_OK) {
-    showMessage("Image error!", "", 2000);
-    return false;
-  }
-  
-  // Bước 2: Nhấc ngón tay
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Remove finger...");
-  Serial.println("[Enroll] Nhấc ngón tay ra...");
-  
-  delay(2000);
-  
-  // Chờ ngón tay được nhấc ra
-  while (finger.getImage() != FINGERPRINT_NOFINGER) {
-    delay(100);
-  }
-  
-  // Bước 3: Quét lần 2
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Place same");
-  lcd.setCursor(0, 1);
-  lcd.print("finger again...");
-  
-  Serial.println("[Enroll] Đặt CÙNG ngón tay lên lần nữa...");
-  
-  p = -1;
-  startTime = millis();
-  
-  while (p != FINGERPRINT_OK && millis() - startTime < 10000) {
-    p = finger.getImage();
-    if (p == FINGERPRINT_OK) {
-      Serial.println("[Enroll] ✓ Đã chụp ảnh lần 2");
-    }
-    delay(50);
+// Đăng ký thất bại -> báo lỗi rồi quay lại menu Admin
+void enrollFail(const char* line1, const char* line2) {
+  uiEnter(UI_ADMIN_MENU);
+  showMessage(line1, line2, 2000);
+}
+
+// Hỏi cảm biến 1 lần mỗi intervalMs (getImage mất vài chục ms qua UART)
+bool uiPollDue(unsigned long intervalMs) {
+  if (halMillis() - uiPollTime < intervalMs) return false;
+  uiPollTime = halMillis();
+  return true;
+}
+
+bool enrollScanning() {
+  return uiFlow == UI_ENROLL_FIRST || uiFlow == UI_ENROLL_SECOND;
+}
+
+// Bước chờ quét: hỏi cảm biến theo nhịp; chụp được -> image2Tz vào buffer
+// của lần quét (onEnrollImage), xong -> onEnrollTz chuyển bước
+void enrollCapture() {
+  // Đang chờ cảm biến (chụp / tạo model / lưu) -> chưa tính hết giờ
+  if (as608Pending()) return;
+  if (halMillis() - uiFlowStartTime >= 10000) {
+    enrollFail("Timeout!", "Try again");
+    return;
   }
-  
-  if (p != FINGERPRINT_OK) {
-    showMessage("Timeout!", "Try again", 2000);
-    return false;
+  if (!uiPollDue(50) || !fingerTouchWanted(halMillis())) return;
+  fingerGetImage(onEnrollImage);
+}
+
+void onEnrollImage(const As608Result& r) {
+  // Đã hủy / hết giờ trong lúc chụp -> bỏ
+  if (r.code != FINGERPRINT_OK || !enrollScanning()) return;
+  uint8_t slot = uiFlow == UI_ENROLL_SECOND ? 2 : 1;
+  console.printf("[Enroll] ✓ Đã chụp ảnh lần %d\n", slot);
+  as608Submit(AS608_IMAGE2TZ, slot, onEnrollTz);
+}
+
+void onEnrollTz(const As608Result& r) {
+  if (!enrollScanning()) return;
+  if (r.code != FINGERPRINT_OK) {
+    enrollFail("Image error!", "");
+    return;
   }
-  
-  p = finger.image2Tz(2);
-  if (p != FINGERPRINT_OK) {
-    showMessage("Image error!", "", 2000);
-    return false;
+  if (uiFlow == UI_ENROLL_FIRST) {
+    console.println("[Enroll] Nhấc ngón tay ra...");
+    uiEnter(UI_ENROLL_REMOVE);
+  } else {
+    enrollFinish();
   }
-  
-  // Bước 4: Tạo model
+}
+
+// Ngón tay đã nhấc khỏi cảm biến chưa (giữa 2 lần quét)
+void onEnrollLifted(const As608Result& r) {
+  if (uiFlow != UI_ENROLL_REMOVE || r.code != FINGERPRINT_NOFINGER) return;
+  console.println("[Enroll] Đặt CÙNG ngón tay lên lần nữa...");
+  uiEnter(UI_ENROLL_SECOND);
+}
+
+// Đủ 2 ảnh -> tạo model (onEnrollModel) rồi lưu vào enrollId (onEnrollStored)
+void enrollFinish() {
   lcd.clear();
   lcd.setCursor(0, 0);
   lcd.print("Creating model..");
   
-  Serial.println("[Enroll] Đang tạo model...");
-  
-  p = finger.createModel();
-  if (p != FINGERPRINT_OK) {
-    if (p == FINGERPRINT_ENROLLMISMATCH) {
-      showMessage("Fingers not", "match! Retry", 2000);
-      Serial.println("[Enroll] ✗ Hai lần quét không khớp!");
+  console.println("[Enroll] Đang tạo model...");
+  as608Submit(AS608_CREATE, 0, onEnrollModel);
+}
+
+void onEnrollModel(const As608Result& r) {
+  if (uiFlow != UI_ENROLL_SECOND) return;
+  if (r.code != FINGERPRINT_OK) {
+    if (r.code == FINGERPRINT_ENROLLMISMATCH) {
+      console.println("[Enroll] ✗ Hai lần quét không khớp!");
+      enrollFail("Fingers not", "match! Retry");
     } else {
-      showMessage("Model error!", "", 2000);
+      enrollFail("Model error!", "");
     }
-    return false;
+    return;
   }
   
-  // Bước 5: Lưu vào bộ nhớ
-  Serial.printf("[Enroll] Đang lưu vào ID %d...\n", id);
+  // Lưu vào bộ nhớ
+  console.printf("[Enroll] Đang lưu vào ID %d...\n", enrollId);
+  as608Submit(AS608_STORE, enrollId, onEnrollStored);
+}
+
+void onEnrollStored(const As608Result& r) {
+  fingerSlotsNote(r);
+  if (uiFlow != UI_ENROLL_SECOND) return;
+  if (r.code != FINGERPRINT_OK) {
+    console.println("[Enroll] ✗ Lưu thất bại!");
+    enrollFail("Store failed!", "");
+    return;
+  }
   
-  p = finger.storeModel(id);
-  if (p != FINGERPRINT_OK) {
-    showMessage("Store failed!", "", 2000);
-    Serial.println("[Enroll] ✗ Lưu thất bại!");
-    return false;
+  console.printf("[Enroll] ✓ Đăng ký thành công! ID: %d\n", r.arg);
+  uiEnter(UI_ADMIN_MENU);
+  showMessage("Enroll Success!", "ID saved", 2000);
+}
+
+// Gọi mỗi vòng loop(): vẽ màn hình, timeout và các bước chờ cảm biến
+void handleUiFlow() {
+  if (uiFlow == UI_NONE) return;
+  
+  // Đang hiện thông báo -> chờ hết rồi mới vẽ / hỏi cảm biến tiếp
+  if (messageActive) return;
+  if (uiDrawPending) {
+    uiDrawPending = false;
+    drawUiFlow();
   }
   
-  Serial.printf("[Enroll] ✓ Đăng ký thành công! ID: %d\n", id);
+  unsigned long elapsed = halMillis() - uiFlowStartTime;
   
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Success!");
-  lcd.setCursor(0, 1);
-  lcd.print("ID: ");
-  lcd.print(id);
+  switch (uiFlow) {
+    case UI_PWD_CHOOSE:
+      if (elapsed >= 5000) {
+        uiExit();
+        showMessage("Timeout!", "");
+      }
+      break;
+      
+    case UI_PWD_ENTER:
+      if (elapsed >= 15000) uiExit();
+      break;
+      
+    case UI_ADMIN_ENROLL_ID:
+    case UI_ADMIN_DELETE_ID:
+    case UI_ADMIN_ENROLL_USED:
+      if (elapsed >= 10000) uiEnter(UI_ADMIN_MENU);
+      break;
+      
+    case UI_ENROLL_FIRST:
+    case UI_ENROLL_SECOND:
+      enrollCapture();
+      break;
+      
+    case UI_ENROLL_REMOVE:
+      // Chờ 2 giây rồi đợi ngón tay được nhấc ra (onEnrollLifted)
+      if (elapsed >= 2000 && !as608Pending() && uiPollDue(100)) fingerGetImage(onEnrollLifted);
+      break;
+      
+    default:
+      break;
+  }
+}
+
+// ==================== ADMIN MENU ====================
+void adminMenu() {
+  console.println("\n╔═══════════════ ADMIN MENU ═══════════════╗");
+  console.println("║ 1: Thêm vân tay mới                      ║");
+  console.println("║ 2: Xóa vân tay theo ID                   ║");
+  console.println("║ 3: Xóa TẤT CẢ vân tay                    ║");
+  console.println("║ 4: Xem số vân tay đã lưu                 ║");
+  console.println("║ *: Thoát Admin Menu                      ║");
+  console.println("╚══════════════════════════════════════════╝\n");
+  
+  // Phím được xử lý trong handleUiFlowKey()
+  uiEnter(UI_ADMIN_MENU);
+}
+
+// ==================== ENROLL FINGERPRINT ====================
+// Bắt đầu đăng ký; các bước quét chạy trong handleUiFlow()
+void enrollFingerprint(uint8_t id) {
+  console.printf("[Enroll] Bắt đầu đăng ký vân tay ID: %d\n", id);
+  console.println("[Enroll] Đặt ngón tay lên cảm biến (lần 1)...");
   
-  return true;
+  enrollId = id;
+  uiEnter(UI_ENROLL_FIRST);
 }
 
 // ==================== DELETE FINGERPRINT ====================
-bool deleteFingerprint(uint8_t id) {
-  Serial.printf("[Admin] Xóa vân tay ID: %d\n", id);
-  
-  int p = finger.deleteModel(id);
-  
-  if (p == FINGERPRINT_OK) {
-    Serial.printf("[Admin] ✓ Đã xóa vân tay ID %d\n", id);
-    return true;
+// Kết quả hiện khi cảm biến trả lời (onFingerDeleted)
+void deleteFingerprint(uint8_t id) {
+  console.printf("[Admin] Xóa vân tay ID: %d\n", id);
+  as608Submit(AS608_DELETE, id, onFingerDeleted);
+}
+
+void onFingerDeleted(const As608Result& r) {
+  fingerSlotsNote(r);
+  if (r.code == FINGERPRINT_OK) {
+    console.printf("[Admin] ✓ Đã xóa vân tay ID %d\n", r.arg);
+    showMessage("Deleted!", "", 2000);
   } else {
-    Serial.printf("[Admin] ✗ Không thể xóa ID %d\n", id);
-    return false;
+    console.printf("[Admin] ✗ Không thể xóa ID %d\n", r.arg);
+    showMessage("Delete failed!", "", 2000);
   }
 }
 
 // ==================== DELETE ALL FINGERPRINTS ====================
 void deleteAllFingerprints() {
-  Serial.println("[Admin] Xóa TẤT CẢ vân tay...");
-  
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Deleting all...");
-  
-  int p = finger.emptyDatabase();
+  console.println("[Admin] Xóa TẤT CẢ vân tay...");
   
-  if (p == FINGERPRINT_OK) {
-    Serial.println("[Admin] ✓ Đã xóa tất cả vân tay!");
+  // Hiện tới khi cảm biến trả lời (onFingersEmptied thay bằng kết quả)
+  showMessage("Deleting all...", "", 3000);
+  as608Submit(AS608_EMPTY, 0, onFingersEmptied);
+}
+
+void onFingersEmptied(const As608Result& r) {
+  fingerSlotsNote(r);
+  if (r.code == FINGERPRINT_OK) {
+    console.println("[Admin] ✓ Đã xóa tất cả vân tay!");
+    showMessage("All deleted!", "", 2000);
   } else {
-    Serial.println("[Admin] ✗ Lỗi khi xóa!");
+    console.println("[Admin] ✗ Lỗi khi xóa!");
+    showMessage("Delete failed!", "", 2000);
   }
 }
 
 // ==================== SHOW FINGERPRINT COUNT ====================
+// Đếm trên bảng ID trong RAM (finger_slots.h); chưa đọc được bảng -> hỏi cảm biến
 void showFingerprintCount() {
-  finger.getTemplateCount();
-  
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Stored prints:");
-  lcd.setCursor(0, 1);
-  lcd.print(finger.templateCount);
-  lcd.print(" / 127");
+  if (fingerSlotsReady()) {
+    showStoredCount(fingerSlotsCount());
+  } else {
+    as608Submit(AS608_COUNT, 0, onFingerCount);
+  }
+}
+
+void onFingerCount(const As608Result& r) {
+  if (r.code != FINGERPRINT_OK) {
+    showMessage("Sensor error!", "", 2000);
+    return;
+  }
+  showStoredCount(r.score);
+}
+
+void showStoredCount(uint16_t count) {
+  char line[17];
+  snprintf(line, sizeof(line), "%d / 127", count);
+  showMessage("Stored prints:", line, 3000);
   
-  Serial.printf("[Admin] Số vân tay đã lưu: %d / 127\n", finger.templateCount);
+  console.printf("[Admin] Số vân tay đã lưu: %d / 127\n", count);
+}
+
+// ==================== LOOP BUDGET ====================
+void checkLoopBudget(unsigned long elapsedUs) {
+  if (elapsedUs > loopMaxUs) loopMaxUs = elapsedUs;
+  if (elapsedUs <= LOOP_BUDGET_MS * 1000UL) return;
+  
+  loopOverBudget++;
+  if (lastLoopWarnTime == 0 || halMillis() - lastLoopWarnTime >= LOOP_WARN_INTERVAL) {
+    lastLoopWarnTime = halMillis();
+    console.printf("[Loop] ⚠ Vòng loop() mất %lu ms (> %d ms), đã vượt %lu lần\n",
+                  elapsedUs / 1000, LOOP_BUDGET_MS, loopOverBudget);
+  }
 }
 
 // ==================== MAIN FUNCTIONS ====================
@@ -1259,100 +1657,106 @@ void setup() {
 }
 
 void loop() {
-  // Đọc cảm biến
-  readSensors();
+  unsigned long loopStartUs = halMicros();
+  
+  // Nhận số liệu cảm biến từ core 0
+  PROFILE_CALL("readSensors", readSensors());
   
   // Xử lý bảo vệ quá nhiệt (ưu tiên cao nhất)
-  handleOverheatProtection();
+  PROFILE_CALL("overheat", handleOverheatProtection());
   
   // Xử lý tự động hóa (đèn, âm thanh)
-  handleAutomation();
+  PROFILE_CALL("automation", handleAutomation());
   
   // Xử lý keypad
-  handleKeypad();
+  PROFILE_CALL("keypad", handleKeypad());
+  
+  // Menu Admin / đổi mật khẩu / đăng ký vân tay (không chặn)
+  PROFILE_CALL("uiFlow", handleUiFlow());
+  
+  // Cảm biến vân tay: gửi lệnh đang chờ, nhận trả lời, gọi callback (as608.h)
+  PROFILE_CALL("as608", as608Service(halMillis()));
   
   // Xử lý vân tay
-  handleFingerprint();
+  PROFILE_CALL("fingerprint", handleFingerprint());
   
-  // Cập nhật màn hình
-  updateDisplay();
+  // Hẹn giờ tới hạn: tự khóa cửa, hết giờ khóa / 2FA, tắt đèn, thông báo
+  PROFILE_CALL("timers", timerService(halMillis()));
   
-  // Delay nhỏ để ổn định
-  delay(10);
+  // Cập nhật màn hình
+  PROFILE_CALL("display", updateDisplay());
+  
+  // Gửi các nhóm lỗi đã gộp khi hết cửa sổ
+  PROFILE_CALL("logAggregate", logAggregateService(halMillis()));
+  
+  // Lệnh chẩn đoán qua Serial
+  handleSerialCommands();
+  
+  // Kiểm tra thời gian 1 vòng (không được có bước nào chặn lâu)
+  checkLoopBudget(halMicros() - loopStartUs);
+  
+  // Nghỉ cuối vòng: delay nhỏ, hoặc hạ xung / ngủ nhẹ tới hạn chót gần nhất khi
+  // không có ai (màn hình chính, cửa khóa, không còn log chờ gửi / đang gửi)
+  unsigned long now = halMillis();
+  uint32_t wakeMs = timerNextMs(now);
+  uint32_t sensorsMs = sensorsNextMs(now);
+  uint32_t fingerMs = fingerPollWaitMs(now);
+  if (sensorsMs < wakeMs) wakeMs = sensorsMs;
+  if (fingerMs < wakeMs) wakeMs = fingerMs;
+  // Chờ trả lời vân tay: UART không đánh thức chip -> không ngủ
+  bool idle = authState == AUTH_IDLE && !doorUnlocked && !messageActive &&
+              !uplinkBusy() && as608Pending() == 0 && !fingerConsensusActive();
+  powerIdle(now, idle, wakeMs);
 }
 
 // ==================== WIFI CONNECTION ====================
 void connectWiFi() {
-  Serial.println("\n[WiFi] Đang kết nối WiFi...");
+  console.println("\n[WiFi] Đang kết nối WiFi...");
   lcd.clear();
   lcd.setCursor(0, 0);
   lcd.print("Connecting WiFi");
   
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  network.begin(WIFI_SSID, WIFI_PASSWORD);
   
   int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-    delay(500);
-    Serial.print(".");
+  while (!network.connected() && attempts < 20) {
+    halDelay(500);
+    console.print(".");
     lcd.setCursor(attempts % 16, 1);
     lcd.print(".");
     attempts++;
   }
   
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("\n[WiFi] ✓ Đã kết nối!");
-    Serial.print("[WiFi] IP: ");
-    Serial.println(WiFi.localIP());
+  if (network.connected()) {
+    console.println("\n[WiFi] ✓ Đã kết nối!");
+    console.print("[WiFi] IP: ");
+    console.println(network.address());
     lcd.clear();
     lcd.setCursor(0, 0);
     lcd.print("WiFi Connected!");
     lcd.setCursor(0, 1);
-    lcd.print(WiFi.localIP());
-    delay(2000);
+    lcd.print(network.address());
+    halDelay(2000);
   } else {
-    Serial.println("\n[WiFi] ✗ Không kết nối được!");
+    console.println("\n[WiFi] ✗ Không kết nối được!");
     lcd.clear();
     lcd.setCursor(0, 0);
     lcd.print("WiFi Failed!");
     lcd.setCursor(0, 1);
     lcd.print("Continue offline");
-    delay(2000);
+    halDelay(2000);
   }
 }
 
 // ==================== GOOGLE SHEETS LOGGING ====================
-void sendToGoogleSheets(String event, String method, String user, String status) {
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("[Sheets] WiFi không kết nối - bỏ qua gửi log");
-    return;
-  }
-  
-  HTTPClient http;
-  
-  // Tạo URL với parameters
-  String url = String(GOOGLE_SCRIPT_URL);
-  url += "?event=" + event;
-  url += "&method=" + method;
-  url += "&user=" + user;
-  url += "&status=" + status;
-  url += "&temp=" + String(temperature, 1);
-  url += "&humidity=" + String(humidity, 0);
-  
-  Serial.println("[Sheets] Đang gửi log...");
-  Serial.println("[Sheets] URL: " + url);
-  
-  http.begin(url);
-  http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-  
-  int httpCode = http.GET();
-  
-  if (httpCode > 0) {
-    Serial.printf("[Sheets] ✓ Gửi thành công! HTTP Code: %d\n", httpCode);
-    String response = http.getString();
-    Serial.println("[Sheets] Response: " + response);
-  } else {
-    Serial.printf("[Sheets] ✗ Lỗi: %s\n", http.errorToString(httpCode).c_str());
-  }
-  
-  http.end();
+// Chỉ đưa bản ghi (vài byte, không dùng heap) vào hàng đợi uplink,
+// task uplink sẽ định dạng và gửi HTTP. Lỗi lặp lại được gộp trước (log_aggregate.h)
+void sendToGoogleSheets(LogEventType event, LogMethod method, LogUser user,
+                        LogStatus status, uint16_t fingerId) {
+  traceLog(event, method, user, status, fingerId);
+  
+  // Đóng dấu ngay lúc xảy ra: gửi trễ / gửi lại vẫn đúng giờ và không bị trùng
+  LogEvent ev = logEventMake(event, method, user, status, fingerId, temperature, humidity);
+  eventClockStamp(ev);
+  logAggregateSubmit(ev, halMillis());
 }
@@ -0,0 +1,161 @@
+/*
+ * POWER - Hạ xung CPU / ngủ nhẹ khi không có ai
+ * Xem include/power.h
+ */
+
+#include "power.h"
+#include "hal.h"
+#include "sensors.h"
+
+// ==================== TRẠNG THÁI ====================
+static PowerMode mode = POWER_FULL;
+static uint32_t activityMs = 0;     // Lần có người dùng gần nhất
+static uint32_t accountUs = 0;      // Mốc đã cộng vào thống kê thời gian
+
+// Thống kê
+static uint64_t fullUs = 0;         // Thức ở 240 MHz
+static uint64_t slowUs = 0;         // Thức ở 80 MHz
+static uint64_t sleepUs = 0;        // Ngủ nhẹ
+static uint32_t sleeps = 0;
+static uint32_t gpioWakes = 0;      // Dậy do phím / chạm / âm thanh
+static uint32_t timerWakes = 0;
+static uint64_t wakeLateSumUs = 0;  // Dậy muộn so với hạn (ngủ hẹn giờ)
+static uint32_t wakeLateMaxUs = 0;
+
+// Dậy do chân đánh thức -> thao tác đầu tiên được xử lý
+static bool gpioWakePending = false;
+static uint32_t gpioWakeUs = 0;     // Lúc halLightSleep() trả về
+static uint32_t gpioHandled = 0;
+static uint64_t gpioLatencySumUs = 0;
+static uint32_t gpioLatencyMaxUs = 0;
+static uint32_t gpioNoInput = 0;    // Dậy rồi ngủ lại mà không có thao tác
+
+static const char* modeName(PowerMode m) {
+  switch (m) {
+    case POWER_FULL: return "FULL";
+    case POWER_SLOW: return "SLOW";
+    case POWER_SLEEP: return "SLEEP";
+  }
+  return "?";
+}
+
+// Cộng thời gian thức từ mốc trước theo xung CPU hiện tại. Gọi mỗi vòng
+// (powerIdle): hiệu uint32_t của halMicros() quay vòng sau ~71 phút
+static void account() {
+  uint32_t nowUs = halMicros();
+  uint32_t elapsedUs = nowUs - accountUs;
+  accountUs = nowUs;
+  if (mode == POWER_FULL) {
+    fullUs += elapsedUs;
+  } else {
+    slowUs += elapsedUs;
+  }
+}
+
+static void setMode(PowerMode next) {
+  if (next == mode) return;
+  account();
+  halConsole().printf("[Power] %s -> %s\n", modeName(mode), modeName(next));
+  mode = next;
+  halSetCpuMhz(mode == POWER_FULL ? POWER_CPU_FULL_MHZ : POWER_CPU_SLOW_MHZ);
+}
+
+// ==================== API ====================
+void powerBegin(uint32_t nowMs) {
+  activityMs = nowMs;
+  accountUs = halMicros();
+}
+
+void powerActivity(uint32_t nowMs) {
+  if (gpioWakePending) {
+    gpioWakePending = false;
+    uint32_t latencyUs = halMicros() - gpioWakeUs;
+    gpioHandled++;
+    gpioLatencySumUs += latencyUs;
+    if (latencyUs > gpioLatencyMaxUs) gpioLatencyMaxUs = latencyUs;
+  }
+  activityMs = nowMs;
+  setMode(POWER_FULL);
+}
+
+void powerIdle(uint32_t nowMs, bool canSleep, uint32_t wakeMs) {
+  account();
+#if POWER_SAVE
+  uint32_t quietMs = nowMs - activityMs;
+  if (quietMs >= POWER_SLEEP_AFTER_MS && canSleep) {
+    setMode(POWER_SLEEP);
+  } else if (quietMs >= POWER_SLOW_AFTER_MS) {
+    setMode(POWER_SLOW);
+  } else {
+    setMode(POWER_FULL);
+  }
+
+  if (mode == POWER_SLEEP && wakeMs >= POWER_SLEEP_MIN_MS) {
+    if (gpioWakePending) {
+      gpioWakePending = false;
+      gpioNoInput++;
+    }
+    uint32_t startUs = halMicros();
+    HalWakeCause cause = halLightSleep(wakeMs);
+    uint32_t sleptUs = halMicros() - startUs;
+    accountUs = halMicros();
+
+    // Chân đang ở mức đánh thức -> không ngủ được, nghỉ như thường
+    if (sleptUs < 1000) {
+      if (cause == HAL_WAKE_GPIO) powerActivity(halMillis());
+      halDelay(POWER_LOOP_DELAY_MS);
+      return;
+    }
+
+    sleepUs += sleptUs;
+    sleeps++;
+    if (cause == HAL_WAKE_TIMER) {
+      timerWakes++;
+      uint64_t wantUs = (uint64_t)wakeMs * 1000;
+      uint32_t lateUs = sleptUs > wantUs ? (uint32_t)(sleptUs - wantUs) : 0;
+      wakeLateSumUs += lateUs;
+      if (lateUs > wakeLateMaxUs) wakeLateMaxUs = lateUs;
+    } else if (cause == HAL_WAKE_GPIO) {
+      gpioWakes++;
+      activityMs = halMillis();
+      setMode(POWER_FULL);
+      // Đo tới khi keypad / vân tay / âm thanh xử lý thao tác (powerActivity)
+      gpioWakePending = true;
+      gpioWakeUs = accountUs;
+    }
+
+    // Task cảm biến xem lại hạn DHT11 / chân âm thanh
+    sensorsWake();
+    return;
+  }
+#endif
+  halDelay(POWER_LOOP_DELAY_MS);
+}
+
+PowerMode powerMode() {
+  return mode;
+}
+
+void powerPrint(uint32_t nowMs) {
+  account();
+  HalConsole& out = halConsole();
+  uint64_t totalUs = fullUs + slowUs + sleepUs;
+  if (totalUs == 0) totalUs = 1;
+
+  out.printf("[Power] Chế độ: %s (CPU %u MHz) | Yên lặng: %u s\n", modeName(mode),
+             (unsigned)halCpuMhz(), (unsigned)((nowMs - activityMs) / 1000));
+  out.printf("[Power] 240 MHz: %.1f%% | 80 MHz: %.1f%% | Ngủ nhẹ: %.1f%% (%u lần, dậy do phím/chạm/âm thanh: %u)\n",
+             fullUs * 100.0 / totalUs, slowUs * 100.0 / totalUs, sleepUs * 100.0 / totalUs,
+             (unsigned)sleeps, (unsigned)gpioWakes);
+
+  // Dòng trung bình theo thời gian ở từng chế độ
+  double avgUa = (fullUs * (double)POWER_UA_FULL + slowUs * (double)POWER_UA_SLOW +
+                  sleepUs * (double)POWER_UA_SLEEP) / totalUs;
+  out.printf("[Power] Trễ dậy hẹn giờ: TB %u us, max %u us | Dòng ước tính: %.1f mA (tiết kiệm %.0f%%)\n",
+             (unsigned)(timerWakes ? wakeLateSumUs / timerWakes : 0), (unsigned)wakeLateMaxUs,
+             avgUa / 1000.0, 100.0 - avgUa * 100.0 / POWER_UA_FULL);
+  out.printf("[Power] Dậy do phím/chạm/âm thanh -> xử lý: TB %u us, max %u us (%u lần, không "
+             "có thao tác: %u)\n",
+             (unsigned)(gpioHandled ? gpioLatencySumUs / gpioHandled : 0),
+             (unsigned)gpioLatencyMaxUs, (unsigned)gpioHandled, (unsigned)gpioNoInput);
+}
@@ -0,0 +1,185 @@
+/*
+ * SENSORS - Task đọc cảm biến (DHT11, LDR, âm thanh)
+ * Xem include/sensors.h
+ */
+
+#include "sensors.h"
+#include "ring_buffer.h"
+
+#include <string.h>
+
+// ==================== TRẠNG THÁI ====================
+// Chỉ task cảm biến dùng (trừ ring và bộ đếm bỏ tin)
+static HalClimate* sensorClimate = nullptr;
+static uint8_t sensorLdrPin = 0;
+static uint8_t sensorSoundPin = 0;
+static uint32_t lastClimateMs = 0;  // loop() cũng đọc (sensorsNextMs)
+static uint32_t lastSoundMs = 0;
+static bool climateRead = false;
+static bool soundSent = false;
+static bool soundHeld = false;      // Chân âm thanh còn HIGH ở lần xem gần nhất
+
+static SpscRing<SensorMsg, SENSOR_RING_LEN> sensorRing;
+static uint32_t sensorDropCount = 0;
+
+static void publish(const SensorMsg& msg) {
+  if (!sensorRing.push(msg)) {
+    __atomic_add_fetch(&sensorDropCount, 1, __ATOMIC_RELAXED);
+  }
+}
+
+// ==================== ĐỌC ====================
+static bool climateDue(uint32_t nowMs) {
+  return !climateRead || nowMs - lastClimateMs >= SENSOR_CLIMATE_MS;
+}
+
+static void readClimate(uint32_t nowMs) {
+  climateRead = true;
+  __atomic_store_n(&lastClimateMs, nowMs, __ATOMIC_RELAXED);
+
+  SensorMsg msg;
+  msg.kind = SENSOR_CLIMATE;
+  msg.temperature = sensorClimate->readTemperature();
+  msg.humidity = sensorClimate->readHumidity();
+  msg.lightLevel = halAnalogRead(sensorLdrPin);
+  msg.atMs = halMillis();
+  publish(msg);
+}
+
+// Báo ngay ở cạnh đầu tiên; các cạnh sau (tiếng kéo dài, chân rung)
+// gộp lại, tối đa 1 tin mỗi SENSOR_SOUND_REPEAT_MS để loop() giữ đèn sáng
+static void soundEdge(uint32_t nowMs) {
+  if (soundSent && nowMs - lastSoundMs < SENSOR_SOUND_REPEAT_MS) return;
+  soundSent = true;
+  lastSoundMs = nowMs;
+
+  SensorMsg msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.kind = SENSOR_SOUND;
+  msg.atMs = nowMs;
+  publish(msg);
+}
+
+// Cạnh lên (edge) hoặc xem lại mức chân: chân còn HIGH = tiếng kéo dài
+static void soundCheck(uint32_t nowMs, bool edge) {
+  bool high = halDigitalRead(sensorSoundPin) == HIGH;
+  if (edge || high) soundEdge(nowMs);
+  soundHeld = high;
+}
+
+// Thời gian tới lần xem lại chân âm thanh, UINT32_MAX nếu chân đã về LOW
+static uint32_t soundRecheckMs(uint32_t nowMs) {
+  if (!soundHeld) return UINT32_MAX;
+  uint32_t sinceMs = nowMs - lastSoundMs;
+  return sinceMs < SENSOR_SOUND_REPEAT_MS ? SENSOR_SOUND_REPEAT_MS - sinceMs : 0;
+}
+
+#if defined(ARDUINO)
+// ==================== ESP32: TASK + NGẮT ====================
+static TaskHandle_t sensorTaskHandle = nullptr;
+
+// Lý do đánh thức task (bit của task notification)
+#define NOTIFY_SOUND 0x01
+#define NOTIFY_WAKE 0x02
+
+// Cạnh lên ở SOUND_PIN -> chỉ đánh thức task, việc còn lại làm ngoài ngắt
+static void IRAM_ATTR onSoundEdge() {
+  if (!sensorTaskHandle) return;
+  BaseType_t woken = pdFALSE;
+  xTaskNotifyFromISR(sensorTaskHandle, NOTIFY_SOUND, eSetBits, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+static void sensorTask(void*) {
+  for (;;) {
+    if (climateDue(halMillis())) readClimate(halMillis());
+    if (soundRecheckMs(halMillis()) == 0) soundCheck(halMillis(), false);
+
+    // Ngủ tới lần đọc DHT11 / xem lại chân âm thanh kế tiếp, trừ khi ngắt âm
+    // thanh / loop() đánh thức
+    uint32_t waitMs = SENSOR_CLIMATE_MS - (halMillis() - lastClimateMs);
+    if (waitMs > SENSOR_CLIMATE_MS) waitMs = 0;
+    uint32_t recheckMs = soundRecheckMs(halMillis());
+    if (recheckMs < waitMs) waitMs = recheckMs;
+    uint32_t bits = 0;
+    if (xTaskNotifyWait(0, UINT32_MAX, &bits, pdMS_TO_TICKS(waitMs)) == pdFALSE) continue;
+
+    // Dậy sau ngủ nhẹ: cạnh lúc ngủ bị mất -> đọc mức chân
+    if (bits & NOTIFY_SOUND) {
+      soundCheck(halMillis(), true);
+    } else if (bits & NOTIFY_WAKE) {
+      soundCheck(halMillis(), false);
+    }
+  }
+}
+
+void sensorsWake() {
+  if (sensorTaskHandle) xTaskNotify(sensorTaskHandle, NOTIFY_WAKE, eSetBits);
+}
+
+static bool sensorsStart() {
+  if (sensorTaskHandle) return true;
+  if (xTaskCreatePinnedToCore(sensorTask, "sensors", SENSOR_TASK_STACK, nullptr,
+                              SENSOR_TASK_PRIORITY, &sensorTaskHandle,
+                              SENSOR_TASK_CORE) != pdPASS) {
+    halConsole().println("[Sensors] ✗ Không tạo được task cảm biến!");
+    return false;
+  }
+  return true;
+}
+
+#else
+// ==================== MÁY TÍNH: GỌI TỪ VÒNG MÔ PHỎNG ====================
+// Không có task -> sensorsService() làm việc của task, ngắt chỉ đặt cờ
+static volatile bool soundPending = false;
+
+static void onSoundEdge() {
+  soundPending = true;
+}
+
+static bool sensorsStart() {
+  return true;
+}
+
+// sensorsService() chạy mỗi bước mô phỏng, không cần đánh thức
+void sensorsWake() {}
+
+void sensorsService(uint32_t nowMs) {
+  if (climateDue(nowMs)) readClimate(nowMs);
+  if (soundPending) {
+    soundPending = false;
+    soundCheck(nowMs, true);
+  } else if (soundRecheckMs(nowMs) == 0) {
+    soundCheck(nowMs, false);
+  }
+}
+#endif
+
+// ==================== API ====================
+bool sensorsBegin(HalClimate& climate, uint8_t ldrPin, uint8_t soundPin) {
+  sensorClimate = &climate;
+  sensorLdrPin = ldrPin;
+  sensorSoundPin = soundPin;
+
+  halPinMode(soundPin, INPUT);
+  sensorClimate->begin();
+
+  if (!sensorsStart()) return false;
+
+  // Gắn ngắt sau khi đã có task để đánh thức
+  halAttachInterrupt(soundPin, onSoundEdge, RISING);
+  return true;
+}
+
+bool sensorsReceive(SensorMsg& msg) {
+  return sensorRing.pop(msg);
+}
+
+uint32_t sensorsDropped() {
+  return __atomic_load_n(&sensorDropCount, __ATOMIC_RELAXED);
+}
+
+uint32_t sensorsNextMs(uint32_t nowMs) {
+  uint32_t sinceMs = nowMs - __atomic_load_n(&lastClimateMs, __ATOMIC_RELAXED);
+  return sinceMs < SENSOR_CLIMATE_MS ? SENSOR_CLIMATE_MS - sinceMs : 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * TIMER WHEEL - Hẹn giờ phân tầng
+ * Xem include/timer_wheel.h
+ */
+
+#include "timer_wheel.h"
+
+#define SLOTS (1u << TIMER_WHEEL_BITS)
+#define SLOT_MASK (SLOTS - 1)
+
+// Hạn xa nhất đặt được trong bánh xe (tính bằng nấc)
+#define MAX_DELTA ((1ul << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+static Timer* wheel[TIMER_WHEEL_LEVELS][SLOTS];
+static uint32_t wheelTick = 0;      // Nấc đã xử lý gần nhất
+static uint32_t wheelMs = 0;        // millis() ứng với wheelTick
+static uint16_t armedCount = 0;
+
+// ==================== DANH SÁCH Ô ====================
+static void link(Timer*& head, Timer& t) {
+  t.next = head;
+  if (head) head->pprev = &t.next;
+  head = &t;
+  t.pprev = &head;
+}
+
+static void unlink(Timer& t) {
+  *t.pprev = t.next;
+  if (t.next) t.next->pprev = t.pprev;
+  t.next = nullptr;
+  t.pprev = nullptr;
+}
+
+// Chọn tầng theo khoảng cách tới hạn, ô theo nấc tới hạn
+static void place(Timer& t) {
+  uint32_t delta = t.expires - wheelTick;
+  uint32_t at = t.expires;
+  if (delta > MAX_DELTA) at = wheelTick + MAX_DELTA;  // Quá xa: dời lại khi cascade
+
+  int level = 0;
+  while (level < TIMER_WHEEL_LEVELS - 1 &&
+         (at - wheelTick) >= (1ul << (TIMER_WHEEL_BITS * (level + 1)))) {
+    level++;
+  }
+  link(wheel[level][(at >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK], t);
+}
+
+// Chuyển ô hiện tại của tầng level xuống các tầng dưới.
+// Trả về true nếu tầng này cũng vừa quay hết vòng (cần cascade tầng trên)
+static bool cascade(int level) {
+  uint32_t index = (wheelTick >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK;
+  Timer* list = wheel[level][index];
+  wheel[level][index] = nullptr;
+  while (list) {
+    Timer* t = list;
+    list = t->next;
+    t->next = nullptr;
+    t->pprev = nullptr;
+    place(*t);
+  }
+  return index == 0;
+}
+
+// ==================== API ====================
+void timerBegin(uint32_t nowMs) {
+  wheelMs = nowMs;
+}
+
+void timerArm(Timer& t, uint32_t nowMs, uint32_t delayMs) {
+  if (t.pprev) {
+    unlink(t);
+    armedCount--;
+  }
+
+  // Tính từ mốc wheelMs của nấc đã xử lý, làm tròn lên -> không chạy sớm
+  uint32_t sinceTick = nowMs - wheelMs;
+  if ((int32_t)sinceTick < 0) sinceTick = 0;
+  uint32_t ticks = (uint32_t)(((uint64_t)sinceTick + delayMs + TIMER_TICK_MS - 1) / TIMER_TICK_MS);
+  if (ticks == 0) ticks = 1;  // Nấc hiện tại đã xử lý xong
+
+  t.expires = wheelTick + ticks;
+  place(t);
+  armedCount++;
+}
+
+void timerCancel(Timer& t) {
+  if (!t.pprev) return;
+  unlink(t);
+  armedCount--;
+}
+
+bool timerArmed(const Timer& t) {
+  return t.pprev != nullptr;
+}
+
+uint32_t timerRemainingMs(const Timer& t, uint32_t nowMs) {
+  if (!t.pprev) return 0;
+  uint64_t dueMs = (uint64_t)(t.expires - wheelTick) * TIMER_TICK_MS;
+  uint32_t sinceTick = nowMs - wheelMs;
+  if ((int32_t)sinceTick < 0) sinceTick = 0;
+  return dueMs > sinceTick ? (uint32_t)(dueMs - sinceTick) : 0;
+}
+
+void timerService(uint32_t nowMs) {
+  if ((int32_t)(nowMs - wheelMs) < 0) return;
+  uint32_t ticks = (nowMs - wheelMs) / TIMER_TICK_MS;
+
+  // Không có gì để chạy: chỉ cộng đồng hồ
+  if (armedCount == 0) {
+    wheelTick += ticks;
+    wheelMs += ticks * TIMER_TICK_MS;
+    return;
+  }
+
+  while (ticks--) {
+    wheelTick++;
+    wheelMs += TIMER_TICK_MS;
+
+    uint32_t index = wheelTick & SLOT_MASK;
+    if (index == 0) {
+      for (int level = 1; level < TIMER_WHEEL_LEVELS && cascade(level); level++) {
+      }
+    }
+
+    // Gỡ từng cái trước khi gọi: callback được gắn lại / hủy tùy ý.
+    // Gắn lại luôn rơi vào nấc sau (ticks >= 1) nên vòng này kết thúc
+    while (Timer* t = wheel[0][index]) {
+      unlink(*t);
+      armedCount--;
+      t->fn();
+    }
+
+    if (armedCount == 0) {
+      wheelTick += ticks;
+      wheelMs += ticks * TIMER_TICK_MS;
+      return;
+    }
+  }
+}
+
+uint32_t timerNextMs(uint32_t nowMs) {
+  if (armedCount == 0) return UINT32_MAX;
+
+  // Ô tầng 0 có hẹn giờ gần nhất; không có -> lần cascade kế tiếp (đầu vòng tầng 0)
+  uint32_t ticks = SLOTS - (wheelTick & SLOT_MASK);
+  for (uint32_t i = 1; i < ticks; i++) {
+    if (wheel[0][(wheelTick + i) & SLOT_MASK]) {
+      ticks = i;
+      break;
+    }
+  }
+
+  uint32_t dueMs = ticks * TIMER_TICK_MS;
+  uint32_t sinceTick = nowMs - wheelMs;
+  if ((int32_t)sinceTick < 0) sinceTick = 0;
+  return dueMs > sinceTick ? dueMs - sinceTick : 0;
+}
+
+uint16_t timerCount() {
+  return armedCount;
+}
@@ -0,0 +1,328 @@
+/*
+ * UPLINK - Gửi log lên Google Sheets bất đồng bộ
+ * Xem include/uplink.h
+ */
+
+#include "uplink.h"
+#include "journal.h"
+#include "event_clock.h"
+#include "uplink_metrics.h"
+#include "hal.h"
+
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <WiFi.h>
+#include "uplink_conn.h"
+#include "ring_buffer.h"
+#endif
+
+// ==================== TRẠNG THÁI ====================
+static const char* uplinkUrl = nullptr;
+static UplinkTransport uplinkTransport = nullptr;
+
+// ==================== ĐỊNH DẠNG JSON ====================
+int uplinkBuildBody(const UplinkBatch& batch, char* out, size_t outLen) {
+  static const char head[] = "{\"rows\":[";
+  static const char tail[] = "]}";
+
+  if (outLen < sizeof(head)) return -1;
+  memcpy(out, head, sizeof(head));
+  size_t pos = sizeof(head) - 1;
+
+  for (uint8_t i = 0; i < batch.count; i++) {
+    if (i > 0) {
+      if (pos + 1 >= outLen) return -1;
+      out[pos++] = ',';
+    }
+    // Sự kiện tạo trước khi có giờ SNTP -> bù giờ trước khi gửi
+    LogEvent ev = batch.events[i];
+    eventClockResolve(ev);
+    int n = logFormatJsonRow(ev, out + pos, outLen - pos);
+    if (n < 0) return -1;
+    pos += n;
+  }
+
+  if (pos + sizeof(tail) > outLen) return -1;
+  memcpy(out + pos, tail, sizeof(tail));
+  return (int)(pos + sizeof(tail) - 1);
+}
+
+// ==================== GOM LÔ ====================
+static void batchAdd(UplinkBatch& batch, const LogEvent& ev, uint32_t queuedMs,
+                     uint32_t nowMs) {
+  if (batch.count == 0) batch.firstMs = nowMs;
+  batch.queuedMs[batch.count] = queuedMs;
+  batch.events[batch.count++] = ev;
+}
+
+bool uplinkBatchDue(const UplinkBatch& batch, uint32_t nowMs) {
+  if (batch.count == 0) return false;
+  if (batch.count >= UPLINK_BATCH_MAX) return true;
+  return nowMs - batch.firstMs >= UPLINK_BATCH_WINDOW_MS;
+}
+
+// ==================== GỬI ĐỒNG BỘ ====================
+int uplinkDeliver(const UplinkBatch& batch, bool* accepted) {
+  static char body[UPLINK_BODY_LEN];  // Chỉ task uplink dùng
+
+  if (accepted) *accepted = false;
+  if (batch.count == 0) return 0;
+  if (!uplinkTransport || !uplinkUrl) return -1;
+
+  int len = uplinkBuildBody(batch, body, sizeof(body));
+  if (len < 0) return UPLINK_BODY_ERROR;
+
+  bool ok = false;
+  int httpCode = uplinkTransport(uplinkUrl, body, (size_t)len, &ok);
+  metricsRecordHttp(httpCode);
+  if (httpCode >= 200 && httpCode < 400 && !ok) uplinkMetrics.scriptErrors++;
+  if (accepted) *accepted = ok;
+  return httpCode;
+}
+
+static bool deliveryOk(int httpCode, bool accepted) {
+  return httpCode >= 200 && httpCode < 400 && accepted;
+}
+
+// Server từ chối lô (URL / quyền / body sai): gửi lại vẫn bị từ chối
+static bool rejected(int httpCode) {
+  return httpCode >= 400 && httpCode < 500;
+}
+
+// Lô gửi lại cũng không được -> bỏ hẳn
+static void discard(const UplinkBatch& batch, const char* reason) {
+  uplinkMetrics.discarded += batch.count;
+  halConsole().printf("[Sheets] ✗ %s - bỏ %u sự kiện\n", reason, batch.count);
+}
+
+// Ghi lô vào nhật ký offline để gửi lại sau
+static void spool(const UplinkBatch& batch) {
+  if (!journalReady()) {
+    halConsole().printf("[Sheets] ✗ Không có nhật ký offline - mất %u sự kiện\n", batch.count);
+    return;
+  }
+  uint8_t saved = 0;
+  for (uint8_t i = 0; i < batch.count; i++) {
+    if (journalAppend(batch.events[i])) saved++;
+  }
+  uplinkMetrics.spooled += saved;
+  if (saved < batch.count) {
+    halConsole().printf("[Journal] ✗ Ghi flash lỗi - mất %u sự kiện\n", batch.count - saved);
+  }
+  halConsole().printf("[Journal] Lưu %u sự kiện chờ gửi lại (tổng %u)\n",
+                      saved, (unsigned)journalCount());
+}
+
+bool uplinkReplay() {
+  static UplinkBatch replay;       // Chỉ task uplink dùng
+  static uint8_t scriptErrors = 0;  // Số lần liền script báo lỗi cho lô đầu nhật ký
+
+  while (journalCount() > 0) {
+    replay.count = journalPeek(replay.events, UPLINK_BATCH_MAX);
+    if (replay.count == 0) break;
+    uplinkMetrics.retries++;
+    bool accepted;
+    int httpCode = uplinkDeliver(replay, &accepted);
+
+    // Không bỏ thì nhật ký kẹt mãi ở lô này
+    const char* reason = nullptr;
+    if (httpCode == UPLINK_BODY_ERROR) {
+      reason = "Lô quá lớn";
+    } else if (rejected(httpCode)) {
+      reason = "Server từ chối (HTTP 4xx)";
+    } else if (httpCode >= 200 && httpCode < 400 && !accepted &&
+               ++scriptErrors >= UPLINK_SCRIPT_ERROR_MAX) {
+      reason = "Script báo lỗi nhiều lần";
+    }
+    if (reason) {
+      scriptErrors = 0;
+      discard(replay, reason);
+      journalConsume(replay.count);
+      continue;
+    }
+    if (!deliveryOk(httpCode, accepted)) return false;
+    scriptErrors = 0;
+    journalConsume(replay.count);
+    uplinkMetrics.replayed += replay.count;
+    uplinkMetrics.delivered += replay.count;
+    halConsole().printf("[Journal] ✓ Đã gửi lại %u sự kiện (còn %u)\n",
+                        replay.count, (unsigned)journalCount());
+  }
+  return true;
+}
+
+void uplinkFlush(UplinkBatch& batch, uint32_t nowMs) {
+  if (batch.count == 0) return;
+
+  bool accepted = false;
+  int httpCode = 0;
+  if (journalCount() > 0) {
+    // Còn sự kiện cũ chưa gửi -> xếp sau chúng để giữ đúng thứ tự
+    spool(batch);
+    uplinkReplay();
+  } else if ((httpCode = uplinkDeliver(batch, &accepted)) == UPLINK_BODY_ERROR) {
+    discard(batch, "Lô quá lớn");
+  } else if (rejected(httpCode)) {
+    discard(batch, "Server từ chối (HTTP 4xx)");
+  } else if (!deliveryOk(httpCode, accepted)) {
+    spool(batch);
+  } else {
+    // Độ trễ chỉ đo cho sự kiện gửi thẳng; sự kiện qua nhật ký không còn
+    // giữ thời điểm vào hàng đợi (có thể đã qua lần khởi động lại)
+    uplinkMetrics.delivered += batch.count;
+    for (uint8_t i = 0; i < batch.count; i++) {
+      metricsRecordLatency(nowMs - batch.queuedMs[i]);
+    }
+  }
+  batch.count = 0;
+}
+
+uint32_t uplinkDropped() {
+  return uplinkMetrics.dropped;
+}
+
+#if defined(ARDUINO)
+// ==================== ESP32: HTTP + FREERTOS TASK ====================
+// Phần tử hàng đợi: sự kiện + thời điểm vào hàng đợi (đo độ trễ)
+struct UplinkItem {
+  LogEvent ev;
+  uint32_t queuedMs;
+};
+
+// Mọi task đều có thể ghi log, chỉ task uplink đọc
+static MpscRing<UplinkItem, UPLINK_QUEUE_LEN> uplinkRing;
+static TaskHandle_t uplinkTaskHandle = nullptr;
+static bool uplinkTaskBusy = false;   // Task đang giữ lô / đang gửi (đọc từ task khác)
+
+// Thời gian (ms) còn lại trước khi lô đến hạn
+static uint32_t batchRemainingMs(const UplinkBatch& batch, uint32_t nowMs) {
+  uint32_t waited = nowMs - batch.firstMs;
+  return waited >= UPLINK_BATCH_WINDOW_MS ? 0 : UPLINK_BATCH_WINDOW_MS - waited;
+}
+
+static void uplinkTask(void*) {
+  static UplinkBatch batch;
+  UplinkItem item;
+  batch.count = 0;
+
+  for (;;) {
+    // Có sự kiện -> chỉ chờ tới hạn gửi lô; còn nhật ký offline -> thử lại
+    // định kỳ; không có gì -> chờ vô hạn
+    TickType_t wait = portMAX_DELAY;
+    if (batch.count > 0) {
+      wait = pdMS_TO_TICKS(batchRemainingMs(batch, millis()));
+    } else if (journalCount() > 0) {
+      wait = pdMS_TO_TICKS(UPLINK_RETRY_MS);
+    }
+
+    // Ring không chặn -> ngủ chờ uplinkLog() đánh thức (task notification)
+    if (uplinkRing.size() == 0) ulTaskNotifyTake(pdTRUE, wait);
+
+    // Bật cờ trước khi lấy khỏi ring: uplinkBusy() không thấy lúc sự kiện
+    // đã rời ring mà task chưa nhận là của mình
+    __atomic_store_n(&uplinkTaskBusy, true, __ATOMIC_SEQ_CST);
+
+    // Lấy các sự kiện đang chờ để gom chung lô
+    while (batch.count < UPLINK_BATCH_MAX && uplinkRing.pop(item)) {
+      batchAdd(batch, item.ev, item.queuedMs, millis());
+    }
+
+    if (uplinkBatchDue(batch, millis())) {
+      uplinkFlush(batch, millis());
+    } else if (batch.count == 0 && journalCount() > 0 &&
+               WiFi.status() == WL_CONNECTED) {
+      uplinkReplay();
+    }
+    __atomic_store_n(&uplinkTaskBusy, batch.count > 0, __ATOMIC_SEQ_CST);
+  }
+}
+
+bool uplinkBegin(const char* scriptUrl, UplinkTransport transport) {
+  uplinkUrl = scriptUrl;
+  uplinkTransport = transport ? transport : uplinkConnPost;
+
+  if (uplinkTaskHandle) return true;
+
+  if (xTaskCreatePinnedToCore(uplinkTask, "uplink", UPLINK_TASK_STACK, nullptr,
+                              UPLINK_TASK_PRIORITY, &uplinkTaskHandle,
+                              UPLINK_TASK_CORE) != pdPASS) {
+    halConsole().println("[Sheets] ✗ Không tạo được task uplink!");
+    return false;
+  }
+  return true;
+}
+
+bool uplinkLog(const LogEvent& ev) {
+  if (!uplinkTaskHandle) return false;
+
+  // Không chờ: nếu hàng đợi đầy thì bỏ sự kiện, cửa vẫn mở ngay
+  UplinkItem item = { ev, (uint32_t)millis() };
+  if (!uplinkRing.push(item)) {
+    __atomic_add_fetch(&uplinkMetrics.dropped, 1, __ATOMIC_RELAXED);
+    halConsole().printf("[Sheets] ✗ Hàng đợi đầy - bỏ sự kiện %s\n", logEventName(ev.event));
+    return false;
+  }
+  metricsRecordEnqueue(uplinkRing.size());
+  xTaskNotifyGive(uplinkTaskHandle);
+  return true;
+}
+
+uint32_t uplinkPending() {
+  return uplinkRing.size();
+}
+
+bool uplinkBusy() {
+  // Đọc ring trước cờ: sự kiện vừa được lấy ra thì cờ đã bật
+  if (uplinkRing.size() > 0) return true;
+  if (__atomic_load_n(&uplinkTaskBusy, __ATOMIC_SEQ_CST)) return true;
+  return journalCount() > 0;
+}
+
+#else
+// ==================== MÁY TÍNH: GOM LÔ ĐỒNG BỘ ====================
+// Không có FreeRTOS -> gom lô ngay trong uplinkLog(), gửi trong uplinkService()
+static UplinkBatch hostBatch;
+static uint32_t hostNowMs = 0;
+static uint32_t hostRetryMs = 0;   // Lần gửi gần nhất (lô mới hoặc gửi lại)
+
+static void hostFlush() {
+  hostRetryMs = hostNowMs;
+  uplinkFlush(hostBatch, hostNowMs);
+}
+
+bool uplinkBegin(const char* scriptUrl, UplinkTransport transport) {
+  uplinkUrl = scriptUrl;
+  uplinkTransport = transport;
+  hostBatch.count = 0;
+  return transport != nullptr;
+}
+
+bool uplinkLog(const LogEvent& ev) {
+  batchAdd(hostBatch, ev, hostNowMs, hostNowMs);
+  metricsRecordEnqueue(hostBatch.count);
+  if (hostBatch.count >= UPLINK_BATCH_MAX) hostFlush();
+  return true;
+}
+
+void uplinkService(uint32_t nowMs) {
+  hostNowMs = nowMs;
+  if (uplinkBatchDue(hostBatch, nowMs)) {
+    hostFlush();
+  } else if (hostBatch.count == 0 && journalCount() > 0 &&
+             nowMs - hostRetryMs >= UPLINK_RETRY_MS) {
+    // Như task ESP32: thử lại nhật ký mỗi UPLINK_RETRY_MS, không phải mỗi vòng
+    hostRetryMs = nowMs;
+    uplinkReplay();
+  }
+}
+
+uint32_t uplinkPending() {
+  return hostBatch.count;
+}
+
+bool uplinkBusy() {
+  return hostBatch.count > 0 || journalCount() > 0;
+}
+#endif
@@ -0,0 +1,281 @@
+/*
+ * UPLINK CONNECTION - Giữ kết nối HTTPS lâu dài cho task uplink
+ * Xem include/uplink_conn.h
+ */
+
+#if defined(ARDUINO)
+
+#include "uplink_conn.h"
+#include "hal.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+
+// ==================== TRẠNG THÁI ====================
+struct HostConn {
+  WiFiClientSecure client;
+  char host[64];
+  uint32_t lastUsedMs;
+};
+
+static HostConn conns[UPLINK_CONN_POOL];
+static UplinkConnStats stats;
+static bool connInitialized = false;
+
+// URL sau redirect của Apps Script khá dài (user_content_key)
+static char redirectUrl[512];
+
+// Học redirect: tiền tố Location đã kiểm chứng (phần trước dấu '?')
+static char redirectPrefix[96];
+static uint8_t redirectConfirmed = 0;
+static uint16_t acceptedSinceVerify = 0;
+static bool redirectTrusted = false;
+
+// ==================== TIỆN ÍCH ====================
+static bool parseHost(const char* url, char* host, size_t len) {
+  const char* p = strstr(url, "://");
+  p = p ? p + 3 : url;
+  size_t n = strcspn(p, "/:?");
+  if (n == 0 || n >= len) return false;
+  memcpy(host, p, n);
+  host[n] = '\0';
+  return true;
+}
+
+static void initConnections() {
+  if (connInitialized) return;
+  for (int i = 0; i < UPLINK_CONN_POOL; i++) {
+    conns[i].client.setInsecure();
+    conns[i].client.setHandshakeTimeout(UPLINK_CONN_TIMEOUT_MS / 1000);
+    conns[i].host[0] = '\0';
+    conns[i].lastUsedMs = 0;
+  }
+  connInitialized = true;
+}
+
+// Lấy kết nối của host, hoặc dùng lại ô ít dùng nhất
+static HostConn& connFor(const char* host) {
+  HostConn* lru = &conns[0];
+  for (int i = 0; i < UPLINK_CONN_POOL; i++) {
+    if (strcmp(conns[i].host, host) == 0) return conns[i];
+    if (conns[i].lastUsedMs < lru->lastUsedMs) lru = &conns[i];
+  }
+  lru->client.stop();
+  strncpy(lru->host, host, sizeof(lru->host) - 1);
+  lru->host[sizeof(lru->host) - 1] = '\0';
+  lru->lastUsedMs = 0;
+  return *lru;
+}
+
+// Đảm bảo có kết nối. Trả về 1 = dùng lại, 0 = vừa bắt tay mới, -1 = lỗi
+static int ensureConnected(HostConn& c, bool forceNew) {
+  bool alive = !forceNew && c.client.connected() &&
+               millis() - c.lastUsedMs < UPLINK_CONN_IDLE_MS;
+  if (alive) {
+    stats.reused++;
+    return 1;
+  }
+
+  c.client.stop();
+  uint32_t start = millis();
+  if (!c.client.connect(c.host, 443)) {
+    halConsole().printf("[Conn] ✗ Không kết nối được %s\n", c.host);
+    return -1;
+  }
+
+  uint32_t elapsed = millis() - start;
+  stats.handshakes++;
+  stats.handshakeMsTotal += elapsed;
+  stats.lastHandshakeMs = elapsed;
+  halConsole().printf("[Conn] Bắt tay TLS với %s: %u ms\n", c.host, (unsigned)elapsed);
+  return 0;
+}
+
+// ==================== HTTP REQUEST ====================
+static bool isRedirect(int httpCode) {
+  return httpCode == 301 || httpCode == 302 || httpCode == 303;
+}
+
+// Gửi 1 request trên kết nối c (POST nếu có body, GET nếu không).
+// Nếu là redirect thì chép Location vào location; bodyOk = script báo success
+static int httpRequest(HostConn& c, const char* url, const char* body, size_t len,
+                       char* location, size_t locationLen, bool* bodyOk) {
+  HTTPClient http;
+  http.setReuse(true);
+  http.setTimeout(UPLINK_CONN_TIMEOUT_MS);
+  http.setFollowRedirects(HTTPC_DISABLE_FOLLOW_REDIRECTS);
+  if (!http.begin(c.client, url)) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  const char* headerKeys[] = {"Location"};
+  http.collectHeaders(headerKeys, 1);
+
+  int httpCode;
+  if (body) {
+    http.addHeader("Content-Type", "application/json");
+    httpCode = http.POST((uint8_t*)body, len);
+  } else {
+    httpCode = http.GET();
+  }
+  stats.requests++;
+
+  if (httpCode > 0) {
+    // Luôn đọc hết body, nếu không kết nối không dùng lại được
+    String response = http.getString();
+    if (isRedirect(httpCode) && location) {
+      strncpy(location, http.header("Location").c_str(), locationLen - 1);
+      location[locationLen - 1] = '\0';
+    } else {
+      halConsole().printf("[Sheets] Response: %s\n", response.c_str());
+      if (bodyOk) *bodyOk = strstr(response.c_str(), "\"status\":\"success\"") != nullptr;
+    }
+  }
+
+  http.end();
+  c.lastUsedMs = millis();
+  return httpCode;
+}
+
+// Gửi request; nếu kết nối cũ đã bị server đóng thì kết nối lại, thử 1 lần nữa
+static int requestWithReconnect(const char* url, const char* body, size_t len,
+                                char* location, size_t locationLen, bool* bodyOk) {
+  char host[64];
+  if (!parseHost(url, host, sizeof(host))) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  HostConn& c = connFor(host);
+  int httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    int state = ensureConnected(c, attempt > 0);
+    if (state < 0) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+    httpCode = httpRequest(c, url, body, len, location, locationLen, bodyOk);
+    if (httpCode > 0 || state == 0) break;
+
+    stats.reconnects++;
+    halConsole().printf("[Conn] Kết nối cũ tới %s đã hỏng - kết nối lại\n", host);
+  }
+  return httpCode;
+}
+
+// ==================== HỌC REDIRECT ====================
+// Độ dài tiền tố URL dùng để nhận diện redirect (tới hết dấu '?')
+static size_t prefixLength(const char* url) {
+  const char* q = strchr(url, '?');
+  return q ? (size_t)(q - url + 1) : strlen(url);
+}
+
+static bool matchesLearnedPrefix(const char* url) {
+  return redirectPrefix[0] && strncmp(url, redirectPrefix, strlen(redirectPrefix)) == 0;
+}
+
+// Ghi nhận kết quả một lần theo redirect để quyết định có tin 302 hay không
+static void learnRedirect(const char* location, bool success) {
+  size_t n = prefixLength(location);
+  if (!success || n >= sizeof(redirectPrefix)) {
+    if (redirectTrusted) {
+      halConsole().println("[Conn] Redirect không còn đáng tin - luôn theo redirect");
+    }
+    redirectTrusted = false;
+    redirectConfirmed = 0;
+    redirectPrefix[0] = '\0';
+    return;
+  }
+
+  if (!matchesLearnedPrefix(location)) {
+    memcpy(redirectPrefix, location, n);
+    redirectPrefix[n] = '\0';
+    redirectConfirmed = 0;
+  }
+  if (redirectConfirmed < UPLINK_REDIRECT_LEARN) redirectConfirmed++;
+  if (!redirectTrusted && redirectConfirmed >= UPLINK_REDIRECT_LEARN) {
+    redirectTrusted = true;
+    halConsole().printf("[Conn] ✓ Đã học redirect %s - coi 302 là đã nhận log\n", redirectPrefix);
+  }
+}
+
+// Có thể bỏ bước theo redirect cho Location này không
+static bool canAcceptRedirect(const char* location) {
+  if (!UPLINK_TRUST_REDIRECT || !redirectTrusted) return false;
+  if (!matchesLearnedPrefix(location)) return false;
+  if (++acceptedSinceVerify >= UPLINK_REDIRECT_VERIFY_EVERY) {
+    acceptedSinceVerify = 0;
+    return false;  // Định kỳ theo redirect để kiểm tra lại
+  }
+  return true;
+}
+
+// ==================== API ====================
+int uplinkConnPost(const char* url, const char* body, size_t len, bool* accepted) {
+  initConnections();
+  *accepted = false;
+
+  if (WiFi.status() != WL_CONNECTED) {
+    halConsole().println("[Sheets] WiFi không kết nối - chưa gửi được log");
+    uplinkConnReset();
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+
+  halConsole().printf("[Sheets] Đang gửi lô (%u bytes)...\n", (unsigned)len);
+
+  uint32_t start = millis();
+  redirectUrl[0] = '\0';
+  int httpCode = requestWithReconnect(url, body, len, redirectUrl, sizeof(redirectUrl), accepted);
+
+  // Apps Script chạy doPost rồi trả 302 -> GET trang kết quả (hoặc bỏ qua nếu đã học)
+  if (isRedirect(httpCode) && redirectUrl[0]) {
+    if (canAcceptRedirect(redirectUrl)) {
+      httpCode = HTTP_CODE_OK;
+      *accepted = true;
+      stats.redirectsAccepted++;
+      stats.acceptMsTotal += millis() - start;
+      halConsole().println("[Sheets] 302 đúng tiền tố đã học - coi như đã nhận log");
+    } else {
+      httpCode = requestWithReconnect(redirectUrl, nullptr, 0, nullptr, 0, accepted);
+      learnRedirect(redirectUrl, httpCode == HTTP_CODE_OK && *accepted);
+      stats.redirectsFollowed++;
+      stats.followMsTotal += millis() - start;
+    }
+  }
+
+  if (httpCode > 0 && *accepted) {
+    halConsole().printf("[Sheets] ✓ Gửi thành công! HTTP Code: %d\n", httpCode);
+  } else if (httpCode > 0) {
+    halConsole().printf("[Sheets] ✗ Script báo lỗi - HTTP Code: %d\n", httpCode);
+  } else {
+    halConsole().printf("[Sheets] ✗ Lỗi: %s\n", HTTPClient::errorToString(httpCode).c_str());
+  }
+  halConsole().printf("[Conn] %u request | %u bắt tay TLS | %u dùng lại | tiết kiệm ~%u ms\n",
+                      (unsigned)stats.requests, (unsigned)stats.handshakes,
+                      (unsigned)stats.reused, (unsigned)uplinkConnSavedMs());
+  if (stats.redirectsFollowed && stats.redirectsAccepted) {
+    halConsole().printf("[Conn] 302: theo %u lần (TB %u ms) | chấp nhận ngay %u lần (TB %u ms)\n",
+                        (unsigned)stats.redirectsFollowed,
+                        (unsigned)(stats.followMsTotal / stats.redirectsFollowed),
+                        (unsigned)stats.redirectsAccepted,
+                        (unsigned)(stats.acceptMsTotal / stats.redirectsAccepted));
+  }
+  return httpCode;
+}
+
+void uplinkConnReset() {
+  for (int i = 0; i < UPLINK_CONN_POOL; i++) {
+    conns[i].client.stop();
+  }
+}
+
+const UplinkConnStats& uplinkConnStats() {
+  return stats;
+}
+
+bool uplinkConnRedirectTrusted() {
+  return redirectTrusted;
+}
+
+uint32_t uplinkConnSavedMs() {
+  if (stats.handshakes == 0) return 0;
+  return stats.reused * (stats.handshakeMsTotal / stats.handshakes);
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * UPLINK METRICS - Thống kê tình trạng gửi log
+ * Xem include/uplink_metrics.h
+ */
+
+#include "uplink_metrics.h"
+#include "hal.h"
+
+const uint32_t UPLINK_LATENCY_BOUNDS_MS[UPLINK_LATENCY_BUCKETS - 1] = {
+  100, 250, 500, 1000, 2000, 4000, 8000, 16000, 32000
+};
+
+UplinkMetrics uplinkMetrics;
+
+// ==================== GHI NHẬN ====================
+void metricsRecordEnqueue(uint32_t queueDepth) {
+  // Gọi từ task ghi log (có thể nhiều task), còn lại chỉ task uplink ghi
+  __atomic_add_fetch(&uplinkMetrics.enqueued, 1, __ATOMIC_RELAXED);
+  if (queueDepth > uplinkMetrics.queueHighWater) {
+    uplinkMetrics.queueHighWater = queueDepth;
+  }
+}
+
+void metricsRecordHttp(int httpCode) {
+  if (httpCode <= 0) {
+    uplinkMetrics.httpError++;
+  } else if (httpCode < 300) {
+    uplinkMetrics.http2xx++;
+  } else if (httpCode < 400) {
+    uplinkMetrics.http3xx++;
+  } else if (httpCode < 500) {
+    uplinkMetrics.http4xx++;
+  } else {
+    uplinkMetrics.http5xx++;
+  }
+}
+
+void metricsRecordLatency(uint32_t ms) {
+  uint8_t bucket = 0;
+  while (bucket < UPLINK_LATENCY_BUCKETS - 1 && ms > UPLINK_LATENCY_BOUNDS_MS[bucket]) {
+    bucket++;
+  }
+  uplinkMetrics.latency[bucket]++;
+  uplinkMetrics.latencyCount++;
+  uplinkMetrics.latencySumMs += ms;
+  if (ms > uplinkMetrics.latencyMaxMs) uplinkMetrics.latencyMaxMs = ms;
+}
+
+// ==================== TRA CỨU ====================
+uint32_t metricsLatencyPercentile(uint8_t percent) {
+  uint32_t total = uplinkMetrics.latencyCount;
+  if (total == 0) return 0;
+
+  // Số mẫu cần đạt (làm tròn lên)
+  uint32_t target = (total * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < UPLINK_LATENCY_BUCKETS - 1; i++) {
+    seen += uplinkMetrics.latency[i];
+    if (seen >= target) return UPLINK_LATENCY_BOUNDS_MS[i];
+  }
+  return UINT32_MAX;
+}
+
+void metricsPrint(uint32_t queueDepth, uint32_t journalBacklog) {
+  const UplinkMetrics& m = uplinkMetrics;
+  HalConsole& console = halConsole();
+
+  console.printf("\n╔═══════════════ UPLINK STATS ═══════════════╗\n");
+  console.printf("║ Hàng đợi: %u (cao nhất %u) | Nhật ký: %u\n",
+                 (unsigned)queueDepth, (unsigned)m.queueHighWater, (unsigned)journalBacklog);
+  console.printf("║ Vào hàng đợi: %u | Bỏ (đầy): %u\n",
+                 (unsigned)m.enqueued, (unsigned)m.dropped);
+  console.printf("║ Đã gửi: %u | Ghi offline: %u | Gửi lại OK: %u | Lần thử lại: %u\n",
+                 (unsigned)m.delivered, (unsigned)m.spooled, (unsigned)m.replayed,
+                 (unsigned)m.retries);
+  console.printf("║ HTTP 2xx: %u | 3xx: %u | 4xx: %u | 5xx: %u | Lỗi: %u | Script lỗi: %u\n",
+                 (unsigned)m.http2xx, (unsigned)m.http3xx, (unsigned)m.http4xx,
+                 (unsigned)m.http5xx, (unsigned)m.httpError, (unsigned)m.scriptErrors);
+  if (m.discarded) console.printf("║ Bỏ (không gửi được): %u\n", (unsigned)m.discarded);
+
+  if (m.latencyCount > 0) {
+    console.printf("║ Độ trễ: TB %u ms | max %u ms | p50 <= %u | p95 <= %u\n",
+                   (unsigned)(m.latencySumMs / m.latencyCount), (unsigned)m.latencyMaxMs,
+                   (unsigned)metricsLatencyPercentile(50), (unsigned)metricsLatencyPercentile(95));
+    for (uint8_t i = 0; i < UPLINK_LATENCY_BUCKETS; i++) {
+      if (i < UPLINK_LATENCY_BUCKETS - 1) {
+        console.printf("║   <= %5u ms: %u\n", (unsigned)UPLINK_LATENCY_BOUNDS_MS[i],
+                       (unsigned)m.latency[i]);
+      } else {
+        console.printf("║    > %5u ms: %u\n", (unsigned)UPLINK_LATENCY_BOUNDS_MS[i - 1],
+                       (unsigned)m.latency[i]);
+      }
+    }
+  }
+  console.printf("╚════════════════════════════════════════════╝\n");
+}
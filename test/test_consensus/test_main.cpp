@@ -0,0 +1,138 @@
+/*
+ * TEST CONSENSUS - Kết luận xác thực vân tay nhiều mẫu
+ * ====================================================
+ *
+ * Chạy trên máy tính: pio test -e native -f test_consensus
+ *
+ * Gọi thẳng fingerConsensusStart / Sample / Check với kết quả fingerMatch()
+ * dựng sẵn (không qua AS608 giả) và giờ tự chọn.
+ */
+
+#include <unity.h>
+
+#include "finger_consensus.h"
+#include "finger_match.h"
+
+#define T0 10000
+
+static As608Result match(uint8_t code, uint16_t id, uint16_t score) {
+  As608Result r = { AS608_SEARCH, 1, code, id, score, nullptr, 1, 0, 0 };
+  return r;
+}
+
+static As608Result strong(uint16_t id) {
+  return match(FINGERPRINT_OK, id, 150);
+}
+
+// Khớp 1 ID dưới CONFIDENCE_THRESHOLD (fingerMatch trả NOTFOUND, giữ id / score)
+static As608Result weak(uint16_t id) {
+  return match(FINGERPRINT_NOTFOUND, id, CONFIDENCE_THRESHOLD - 10);
+}
+
+static As608Result miss() {
+  return match(FINGERPRINT_NOTFOUND, 0, 0);
+}
+
+void setUp() {
+  // Không còn phiên / lần chạm cũ của test trước
+  fingerConsensusCancel();
+  fingerConsensusLifted();
+}
+
+void tearDown() {}
+
+// ==================== TEST ====================
+void test_accept_on_first_sample() {
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_ACCEPT, fingerConsensusSample(strong(5), T0 + 300));
+  TEST_ASSERT_EQUAL_UINT16(5, fingerConsensusId());
+  TEST_ASSERT_EQUAL_UINT16(150, fingerConsensusScore());
+  TEST_ASSERT_FALSE(fingerConsensusActive());
+}
+
+// Mẫu trượt không còn là 1 lần sai: mẫu sau khớp -> chấp nhận
+void test_accept_after_miss() {
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING, fingerConsensusSample(miss(), T0 + 300));
+  TEST_ASSERT_FALSE(fingerConsensusDue(T0 + 300 + FINGER_CONSENSUS_RETRY_MS - 1));
+  TEST_ASSERT_TRUE(fingerConsensusDue(T0 + 300 + FINGER_CONSENSUS_RETRY_MS));
+
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_ACCEPT, fingerConsensusSample(strong(3), T0 + 700));
+  TEST_ASSERT_EQUAL_UINT16(3, fingerConsensusId());
+  TEST_ASSERT_EQUAL_UINT8(2, fingerConsensusSamples());
+}
+
+// Mẫu dưới ngưỡng không bao giờ mở cửa, dù mọi mẫu cùng khớp 1 ID
+void test_weak_samples_never_accept() {
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING, fingerConsensusSample(weak(7), T0 + 300));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING, fingerConsensusSample(weak(7), T0 + 700));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_REJECT, fingerConsensusSample(weak(7), T0 + 1100));
+
+  // Kể cả kết quả OK mà độ tin cậy dưới ngưỡng (không qua finger_match)
+  fingerConsensusLifted();
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0 + 5000));
+  for (uint8_t i = 1; i < FINGER_CONSENSUS_SAMPLES; i++) {
+    TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING,
+                      fingerConsensusSample(match(FINGERPRINT_OK, 7, CONFIDENCE_THRESHOLD - 1),
+                                            T0 + 5000 + i * 400));
+  }
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_REJECT,
+                    fingerConsensusSample(match(FINGERPRINT_OK, 7, CONFIDENCE_THRESHOLD - 1),
+                                          T0 + 6500));
+}
+
+void test_two_weak_different_ids_reject() {
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING, fingerConsensusSample(weak(7), T0 + 300));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING, fingerConsensusSample(weak(9), T0 + 700));
+  // Mẫu cuối cũng không đồng ý với ID nào -> hết số mẫu, tính 1 lần sai
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_REJECT, fingerConsensusSample(weak(11), T0 + 1100));
+  TEST_ASSERT_EQUAL_UINT8(FINGER_CONSENSUS_SAMPLES, fingerConsensusSamples());
+}
+
+// Hết thời gian mà chưa mẫu nào tìm xong (lỗi UART, ảnh hỏng) -> bỏ, không tính sai
+void test_budget_without_samples_drops() {
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING,
+                    fingerConsensusSample(match(FINGERPRINT_TIMEOUT, 0, 0), T0 + 1000));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING,
+                    fingerConsensusCheck(T0 + FINGER_CONSENSUS_BUDGET_MS - 1));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_DROP, fingerConsensusCheck(T0 + FINGER_CONSENSUS_BUDGET_MS));
+  TEST_ASSERT_FALSE(fingerConsensusActive());
+}
+
+void test_budget_with_samples_rejects() {
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING, fingerConsensusSample(miss(), T0 + 300));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING,
+                    fingerConsensusCheck(T0 + FINGER_CONSENSUS_BUDGET_MS - 1));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_REJECT, fingerConsensusCheck(T0 + FINGER_CONSENSUS_BUDGET_MS));
+}
+
+// Ngón tay để yên sau khi kết luận: không mở phiên mới cho tới khi nhấc tay
+void test_held_finger_opens_no_new_session() {
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0));
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_ACCEPT, fingerConsensusSample(strong(1), T0 + 300));
+
+  TEST_ASSERT_FALSE(fingerConsensusStart(T0 + 500));
+  TEST_ASSERT_FALSE(fingerConsensusStart(T0 + 5000));
+  TEST_ASSERT_FALSE(fingerConsensusActive());
+  TEST_ASSERT_EQUAL(FINGER_VERDICT_PENDING, fingerConsensusSample(miss(), T0 + 5100));
+
+  fingerConsensusLifted();
+  TEST_ASSERT_TRUE(fingerConsensusStart(T0 + 6000));
+  TEST_ASSERT_TRUE(fingerConsensusActive());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_accept_on_first_sample);
+  RUN_TEST(test_accept_after_miss);
+  RUN_TEST(test_weak_samples_never_accept);
+  RUN_TEST(test_two_weak_different_ids_reject);
+  RUN_TEST(test_budget_without_samples_drops);
+  RUN_TEST(test_budget_with_samples_rejects);
+  RUN_TEST(test_held_finger_opens_no_new_session);
+  return UNITY_END();
+}
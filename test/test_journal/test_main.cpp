@@ -0,0 +1,213 @@
+/*
+ * TEST JOURNAL - Nhật ký offline trên flash giả dạng file
+ * =======================================================
+ *
+ * Chạy trên máy tính: pio test -e native -f test_journal
+ *
+ * Flash giả ghi vào 1 file tạm (giữ nguyên qua "khởi động lại" =
+ * journalBegin lần nữa) và làm như NOR flash thật: ghi chỉ đổi bit 1 -> 0,
+ * xóa cả sector về 0xFF. Có thể "mất điện" giữa lần ghi kế tiếp (chỉ ghi
+ * nửa đầu dữ liệu) để thử khôi phục ô ghi dở.
+ *
+ * Mỗi sự kiện mang số thứ tự riêng trong LogEvent::seq để kiểm tra thứ tự.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "journal.h"
+
+// ==================== FLASH GIẢ (FILE) ====================
+static FILE* flashFile = nullptr;
+static uint32_t flashSize = 0;
+static bool tearNextWrite = false;   // Lần ghi kế tiếp chỉ ghi được nửa đầu
+static uint32_t erases = 0;
+
+static bool fileRead(uint32_t addr, void* buf, size_t len) {
+  if (addr + len > flashSize) return false;
+  fseek(flashFile, addr, SEEK_SET);
+  return fread(buf, 1, len, flashFile) == len;
+}
+
+static bool fileWrite(uint32_t addr, const void* buf, size_t len) {
+  uint8_t cur[256];
+  if (addr + len > flashSize) return false;
+  if (tearNextWrite) {
+    tearNextWrite = false;
+    len /= 2;
+  }
+
+  const uint8_t* src = (const uint8_t*)buf;
+  while (len > 0) {
+    size_t n = len < sizeof(cur) ? len : sizeof(cur);
+    if (!fileRead(addr, cur, n)) return false;
+    for (size_t i = 0; i < n; i++) cur[i] &= src[i];
+    fseek(flashFile, addr, SEEK_SET);
+    if (fwrite(cur, 1, n, flashFile) != n) return false;
+    addr += n;
+    src += n;
+    len -= n;
+  }
+  return fflush(flashFile) == 0;
+}
+
+static bool fileErase(uint32_t addr) {
+  static uint8_t blank[JOURNAL_SECTOR_SIZE];
+  memset(blank, 0xFF, sizeof(blank));
+  fseek(flashFile, addr, SEEK_SET);
+  erases++;
+  return fwrite(blank, 1, sizeof(blank), flashFile) == sizeof(blank) && fflush(flashFile) == 0;
+}
+
+// Flash mới xóa trắng gồm sectors sector
+static void flashCreate(uint32_t sectors) {
+  if (flashFile) fclose(flashFile);
+  flashFile = tmpfile();
+  flashSize = sectors * JOURNAL_SECTOR_SIZE;
+  for (uint32_t s = 0; s < sectors; s++) fileErase(s * JOURNAL_SECTOR_SIZE);
+  erases = 0;
+}
+
+// "Khởi động lại": đọc lại trạng thái từ file
+static bool mount() {
+  JournalFlash flash = { flashSize, fileRead, fileWrite, fileErase };
+  return journalBegin(flash);
+}
+
+// ==================== TIỆN ÍCH ====================
+static uint32_t nextId = 0;      // Số thứ tự sự kiện ghi tiếp theo
+static uint32_t expectId = 0;    // Số thứ tự sự kiện cũ nhất còn chờ
+
+static void append(uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    LogEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.seq = nextId++;
+    TEST_ASSERT_TRUE(journalAppend(ev));
+  }
+}
+
+// Đọc và đánh dấu đã gửi n sự kiện, kiểm tra đúng thứ tự ghi
+static void consume(uint32_t n) {
+  LogEvent evs[UPLINK_BATCH_MAX];
+  while (n > 0) {
+    uint8_t want = n < UPLINK_BATCH_MAX ? n : UPLINK_BATCH_MAX;
+    uint8_t got = journalPeek(evs, want);
+    TEST_ASSERT_EQUAL_UINT8(want, got);
+    for (uint8_t i = 0; i < got; i++) TEST_ASSERT_EQUAL_UINT32(expectId++, evs[i].seq);
+    journalConsume(got);
+    n -= got;
+  }
+}
+
+static uint32_t slotsPerSector() {
+  return journalCapacity() / (flashSize / JOURNAL_SECTOR_SIZE);
+}
+
+void setUp() {
+  nextId = 0;
+  expectId = 0;
+  tearNextWrite = false;
+}
+
+void tearDown() {
+  if (flashFile) fclose(flashFile);
+  flashFile = nullptr;
+}
+
+// ==================== TEST ====================
+// Ghi / gửi xen kẽ qua nhiều vòng sector, khởi động lại giữa chừng
+void test_wraparound_across_sectors() {
+  flashCreate(3);
+  TEST_ASSERT_TRUE(mount());
+  uint32_t perSector = slotsPerSector();
+
+  // Luôn giữ ~1.5 sector chờ gửi -> head / tail lần lượt vượt qua cả 3 sector
+  for (uint32_t round = 0; round < 4 * 3; round++) {
+    append(perSector / 2 + 7);
+    if (journalCount() > perSector + perSector / 2) consume(perSector / 2 + 7);
+    if (round % 5 == 4) {
+      uint32_t before = journalCount();
+      TEST_ASSERT_TRUE(mount());
+      TEST_ASSERT_EQUAL_UINT32(before, journalCount());
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, journalLost());
+  TEST_ASSERT_GREATER_THAN(3, erases);
+
+  consume(journalCount());
+  TEST_ASSERT_EQUAL_UINT32(nextId, expectId);
+  TEST_ASSERT_EQUAL_UINT32(0, journalCount());
+}
+
+// Mất điện khi đang ghi ô cuối -> CRC sai, ô bị bỏ qua sau khi khởi động lại
+void test_torn_last_slot_is_skipped() {
+  flashCreate(2);
+  TEST_ASSERT_TRUE(mount());
+  append(5);
+
+  LogEvent ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.seq = 1000;
+  tearNextWrite = true;
+  journalAppend(ev);
+
+  TEST_ASSERT_TRUE(mount());
+  TEST_ASSERT_EQUAL_UINT32(5, journalCount());
+
+  // Ghi tiếp sau ô hỏng, không ghi đè lên nó
+  append(2);
+  TEST_ASSERT_TRUE(mount());
+  TEST_ASSERT_EQUAL_UINT32(7, journalCount());
+  consume(7);
+  TEST_ASSERT_EQUAL_UINT32(0, journalCount());
+}
+
+// Ô đã đánh dấu gửi không bị gửi lại sau khi khởi động lại
+void test_consumed_slots_survive_remount() {
+  flashCreate(2);
+  TEST_ASSERT_TRUE(mount());
+  append(10);
+  consume(4);
+
+  TEST_ASSERT_TRUE(mount());
+  TEST_ASSERT_EQUAL_UINT32(6, journalCount());
+  consume(6);
+
+  TEST_ASSERT_TRUE(mount());
+  TEST_ASSERT_EQUAL_UINT32(0, journalCount());
+  LogEvent evs[1];
+  TEST_ASSERT_EQUAL_UINT8(0, journalPeek(evs, 1));
+}
+
+// Đầy: bỏ cả sector cũ nhất, phần còn lại vẫn đúng thứ tự
+void test_full_journal_drops_oldest_sector() {
+  flashCreate(2);
+  TEST_ASSERT_TRUE(mount());
+  uint32_t perSector = slotsPerSector();
+
+  append(journalCapacity());
+  TEST_ASSERT_EQUAL_UINT32(journalCapacity(), journalCount());
+  TEST_ASSERT_EQUAL_UINT32(0, journalLost());
+
+  append(1);
+  TEST_ASSERT_EQUAL_UINT32(perSector, journalLost());
+  TEST_ASSERT_EQUAL_UINT32(perSector + 1, journalCount());
+
+  expectId = perSector;
+  TEST_ASSERT_TRUE(mount());
+  TEST_ASSERT_EQUAL_UINT32(perSector + 1, journalCount());
+  consume(perSector + 1);
+  TEST_ASSERT_EQUAL_UINT32(nextId, expectId);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_wraparound_across_sectors);
+  RUN_TEST(test_torn_last_slot_is_skipped);
+  RUN_TEST(test_consumed_slots_survive_remount);
+  RUN_TEST(test_full_journal_drops_oldest_sector);
+  return UNITY_END();
+}
@@ -0,0 +1,87 @@
+/*
+ * TEST LOOP PERIOD - Không vòng loop() nào chặn quá giới hạn
+ * =========================================================
+ *
+ * Chạy trên máy tính: pio test -e native -f test_loop_period
+ *
+ * Chạy setup() / loop() thật của main.cpp trên thiết bị giả (hal_native.cpp)
+ * theo kịch bản: mở cửa bằng mật khẩu, sai mật khẩu, đổi chế độ, menu
+ * Admin, đổi mật khẩu, đăng ký / xóa vân tay, cảm biến không trả lời, mất
+ * mạng, quá nhiệt... Các chờ đợi kiểu delay() đều làm đồng hồ mô phỏng
+ * chạy, nên vòng nào chặn sẽ hiện ra trong loopMaxUs của checkLoopBudget()
+ * (đo trước phần nghỉ cuối vòng).
+ */
+
+#include <unity.h>
+
+#include "hal.h"
+
+// LOOP_BUDGET_MS (main.cpp): "menu không chặn" phải giữ dưới mức này
+#define LOOP_TEST_BOUND_MS 10
+
+extern unsigned long loopMaxUs;
+extern unsigned long loopOverBudget;
+
+static const char* const script[] = {
+  "wait 3000",
+  // Mở cửa bằng mật khẩu, sai mật khẩu, xóa, đổi chế độ bảo mật
+  "key 1234#", "wait 6000",
+  "key 9999#", "wait 2500",
+  "key 12C", "wait 300",
+  "key A", "wait 2500",
+  "key A", "wait 2500",
+  // Xem cảm biến / trạng thái gửi log
+  "key B", "wait 500", "key B", "wait 3500",
+  // Đổi mật khẩu User (MK Admin rồi D), mở cửa bằng mật khẩu mới; chọn loại -> hết giờ
+  "key 1234D", "wait 300", "key 2", "wait 300", "key 5678#", "wait 2500",
+  "key 5678#", "wait 6000",
+  "key 1234D", "wait 6000",
+  // Menu Admin: đăng ký vân tay ID 15, xem số vân tay, xóa ID 15, nhập ID -> hết giờ,
+  // hủy xóa tất cả, thoát
+  "key 1234*", "wait 500",
+  "key 1", "wait 300", "key 15#", "wait 500",
+  "finger 3", "wait 600", "finger off", "wait 2500",
+  "finger 3", "wait 800", "finger off", "wait 2500",
+  "key 4", "wait 3500",
+  "key 2", "wait 300", "key 15#", "wait 2500",
+  "key 1", "wait 11000",
+  "key 3", "wait 300", "key *", "wait 1500",
+  "key *", "wait 1500",
+  // Vân tay: khớp, không khớp, tay ướt (độ tin cậy thấp), cảm biến không trả lời
+  "finger 1", "wait 1500", "finger off", "wait 6000",
+  "finger 7", "wait 3000", "finger off", "wait 2000",
+  "finger 1 30", "wait 1500", "finger off", "wait 2000",
+  "finger mute 5", "finger 1", "wait 4000", "finger off", "wait 6000",
+  // Mất mạng -> nhật ký offline, có mạng lại -> gửi lại
+  "http 0", "key 1234#", "wait 6000",
+  "http 200", "wait 8000",
+  // Tự động hóa: tối + âm thanh, quá nhiệt rồi hạ nhiệt
+  "light 3000", "sound", "wait 3000", "light 1000",
+  "temp 60 50", "wait 5000", "temp 28 60", "wait 5000",
+  // Lệnh Serial chẩn đoán
+  "serial stats", "wait 200",
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_no_iteration_blocks() {
+  halSimSetup();
+  // setup() được phép chặn (kết nối WiFi), chỉ đo các vòng loop()
+  loopMaxUs = 0;
+  loopOverBudget = 0;
+
+  uint32_t startMs = halMillis();
+  for (const char* line : script) halSimCommand(line);
+
+  // Kịch bản đã thật sự chạy hết (vài nghìn vòng loop())
+  TEST_ASSERT_GREATER_THAN(100000, halMillis() - startMs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(LOOP_TEST_BOUND_MS * 1000UL, loopMaxUs);
+  TEST_ASSERT_EQUAL_UINT32(0, loopOverBudget);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_no_iteration_blocks);
+  return UNITY_END();
+}
@@ -0,0 +1,130 @@
+/*
+ * TEST RING - Thử tải SpscRing / MpscRing bằng nhiều thread
+ * =========================================================
+ *
+ * Chạy trên máy tính: pio test -e native -f test_ring
+ *
+ * Thread ghi đẩy liên tục (ring đầy -> nhường CPU rồi thử lại), 1 thread
+ * đọc lấy ra tới khi đủ số phần tử. Ring nhỏ để head/tail quay vòng rất
+ * nhiều lần. Mỗi phần tử mang (thread ghi, số thứ tự, mã kiểm tra):
+ *   - số thứ tự của từng thread ghi phải tăng đúng 1 -> không mất, không
+ *     trùng, giữ thứ tự của từng thread ghi
+ *   - mã kiểm tra khớp -> không đọc phải ô ghi dở
+ */
+
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ring_buffer.h"
+
+// ==================== CẤU HÌNH ====================
+#define RING_TEST_LEN 16
+#define RING_TEST_PRODUCERS 4
+#define RING_TEST_ITEMS 200000     // Mỗi thread ghi
+
+struct Item {
+  uint32_t producer;
+  uint32_t seq;
+  uint32_t check;
+};
+
+static uint32_t checkOf(uint32_t producer, uint32_t seq) {
+  return (seq * 2654435761u) ^ (producer << 24) ^ 0xA5A5A5A5u;
+}
+
+// Thread đọc: kiểm tra từng phần tử theo số thứ tự mong đợi của thread ghi
+struct Checker {
+  uint32_t next[RING_TEST_PRODUCERS] = {};
+  uint32_t received = 0;
+  uint32_t badProducer = 0;
+  uint32_t outOfOrder = 0;
+  uint32_t torn = 0;
+
+  void take(const Item& item) {
+    received++;
+    if (item.producer >= RING_TEST_PRODUCERS) {
+      badProducer++;
+      return;
+    }
+    if (item.check != checkOf(item.producer, item.seq)) torn++;
+    if (item.seq != next[item.producer]) outOfOrder++;
+    next[item.producer] = item.seq + 1;
+  }
+};
+
+template <typename Ring>
+static void produce(Ring& ring, uint32_t producer, std::atomic<bool>& go) {
+  while (!go.load()) std::this_thread::yield();
+  for (uint32_t seq = 0; seq < RING_TEST_ITEMS; seq++) {
+    Item item = { producer, seq, checkOf(producer, seq) };
+    while (!ring.push(item)) std::this_thread::yield();
+  }
+}
+
+template <typename Ring>
+static void consume(Ring& ring, uint32_t total, Checker& checker) {
+  Item item;
+  while (checker.received < total) {
+    if (ring.pop(item)) {
+      checker.take(item);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+template <typename Ring>
+static void runStress(Ring& ring, uint32_t producers, Checker& checker) {
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+  for (uint32_t p = 0; p < producers; p++) {
+    threads.emplace_back(produce<Ring>, std::ref(ring), p, std::ref(go));
+  }
+  std::thread reader(consume<Ring>, std::ref(ring), producers * RING_TEST_ITEMS,
+                     std::ref(checker));
+  go.store(true);
+  for (auto& t : threads) t.join();
+  reader.join();
+}
+
+static void assertComplete(const Checker& checker, uint32_t producers) {
+  TEST_ASSERT_EQUAL_UINT32(0, checker.badProducer);
+  TEST_ASSERT_EQUAL_UINT32(0, checker.torn);
+  TEST_ASSERT_EQUAL_UINT32(0, checker.outOfOrder);
+  TEST_ASSERT_EQUAL_UINT32(producers * RING_TEST_ITEMS, checker.received);
+  for (uint32_t p = 0; p < producers; p++) {
+    TEST_ASSERT_EQUAL_UINT32(RING_TEST_ITEMS, checker.next[p]);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ==================== TEST ====================
+void test_spsc_stress() {
+  static SpscRing<Item, RING_TEST_LEN> ring;
+  static Checker checker;
+  runStress(ring, 1, checker);
+
+  assertComplete(checker, 1);
+  TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+}
+
+void test_mpsc_stress() {
+  static MpscRing<Item, RING_TEST_LEN> ring;
+  static Checker checker;
+  runStress(ring, RING_TEST_PRODUCERS, checker);
+
+  assertComplete(checker, RING_TEST_PRODUCERS);
+  TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_spsc_stress);
+  RUN_TEST(test_mpsc_stress);
+  return UNITY_END();
+}
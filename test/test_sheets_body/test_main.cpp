@@ -0,0 +1,130 @@
+/*
+ * TEST SHEETS BODY - Body của uplinkBuildBody qua GoogleAppsScript.js thật
+ * ========================================================================
+ *
+ * Chạy trên máy tính (cần node): pio test -e native -f test_sheets_body
+ *
+ * Ghi body JSON của 1 lô ra file tạm rồi chạy tools/sheets_stub/server.js
+ * --post (doPost của GoogleAppsScript.js trên sheet giả, không mở cổng):
+ *   - lần 1: script trả success, ghi đủ số hàng bằng đúng 1 lần setValues,
+ *     các cột của hàng cuối đúng như firmware gửi
+ *   - lần 2 (gửi lại cùng lô): cả lô là bản ghi trùng, không ghi thêm
+ * Không có node -> bỏ qua test.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "event_clock.h"
+#include "uplink.h"
+
+#define TEST_BOOT_ID 0x8f3a12c0u
+#define TEST_EPOCH 1760680000u
+
+static uint32_t fakeMillis() {
+  return 60000;
+}
+
+static uint32_t fakeEpoch() {
+  return TEST_EPOCH;
+}
+
+// Thư mục gốc repo (__FILE__ = .../test/test_sheets_body/test_main.cpp)
+static void repoRoot(char* out, size_t len) {
+  snprintf(out, len, "%s", __FILE__);
+  char* cut = strstr(out, "test/test_sheets_body/");
+  if (cut) *cut = '\0';
+}
+
+// Chạy server.js --post file 2 lần, chép toàn bộ stdout vào out
+static int runStub(const char* bodyPath, char* out, size_t len) {
+  char root[256];
+  char cmd[768];
+  repoRoot(root, sizeof(root));
+  snprintf(cmd, sizeof(cmd), "node \"%stools/sheets_stub/server.js\" --post \"%s\" --post \"%s\" 2>&1",
+           root, bodyPath, bodyPath);
+
+  FILE* p = popen(cmd, "r");
+  if (!p) return -1;
+  size_t n = fread(out, 1, len - 1, p);
+  out[n] = '\0';
+  return pclose(p);
+}
+
+static UplinkBatch makeBatch() {
+  UplinkBatch batch;
+  batch.count = 0;
+  batch.firstMs = 0;
+
+  batch.events[batch.count++] = logEventMake(LOG_DOOR_OPEN, LOG_BY_PASSWORD, LOG_USER_ADMIN,
+                                             LOG_SUCCESS, 0, 28.5f, 65.0f);
+  batch.events[batch.count++] = logEventMake(LOG_SYSTEM_LOCKED, LOG_BY_PASSWORD,
+                                             LOG_USER_UNKNOWN, LOG_LOCKED_3_ATTEMPTS, 0, 28.5f,
+                                             65.0f);
+  // Chuỗi lỗi đã gộp (log_aggregate.h): 4 lần trong 12 giây
+  LogEvent agg = logEventMake(LOG_DOOR_OPEN, LOG_BY_FINGERPRINT, LOG_USER_FINGER, LOG_FAILED, 5,
+                              28.5f, 65.0f);
+  agg.count = 4;
+  agg.spanMs = 12000;
+  batch.events[batch.count++] = agg;
+
+  for (uint8_t i = 0; i < batch.count; i++) eventClockStamp(batch.events[i]);
+  return batch;
+}
+
+void setUp() {
+  eventClockBegin(TEST_BOOT_ID, fakeMillis, fakeEpoch);
+}
+
+void tearDown() {}
+
+// ==================== TEST ====================
+void test_body_rows_written_by_script() {
+  UplinkBatch batch = makeBatch();
+  char body[UPLINK_BODY_LEN];
+  int len = uplinkBuildBody(batch, body, sizeof(body));
+  TEST_ASSERT_GREATER_THAN(0, len);
+
+  char path[] = "/tmp/sheets_bodyXXXXXX";
+  int fd = mkstemp(path);
+  TEST_ASSERT_TRUE(fd >= 0);
+  TEST_ASSERT_EQUAL(len, write(fd, body, (size_t)len));
+  close(fd);
+
+  char out[4096];
+  int status = runStub(path, out, sizeof(out));
+  unlink(path);
+  if (status != 0 && strstr(out, "not found")) TEST_IGNORE_MESSAGE("Không có node - bỏ qua");
+  TEST_ASSERT_EQUAL_MESSAGE(0, status, out);
+
+  // 3 dòng: kết quả lần 1, kết quả lần 2, thống kê sheet giả
+  char* first = out;
+  char* second = strchr(first, '\n');
+  TEST_ASSERT_NOT_NULL(second);
+  *second++ = '\0';
+  char* stats = strchr(second, '\n');
+  TEST_ASSERT_NOT_NULL(stats);
+  *stats++ = '\0';
+
+  TEST_ASSERT_NOT_NULL(strstr(first, "\"status\":\"success\""));
+  TEST_ASSERT_NOT_NULL(strstr(first, "\"rows\":3,\"duplicates\":0"));
+  TEST_ASSERT_NOT_NULL(strstr(second, "\"status\":\"success\""));
+  TEST_ASSERT_NOT_NULL(strstr(second, "\"rows\":0,\"duplicates\":3"));
+
+  // Cả lô ghi bằng đúng 1 lần setValues, không appendRow
+  TEST_ASSERT_NOT_NULL(strstr(stats, "\"rows\":3,\"appendRow\":0,\"setValues\":1"));
+
+  // Hàng cuối: Event..Humidity, Boot, Seq, Count; First khác rỗng vì count > 1
+  TEST_ASSERT_NOT_NULL(strstr(stats, "\"DOOR_OPEN\",\"FINGERPRINT\",\"Finger_ID_5\",\"FAILED\","
+                                     "\"28.5°C\",\"65%\",\"8f3a12c0\",3,4,\"20"));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_body_rows_written_by_script);
+  return UNITY_END();
+}
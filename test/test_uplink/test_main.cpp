@@ -0,0 +1,211 @@
+/*
+ * TEST UPLINK - Gom lô, gửi và ghi nhật ký offline
+ * ================================================
+ *
+ * Chạy trên máy tính: pio test -e native -f test_uplink
+ *
+ * Dùng nhánh !ARDUINO của uplink.cpp (gom lô trong uplinkLog, gửi trong
+ * uplinkService) với transport giả: đếm số POST, số hàng trong body và trả
+ * về mã HTTP / trạng thái script do từng test đặt. Nhật ký offline là flash
+ * giả trong RAM của hal_native.cpp.
+ */
+
+#include <unity.h>
+
+#include <string.h>
+
+#include "event_clock.h"
+#include "hal.h"
+#include "journal.h"
+#include "uplink.h"
+#include "uplink_metrics.h"
+
+// ==================== TRANSPORT GIẢ ====================
+static int posts = 0;
+static uint32_t lastRows = 0;
+static int replyCode = 200;
+static bool replyAccepted = true;
+
+// Số hàng trong body {"rows":[[...],[...]]}
+static uint32_t countRows(const char* body, size_t len) {
+  uint32_t rows = 0;
+  for (size_t i = 1; i < len; i++) {
+    if (body[i] == '[' && body[i - 1] != ':') rows++;
+  }
+  return rows;
+}
+
+static int stubTransport(const char*, const char* body, size_t len, bool* accepted) {
+  posts++;
+  lastRows = countRows(body, len);
+  *accepted = replyAccepted;
+  return replyCode;
+}
+
+// ==================== TIỆN ÍCH ====================
+static uint32_t nowMs = 0;
+
+static uint32_t testMillis() {
+  return nowMs;
+}
+
+static void logEvents(uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    LogEvent ev = logEventMake(LOG_DOOR_OPEN, LOG_BY_PASSWORD, LOG_USER_ADMIN, LOG_SUCCESS, 0,
+                               28.5f, 65.0f);
+    eventClockStamp(ev);
+    uplinkLog(ev);
+  }
+}
+
+void setUp() {
+  posts = 0;
+  lastRows = 0;
+  replyCode = 200;
+  replyAccepted = true;
+  nowMs = 1000;
+  memset(&uplinkMetrics, 0, sizeof(uplinkMetrics));
+
+  eventClockBegin(1, testMillis, nullptr);
+  halJournalBegin();
+  uplinkBegin("http://stub/exec", stubTransport);
+  uplinkService(nowMs);
+}
+
+void tearDown() {}
+
+// ==================== TEST ====================
+// Đủ UPLINK_BATCH_MAX sự kiện -> gửi ngay 1 POST, không chờ cửa sổ gom lô
+void test_full_batch_is_one_post() {
+  logEvents(UPLINK_BATCH_MAX);
+
+  TEST_ASSERT_EQUAL(1, posts);
+  TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX, lastRows);
+  TEST_ASSERT_EQUAL_UINT32(0, uplinkPending());
+  TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX, uplinkMetrics.delivered);
+  TEST_ASSERT_EQUAL_UINT32(0, journalCount());
+}
+
+// Lô chưa đủ: giữ tới khi sự kiện đầu đã chờ UPLINK_BATCH_WINDOW_MS
+void test_partial_batch_sent_by_window() {
+  logEvents(3);
+  uplinkService(nowMs + UPLINK_BATCH_WINDOW_MS - 1);
+  TEST_ASSERT_EQUAL(0, posts);
+  TEST_ASSERT_EQUAL_UINT32(3, uplinkPending());
+  TEST_ASSERT_TRUE(uplinkBusy());
+
+  uplinkService(nowMs + UPLINK_BATCH_WINDOW_MS);
+  TEST_ASSERT_EQUAL(1, posts);
+  TEST_ASSERT_EQUAL_UINT32(3, lastRows);
+  TEST_ASSERT_EQUAL_UINT32(0, uplinkPending());
+  TEST_ASSERT_FALSE(uplinkBusy());
+  TEST_ASSERT_EQUAL_UINT32(3, uplinkMetrics.delivered);
+}
+
+// POST lỗi -> cả lô vào nhật ký offline, không tính là đã gửi
+void test_failed_post_goes_to_journal() {
+  replyCode = 500;
+  logEvents(UPLINK_BATCH_MAX);
+
+  TEST_ASSERT_EQUAL(1, posts);
+  TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX, journalCount());
+  TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX, uplinkMetrics.spooled);
+  TEST_ASSERT_EQUAL_UINT32(0, uplinkMetrics.delivered);
+  TEST_ASSERT_EQUAL_UINT32(1, uplinkMetrics.http5xx);
+}
+
+// HTTP 200 nhưng doPost trả {"status":"error"} -> cũng vào nhật ký
+void test_script_error_goes_to_journal() {
+  replyAccepted = false;
+  logEvents(2);
+  uplinkService(nowMs + UPLINK_BATCH_WINDOW_MS);
+
+  TEST_ASSERT_EQUAL(1, posts);
+  TEST_ASSERT_EQUAL_UINT32(2, journalCount());
+  TEST_ASSERT_EQUAL_UINT32(1, uplinkMetrics.scriptErrors);
+  TEST_ASSERT_EQUAL_UINT32(0, uplinkMetrics.delivered);
+}
+
+// Nhật ký chỉ được gửi lại sau UPLINK_RETRY_MS, không phải mỗi lần gọi
+void test_replay_waits_retry_interval() {
+  replyCode = 0;
+  logEvents(UPLINK_BATCH_MAX);
+  TEST_ASSERT_EQUAL(1, posts);
+
+  replyCode = 200;
+  for (uint32_t t = 1; t < UPLINK_RETRY_MS; t += 10) uplinkService(nowMs + t);
+  TEST_ASSERT_EQUAL(1, posts);
+  TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX, journalCount());
+  // Hàng đợi rỗng nhưng nhật ký còn chờ -> vẫn bận (không ngủ nhẹ)
+  TEST_ASSERT_EQUAL_UINT32(0, uplinkPending());
+  TEST_ASSERT_TRUE(uplinkBusy());
+
+  uplinkService(nowMs + UPLINK_RETRY_MS);
+  TEST_ASSERT_EQUAL(2, posts);
+  TEST_ASSERT_EQUAL_UINT32(0, journalCount());
+  TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX, uplinkMetrics.replayed);
+  TEST_ASSERT_FALSE(uplinkBusy());
+}
+
+// Lô đầu nhật ký bị 4xx khi gửi lại -> bỏ lô, các lô sau vẫn được gửi
+void test_replay_discards_rejected_batch() {
+  replyCode = 0;
+  logEvents(UPLINK_BATCH_MAX);
+  logEvents(UPLINK_BATCH_MAX);
+  TEST_ASSERT_EQUAL_UINT32(2 * UPLINK_BATCH_MAX, journalCount());
+
+  replyCode = 404;
+  uplinkService(nowMs + UPLINK_RETRY_MS);
+  // Lô 1 bị bỏ, lô 2 cũng 404 -> bỏ nốt, nhật ký không kẹt
+  TEST_ASSERT_EQUAL(4, posts);
+  TEST_ASSERT_EQUAL_UINT32(0, journalCount());
+  TEST_ASSERT_EQUAL_UINT32(2 * UPLINK_BATCH_MAX, uplinkMetrics.discarded);
+  TEST_ASSERT_EQUAL_UINT32(0, uplinkMetrics.replayed);
+
+  // Gửi thẳng bị 4xx cũng bỏ luôn, không ghi nhật ký
+  logEvents(UPLINK_BATCH_MAX);
+  TEST_ASSERT_EQUAL_UINT32(0, journalCount());
+  TEST_ASSERT_EQUAL_UINT32(3 * UPLINK_BATCH_MAX, uplinkMetrics.discarded);
+}
+
+// Script báo lỗi: thử lại UPLINK_SCRIPT_ERROR_MAX lần rồi bỏ lô đầu
+void test_replay_discards_after_script_errors() {
+  replyCode = 0;
+  logEvents(UPLINK_BATCH_MAX);
+  logEvents(2);
+  uplinkService(nowMs + UPLINK_BATCH_WINDOW_MS);
+  TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX + 2, journalCount());
+
+  replyCode = 200;
+  replyAccepted = false;
+  uint32_t t = nowMs + UPLINK_BATCH_WINDOW_MS;
+  for (int i = 1; i < UPLINK_SCRIPT_ERROR_MAX; i++) {
+    t += UPLINK_RETRY_MS;
+    uplinkService(t);
+    TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX + 2, journalCount());
+  }
+
+  // Lần thứ UPLINK_SCRIPT_ERROR_MAX: bỏ lô đầu, lô sau được thử ngay (lần 1)
+  t += UPLINK_RETRY_MS;
+  uplinkService(t);
+  TEST_ASSERT_EQUAL_UINT32(2, journalCount());
+  TEST_ASSERT_EQUAL_UINT32(UPLINK_BATCH_MAX, uplinkMetrics.discarded);
+
+  // Script ghi được lại -> lô sau gửi bình thường
+  replyAccepted = true;
+  uplinkService(t + UPLINK_RETRY_MS);
+  TEST_ASSERT_EQUAL_UINT32(0, journalCount());
+  TEST_ASSERT_EQUAL_UINT32(2, uplinkMetrics.replayed);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_full_batch_is_one_post);
+  RUN_TEST(test_partial_batch_sent_by_window);
+  RUN_TEST(test_failed_post_goes_to_journal);
+  RUN_TEST(test_script_error_goes_to_journal);
+  RUN_TEST(test_replay_waits_retry_interval);
+  RUN_TEST(test_replay_discards_rejected_batch);
+  RUN_TEST(test_replay_discards_after_script_errors);
+  return UNITY_END();
+}
@@ -0,0 +1,562 @@
+/*
+ * LOADGEN - Giả lập nhiều cửa gửi log để đo tải đường uplink
+ * ==========================================================
+ *
+ * Biên dịch nguyên mã uplink/journal/log_event của firmware cho máy tính
+ * (nhánh !ARDUINO: gom lô đồng bộ qua uplinkService); log của các module
+ * đó đi qua halConsole() (hal.h) của loadgen ra stdout. Mỗi cửa là một
+ * process riêng (module uplink là singleton như trên ESP32), có nhật ký
+ * offline trên flash giả trong RAM và transport HTTP/1.1 keep-alive (hoặc
+ * mở kết nối mới cho mỗi request với --new-connection, để so sánh).
+ *
+ * Độ trễ mỗi sự kiện = lúc server xác nhận - thời điểm sự kiện xảy ra
+ * (theo lịch phát), kể cả thời gian chờ trong nhật ký khi server lỗi.
+ *
+ * Biên dịch (từ thư mục gốc repo):
+ *   g++ -std=gnu++17 -O2 -Iinclude tools/loadgen/loadgen.cpp \
+ *       src/uplink.cpp src/journal.cpp src/log_event.cpp src/uplink_metrics.cpp \
+ *       src/event_clock.cpp src/hal.cpp \
+ *       -o loadgen
+ *
+ * Chạy (cần tools/sheets_stub/server.js đang chạy):
+ *   ./loadgen --url http://127.0.0.1:8080/exec --doors 20 --rate 2 --duration 30
+ *
+ * Tham số:
+ *   --url <url>          Endpoint (chỉ http://)
+ *   --doors <n>          Số cửa giả lập (mặc định 4)
+ *   --rate <ev/s>        Số sự kiện mỗi giây mỗi cửa, phân bố Poisson (mặc định 1)
+ *   --duration <s>       Thời gian phát sự kiện (mặc định 30)
+ *   --drain <s>          Thời gian tối đa chờ gửi hết sau khi ngừng phát (mặc định 30)
+ *   --accept-redirect    Coi 302 là thành công, không GET Location
+ *                        (giống firmware khi đã tin redirect, uplink_conn.h)
+ *   --new-connection     Gửi "Connection: close" và đóng kết nối sau mỗi
+ *                        request (như HTTPClient cũ, mỗi lô 1 lần bắt tay)
+ *   --verbose            Giữ log của module uplink
+ */
+
+#include "uplink.h"
+#include "journal.h"
+#include "uplink_metrics.h"
+#include "event_clock.h"
+#include "hal.h"
+
+#include <arpa/inet.h>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+// ==================== CẤU HÌNH ====================
+#define LOADGEN_JOURNAL_SECTORS 64      // 256KB flash giả mỗi cửa
+#define LOADGEN_TIMEOUT_MS 8000         // Bằng timeout HTTP của firmware
+#define LOADGEN_TICK_US 1000
+
+struct Options {
+  std::string url;
+  int doors = 4;
+  double rate = 1.0;
+  int durationS = 30;
+  int drainS = 30;
+  bool acceptRedirect = false;
+  bool newConnection = false;
+  bool verbose = false;
+};
+
+static Options opt;
+
+// ==================== ĐỒNG HỒ ====================
+static uint64_t monoUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static uint64_t startUs = 0;
+
+static uint32_t nowMs() {
+  return (uint32_t)((monoUs() - startUs) / 1000);
+}
+
+static uint32_t nowEpoch() {
+  return (uint32_t)time(nullptr);
+}
+
+// ==================== CONSOLE ====================
+// Chỉ ghi ra stdout (cửa con đã chuyển stdout về /dev/null nếu không --verbose)
+class StdoutConsole : public HalConsole {
+ public:
+  void begin(uint32_t) override {}
+  void write(const char* text) override { fputs(text, stdout); }
+  int read() override { return -1; }
+};
+
+HalConsole& halConsole() {
+  static StdoutConsole console;
+  return console;
+}
+
+// ==================== FLASH GIẢ ====================
+static uint8_t flashMem[LOADGEN_JOURNAL_SECTORS * JOURNAL_SECTOR_SIZE];
+
+static bool ramRead(uint32_t addr, void* buf, size_t len) {
+  memcpy(buf, flashMem + addr, len);
+  return true;
+}
+
+static bool ramWrite(uint32_t addr, const void* buf, size_t len) {
+  // Flash chỉ đổi bit 1 -> 0
+  const uint8_t* src = (const uint8_t*)buf;
+  for (size_t i = 0; i < len; i++) flashMem[addr + i] &= src[i];
+  return true;
+}
+
+static bool ramErase(uint32_t addr) {
+  memset(flashMem + addr, 0xFF, JOURNAL_SECTOR_SIZE);
+  return true;
+}
+
+// ==================== HTTP/1.1 KEEP-ALIVE ====================
+static uint32_t connects = 0;   // Số lần mở kết nối TCP
+struct Url {
+  std::string host;
+  int port = 80;
+  std::string path;
+};
+
+static bool parseUrl(const char* s, Url& u) {
+  if (strncmp(s, "http://", 7) != 0) return false;
+  s += 7;
+  const char* slash = strchr(s, '/');
+  std::string hostPort = slash ? std::string(s, slash - s) : std::string(s);
+  u.path = slash ? slash : "/";
+  size_t colon = hostPort.find(':');
+  if (colon == std::string::npos) {
+    u.host = hostPort;
+    u.port = 80;
+  } else {
+    u.host = hostPort.substr(0, colon);
+    u.port = atoi(hostPort.c_str() + colon + 1);
+  }
+  return !u.host.empty();
+}
+
+static int connFd = -1;
+static std::string connHost;
+static int connPort = 0;
+
+static void connClose() {
+  if (connFd >= 0) close(connFd);
+  connFd = -1;
+}
+
+static bool connOpen(const Url& u) {
+  if (connFd >= 0 && connHost == u.host && connPort == u.port) return true;
+  connClose();
+
+  struct addrinfo hints, *res = nullptr;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  char port[8];
+  snprintf(port, sizeof(port), "%d", u.port);
+  if (getaddrinfo(u.host.c_str(), port, &hints, &res) != 0) return false;
+
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd >= 0) {
+    struct timeval tv = { LOADGEN_TIMEOUT_MS / 1000, (LOADGEN_TIMEOUT_MS % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(res);
+  if (fd < 0) return false;
+
+  connects++;
+  connFd = fd;
+  connHost = u.host;
+  connPort = u.port;
+  return true;
+}
+
+static bool sendAll(const char* p, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(connFd, p, len, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    p += n;
+    len -= (size_t)n;
+  }
+  return true;
+}
+
+// Đọc 1 response (body chép vào content); trả về HTTP code hoặc -1 (lỗi kết nối / timeout)
+static int readResponse(std::string& location, std::string& content) {
+  std::string buf;
+  char tmp[2048];
+  size_t headerEnd;
+  while ((headerEnd = buf.find("\r\n\r\n")) == std::string::npos) {
+    ssize_t n = recv(connFd, tmp, sizeof(tmp), 0);
+    if (n <= 0) return -1;
+    buf.append(tmp, (size_t)n);
+  }
+
+  int code = 0;
+  if (sscanf(buf.c_str(), "HTTP/1.%*d %d", &code) != 1) return -1;
+
+  size_t contentLength = 0;
+  bool keepAlive = true;
+  location.clear();
+  size_t pos = buf.find("\r\n") + 2;
+  while (pos < headerEnd) {
+    size_t eol = buf.find("\r\n", pos);
+    std::string line = buf.substr(pos, eol - pos);
+    pos = eol + 2;
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    std::string key = line.substr(0, colon);
+    std::string val = line.substr(colon + 1);
+    val.erase(0, val.find_first_not_of(' '));
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    if (key == "content-length") contentLength = strtoul(val.c_str(), nullptr, 10);
+    else if (key == "location") location = val;
+    else if (key == "connection" && strcasecmp(val.c_str(), "close") == 0) keepAlive = false;
+  }
+
+  // Luôn đọc hết body để dùng lại kết nối
+  content = buf.substr(headerEnd + 4);
+  while (content.size() < contentLength) {
+    ssize_t n = recv(connFd, tmp, sizeof(tmp), 0);
+    if (n <= 0) return -1;
+    content.append(tmp, (size_t)n);
+  }
+
+  if (!keepAlive) connClose();
+  return code;
+}
+
+static int httpRequestOnce(const char* method, const Url& u, const char* body, size_t len,
+                           std::string& location, std::string& content) {
+  if (!connOpen(u)) return -1;
+
+  char head[512];
+  int n = snprintf(head, sizeof(head),
+                   "%s %s HTTP/1.1\r\nHost: %s:%d\r\nConnection: %s\r\n"
+                   "Content-Type: application/json\r\nContent-Length: %zu\r\n\r\n",
+                   method, u.path.c_str(), u.host.c_str(), u.port,
+                   opt.newConnection ? "close" : "keep-alive", len);
+  if (n <= 0 || (size_t)n >= sizeof(head)) return -1;
+
+  if (!sendAll(head, (size_t)n) || (len > 0 && !sendAll(body, len))) {
+    connClose();
+    return -1;
+  }
+  int code = readResponse(location, content);
+  if (code < 0 || opt.newConnection) connClose();
+  return code;
+}
+
+// Kết nối cũ có thể đã bị server đóng -> thử lại 1 lần với kết nối mới
+static int httpRequest(const char* method, const char* url, const char* body, size_t len,
+                       std::string& location, std::string& content) {
+  Url u;
+  if (!parseUrl(url, u)) return -1;
+  bool reused = connFd >= 0;
+  int code = httpRequestOnce(method, u, body, len, location, content);
+  if (code < 0 && reused) code = httpRequestOnce(method, u, body, len, location, content);
+  return code;
+}
+
+// ==================== KẾT QUẢ MỖI CỬA ====================
+struct DoorResult {
+  uint32_t generated;
+  uint32_t acked;
+  uint32_t batches;
+  uint32_t lastAckMs;
+  uint32_t journalBacklog;
+  uint32_t journalLost;
+  uint32_t connects;
+  UplinkMetrics metrics;
+};
+
+static DoorResult result;
+static std::deque<uint32_t> inFlight;       // Thời điểm xảy ra của sự kiện chưa được xác nhận
+static std::vector<uint32_t> eventLatency;  // ms, lúc xảy ra -> xác nhận
+static std::vector<uint32_t> httpRtt;       // ms, 1 lô (kể cả theo redirect)
+
+// Số hàng trong body {"rows":[[...],[...]]}
+static uint32_t countRows(const char* body, size_t len) {
+  uint32_t rows = 0;
+  for (size_t i = 1; i < len; i++) {
+    if (body[i] == '[' && body[i - 1] != ':') rows++;
+  }
+  return rows;
+}
+
+static int loadgenTransport(const char* url, const char* body, size_t len, bool* accepted) {
+  uint64_t t0 = monoUs();
+  std::string location, content;
+  int code = httpRequest("POST", url, body, len, location, content);
+
+  bool redirect = (code == 302 || code == 303) && !location.empty();
+  if (redirect && !opt.acceptRedirect) {
+    std::string next;
+    code = httpRequest("GET", location.c_str(), nullptr, 0, next, content);
+    redirect = false;
+  }
+  httpRtt.push_back((uint32_t)((monoUs() - t0) / 1000));
+
+  // Như uplink_conn.cpp: script phải trả success (hoặc 302 đã tin);
+  // lô luôn theo đúng thứ tự sự kiện
+  *accepted = redirect || content.find("\"status\":\"success\"") != std::string::npos;
+  if (code >= 200 && code < 400 && *accepted) {
+    uint32_t now = nowMs();
+    uint32_t rows = countRows(body, len);
+    for (uint32_t i = 0; i < rows && !inFlight.empty(); i++) {
+      eventLatency.push_back(now - inFlight.front());
+      inFlight.pop_front();
+    }
+    result.acked += rows;
+    result.batches++;
+    result.lastAckMs = now;
+  }
+  return code;
+}
+
+// ==================== MỘT CỬA ====================
+static double expInterval(double rate) {
+  double u = (rand() + 1.0) / ((double)RAND_MAX + 2.0);
+  return -log(u) / rate * 1000.0;
+}
+
+static LogEvent randomEvent() {
+  static const LogMethod methods[] = { LOG_BY_PASSWORD, LOG_BY_FINGERPRINT, LOG_BY_2FA };
+  LogMethod m = methods[rand() % 3];
+  bool ok = rand() % 10 != 0;
+  LogUser user = m == LOG_BY_FINGERPRINT ? LOG_USER_FINGER : LOG_USER_ADMIN;
+  LogEvent ev = logEventMake(LOG_DOOR_OPEN, m, ok ? user : LOG_USER_UNKNOWN,
+                             ok ? LOG_SUCCESS : LOG_FAILED, (uint16_t)(rand() % 128),
+                             25.0f + (rand() % 100) / 10.0f, (float)(40 + rand() % 40));
+  eventClockStamp(ev);
+  return ev;
+}
+
+static bool writeAll(int fd, const void* p, size_t len) {
+  const uint8_t* b = (const uint8_t*)p;
+  while (len > 0) {
+    ssize_t n = write(fd, b, len);
+    if (n <= 0) return false;
+    b += n;
+    len -= (size_t)n;
+  }
+  return true;
+}
+
+static void runDoor(int index, int outFd) {
+  if (!opt.verbose) {
+    if (!freopen("/dev/null", "w", stdout)) return;
+  }
+  srand((unsigned)(monoUs() ^ (index * 2654435761u)));
+
+  // Mỗi cửa một boot ID -> script lọc trùng theo (boot, seq) như thật
+  eventClockBegin((uint32_t)rand() | 1u, nowMs, nowEpoch);
+
+  JournalFlash flash = { sizeof(flashMem), ramRead, ramWrite, ramErase };
+  memset(flashMem, 0xFF, sizeof(flashMem));
+  journalBegin(flash);
+  uplinkBegin(opt.url.c_str(), loadgenTransport);
+
+  uint32_t endMs = (uint32_t)opt.durationS * 1000;
+  uint32_t drainEndMs = endMs + (uint32_t)opt.drainS * 1000;
+  double nextMs = expInterval(opt.rate);
+
+  for (;;) {
+    uint32_t now = nowMs();
+    if (now >= endMs && (inFlight.empty() || now >= drainEndMs)) break;
+
+    // uplinkService trước để uplinkLog ghi đúng thời điểm vào lô
+    uplinkService(now);
+
+    // Sự kiện đến hạn trong lúc đang chờ HTTP vẫn giữ thời điểm xảy ra
+    while (nextMs <= now && nextMs < endMs) {
+      inFlight.push_back((uint32_t)nextMs);
+      uplinkLog(randomEvent());
+      result.generated++;
+      nextMs += expInterval(opt.rate);
+    }
+    usleep(LOADGEN_TICK_US);
+  }
+
+  result.journalBacklog = journalCount();
+  result.journalLost = journalLost();
+  result.connects = connects;
+  result.metrics = uplinkMetrics;
+
+  uint32_t nLat = (uint32_t)eventLatency.size();
+  uint32_t nRtt = (uint32_t)httpRtt.size();
+  writeAll(outFd, &result, sizeof(result));
+  writeAll(outFd, &nLat, sizeof(nLat));
+  writeAll(outFd, eventLatency.data(), nLat * sizeof(uint32_t));
+  writeAll(outFd, &nRtt, sizeof(nRtt));
+  writeAll(outFd, httpRtt.data(), nRtt * sizeof(uint32_t));
+}
+
+// ==================== TỔNG HỢP ====================
+static bool readAll(int fd, void* p, size_t len) {
+  uint8_t* b = (uint8_t*)p;
+  while (len > 0) {
+    ssize_t n = read(fd, b, len);
+    if (n <= 0) return false;
+    b += n;
+    len -= (size_t)n;
+  }
+  return true;
+}
+
+static bool readSamples(int fd, std::vector<uint32_t>& out) {
+  uint32_t n;
+  if (!readAll(fd, &n, sizeof(n))) return false;
+  size_t old = out.size();
+  out.resize(old + n);
+  return readAll(fd, out.data() + old, n * sizeof(uint32_t));
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t idx = (size_t)ceil(p / 100.0 * sorted.size());
+  if (idx > 0) idx--;
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static void printLatency(const char* name, std::vector<uint32_t>& v) {
+  std::sort(v.begin(), v.end());
+  printf("%-22s n=%-7zu p50=%-6u p90=%-6u p99=%-6u p99.9=%-6u max=%u ms\n",
+         name, v.size(), percentile(v, 50), percentile(v, 90), percentile(v, 99),
+         percentile(v, 99.9), v.empty() ? 0 : v.back());
+}
+
+static void usage() {
+  fprintf(stderr,
+          "Dùng: loadgen --url http://host:port/exec [--doors N] [--rate ev/s]\n"
+          "              [--duration s] [--drain s] [--accept-redirect]\n"
+          "              [--new-connection] [--verbose]\n");
+  exit(1);
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(a, "--url") && hasValue) opt.url = argv[++i];
+    else if (!strcmp(a, "--doors") && hasValue) opt.doors = atoi(argv[++i]);
+    else if (!strcmp(a, "--rate") && hasValue) opt.rate = atof(argv[++i]);
+    else if (!strcmp(a, "--duration") && hasValue) opt.durationS = atoi(argv[++i]);
+    else if (!strcmp(a, "--drain") && hasValue) opt.drainS = atoi(argv[++i]);
+    else if (!strcmp(a, "--accept-redirect")) opt.acceptRedirect = true;
+    else if (!strcmp(a, "--new-connection")) opt.newConnection = true;
+    else if (!strcmp(a, "--verbose")) opt.verbose = true;
+    else usage();
+  }
+  Url check;
+  if (opt.url.empty() || !parseUrl(opt.url.c_str(), check) || opt.doors <= 0 ||
+      opt.rate <= 0 || opt.durationS <= 0) {
+    usage();
+  }
+
+  printf("[Loadgen] %d cửa x %.2f ev/s trong %d s -> %s%s%s\n", opt.doors, opt.rate,
+         opt.durationS, opt.url.c_str(), opt.acceptRedirect ? " (nhận 302)" : "",
+         opt.newConnection ? " (kết nối mới mỗi request)" : "");
+  fflush(stdout);
+
+  startUs = monoUs();
+  std::vector<int> fds;
+  std::vector<pid_t> pids;
+  for (int i = 0; i < opt.doors; i++) {
+    int p[2];
+    if (pipe(p) != 0) {
+      perror("pipe");
+      return 1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      return 1;
+    }
+    if (pid == 0) {
+      close(p[0]);
+      runDoor(i, p[1]);
+      close(p[1]);
+      fflush(stdout);  // _exit không xả buffer stdio (log --verbose)
+      _exit(0);
+    }
+    close(p[1]);
+    fds.push_back(p[0]);
+    pids.push_back(pid);
+  }
+
+  DoorResult total;
+  memset(&total, 0, sizeof(total));
+  std::vector<uint32_t> latency, rtt;
+  int failedDoors = 0;
+
+  for (size_t i = 0; i < fds.size(); i++) {
+    DoorResult r;
+    if (!readAll(fds[i], &r, sizeof(r)) || !readSamples(fds[i], latency) ||
+        !readSamples(fds[i], rtt)) {
+      failedDoors++;
+    } else {
+      total.generated += r.generated;
+      total.acked += r.acked;
+      total.batches += r.batches;
+      total.lastAckMs = std::max(total.lastAckMs, r.lastAckMs);
+      total.journalBacklog += r.journalBacklog;
+      total.journalLost += r.journalLost;
+      total.connects += r.connects;
+      total.metrics.spooled += r.metrics.spooled;
+      total.metrics.retries += r.metrics.retries;
+      total.metrics.http2xx += r.metrics.http2xx;
+      total.metrics.http3xx += r.metrics.http3xx;
+      total.metrics.http4xx += r.metrics.http4xx;
+      total.metrics.http5xx += r.metrics.http5xx;
+      total.metrics.httpError += r.metrics.httpError;
+    }
+    close(fds[i]);
+  }
+  for (pid_t pid : pids) waitpid(pid, nullptr, 0);
+
+  double windowS = opt.durationS;
+  double ackS = total.lastAckMs > 0 ? total.lastAckMs / 1000.0 : windowS;
+  printf("\n==================== KẾT QUẢ ====================\n");
+  printf("Sự kiện: phát %u | xác nhận %u | còn trong nhật ký %u | mất %u\n",
+         total.generated, total.acked, total.journalBacklog, total.journalLost);
+  printf("Tải đề ra: %.1f ev/s | Duy trì: %.1f ev/s (%u lô, TB %.1f sự kiện/lô)\n",
+         total.generated / windowS, total.acked / ackS, total.batches,
+         total.batches ? (double)total.acked / total.batches : 0.0);
+  printf("HTTP 2xx: %u | 3xx: %u | 4xx: %u | 5xx: %u | Lỗi: %u\n",
+         total.metrics.http2xx, total.metrics.http3xx, total.metrics.http4xx,
+         total.metrics.http5xx, total.metrics.httpError);
+  printf("Kết nối TCP: %u (%.2f mỗi lô)\n", total.connects,
+         total.batches ? (double)total.connects / total.batches : 0.0);
+  printf("Nhật ký: ghi %u sự kiện | %u lần gửi lại\n",
+         total.metrics.spooled, total.metrics.retries);
+  printLatency("Độ trễ sự kiện:", latency);
+  printLatency("Thời gian 1 lô HTTP:", rtt);
+  if (failedDoors) printf("✗ %d cửa không trả kết quả\n", failedDoors);
+  return failedDoors ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * LOGBENCH - Đo định dạng log: BufWriter (log_event.cpp) và đường String cũ
+ * ========================================================================
+ *
+ * So sánh thời gian và số lần cấp phát heap cho mỗi sự kiện:
+ *   - string: đúng như sendToGoogleSheets() cũ, 4 String truyền theo giá
+ *     trị, "Finger_ID_" + String(id), 6 lần url += ... + String(t, 1).
+ *     MiniString dưới đây làm như WString của Arduino-ESP32: mỗi lần nối
+ *     realloc vừa đủ độ dài mới, toán tử + tạo String tạm
+ *   - query / json: logEventMake + logFormatQuery / logFormatJsonRow vào
+ *     buffer trên stack (query có thêm boot, seq, ts, count, span)
+ * Cấp phát = mỗi lần MiniString gọi realloc (buffer mới hoặc nới buffer).
+ *
+ * Chạy trên máy tính nên chỉ so sánh tương đối; trên ESP32 mỗi lần cấp
+ * phát còn đắt hơn (khóa heap, phân mảnh).
+ *
+ * Biên dịch (từ thư mục gốc repo):
+ *   g++ -std=gnu++17 -O2 -Iinclude tools/logbench/logbench.cpp src/log_event.cpp -o logbench
+ *
+ * Chạy: ./logbench [số vòng, mặc định 2000000]
+ */
+
+#include "log_event.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ==================== CẤU HÌNH ====================
+#define LOGBENCH_ITERATIONS 2000000
+#define LOGBENCH_SCRIPT_URL \
+  "https://script.google.com/macros/s/AKfycbz0000000000000000000000000000000000000000000000000/exec"
+
+// ==================== ĐẾM CẤP PHÁT ====================
+static uint64_t allocs = 0;
+
+// noinline: GCC -O2 inline vào concat() rồi báo -Wstringop-overflow nhầm
+__attribute__((noinline)) static void* countedRealloc(void* p, size_t n) {
+  allocs++;
+  return realloc(p, n);
+}
+
+// ==================== STRING KIỂU ARDUINO ====================
+class MiniString {
+ public:
+  MiniString() {}
+  MiniString(const char* s) { concat(s, strlen(s)); }
+  MiniString(const MiniString& o) { concat(o.buf_, o.len_); }
+  explicit MiniString(unsigned v) {
+    char tmp[11];
+    int n = snprintf(tmp, sizeof(tmp), "%u", v);
+    concat(tmp, (size_t)n);
+  }
+  // String(float, decimals) của Arduino dùng dtostrf
+  MiniString(float v, int decimals) {
+    char tmp[33];
+    int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, (double)v);
+    concat(tmp, (size_t)n);
+  }
+  ~MiniString() { free(buf_); }
+
+  MiniString& operator+=(const MiniString& o) {
+    concat(o.buf_, o.len_);
+    return *this;
+  }
+  MiniString& operator+=(const char* s) {
+    concat(s, strlen(s));
+    return *this;
+  }
+
+  friend MiniString operator+(const char* a, const MiniString& b) {
+    MiniString r(a);
+    r += b;
+    return r;
+  }
+  friend MiniString operator+(MiniString a, const MiniString& b) {
+    a += b;
+    return a;
+  }
+
+  const char* c_str() const { return buf_ ? buf_ : ""; }
+  size_t length() const { return len_; }
+
+ private:
+  // WString::reserve -> changeBuffer: realloc vừa đủ khi thiếu chỗ
+  void concat(const char* s, size_t n) {
+    if (n == 0 && buf_) return;
+    if (len_ + n > cap_ || !buf_) {
+      buf_ = (char*)countedRealloc(buf_, len_ + n + 1);
+      cap_ = len_ + n;
+    }
+    memcpy(buf_ + len_, s, n);
+    len_ += n;
+    buf_[len_] = '\0';
+  }
+
+  char* buf_ = nullptr;
+  size_t len_ = 0;
+  size_t cap_ = 0;
+};
+
+// ==================== HAI CÁCH ĐỊNH DẠNG ====================
+static volatile size_t sink;   // Giữ kết quả để trình biên dịch không bỏ vòng lặp
+
+// Nguyên văn sendToGoogleSheets() cũ (bỏ phần HTTP)
+static void sendViaString(MiniString event, MiniString method, MiniString user,
+                          MiniString status, float temperature, float humidity) {
+  MiniString url = MiniString(LOGBENCH_SCRIPT_URL);
+  url += "?event=" + event;
+  url += "&method=" + method;
+  url += "&user=" + user;
+  url += "&status=" + status;
+  url += "&temp=" + MiniString(temperature, 1);
+  url += "&humidity=" + MiniString(humidity, 0);
+  sink = url.length();
+}
+
+static void benchString(uint32_t i) {
+  sendViaString("DOOR_OPEN", "FINGERPRINT", "Finger_ID_" + MiniString(i % 128), "SUCCESS",
+                28.5f, 65.0f);
+}
+
+static void benchQuery(uint32_t i) {
+  char url[256];
+  static const size_t prefix = sizeof(LOGBENCH_SCRIPT_URL);
+  memcpy(url, LOGBENCH_SCRIPT_URL "?", prefix);
+  LogEvent ev = logEventMake(LOG_DOOR_OPEN, LOG_BY_FINGERPRINT, LOG_USER_FINGER, LOG_SUCCESS,
+                             (uint16_t)(i % 128), 28.5f, 65.0f);
+  sink = prefix + logFormatQuery(ev, url + prefix, sizeof(url) - prefix);
+}
+
+static void benchJson(uint32_t i) {
+  char row[160];
+  LogEvent ev = logEventMake(LOG_DOOR_OPEN, LOG_BY_FINGERPRINT, LOG_USER_FINGER, LOG_SUCCESS,
+                             (uint16_t)(i % 128), 28.5f, 65.0f);
+  sink = logFormatJsonRow(ev, row, sizeof(row));
+}
+
+// ==================== ĐO ====================
+static double nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run(const char* name, void (*fn)(uint32_t), uint32_t iterations) {
+  for (uint32_t i = 0; i < iterations / 10; i++) fn(i);  // Làm nóng cache
+
+  allocs = 0;
+  double start = nowNs();
+  for (uint32_t i = 0; i < iterations; i++) fn(i);
+  double ns = (nowNs() - start) / iterations;
+  printf("%-8s %8.1f ns/sự kiện | %5.2f cấp phát/sự kiện | %3u byte\n", name, ns,
+         (double)allocs / iterations, (unsigned)sink);
+}
+
+int main(int argc, char** argv) {
+  uint32_t iterations = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : LOGBENCH_ITERATIONS;
+  if (iterations == 0) iterations = LOGBENCH_ITERATIONS;
+
+  printf("[Logbench] %u sự kiện mỗi cách\n", (unsigned)iterations);
+  run("string", benchString, iterations);
+  run("query", benchQuery, iterations);
+  run("json", benchJson, iterations);
+  return 0;
+}
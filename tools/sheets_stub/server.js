@@ -0,0 +1,271 @@
+/*
+ * SHEETS STUB - Giả lập Google Apps Script web app trên máy tính
+ * ==============================================================
+ *
+ * Chạy nguyên file GoogleAppsScript.js (doGet/doPost) trong Node với
+ * SpreadsheetApp/ContentService/Utilities giả, để đo tải đường gửi log
+ * mà không cần tới server thật của Google.
+ *
+ * Có thể chèn:
+ *   --latency <ms>       Độ trễ xử lý trung bình của script (mặc định 0)
+ *   --jitter <ms>        Độ trễ dao động ±jitter (mặc định 0)
+ *   --handshake <ms>     Thêm vào request đầu tiên của mỗi kết nối TCP, thay
+ *                        cho bắt tay TLS của server thật (mặc định 0)
+ *   --error-rate <0..1>  Tỉ lệ trả về HTTP 500 (không ghi dòng nào)
+ *   --redirect           Giống Apps Script thật: /exec trả 302, kết quả lấy
+ *                        bằng GET tới /echo?user_content_key=...
+ *   --port <n>           Cổng HTTP (mặc định 8080)
+ *   --post <file>        Không mở cổng: chạy doPost với body trong file (lặp
+ *                        lại được, theo thứ tự), in từng kết quả của script
+ *                        rồi dòng cuối là thống kê JSON, sau đó thoát
+ *                        (test/test_sheets_body)
+ *
+ * URL cho firmware / loadgen: http://<host>:<port>/exec
+ * GET /__stats trả thống kê dạng JSON (số request, số dòng đã ghi...)
+ *
+ * Chạy: node tools/sheets_stub/server.js --latency 800 --jitter 300 --redirect
+ */
+
+var fs = require("fs");
+var http = require("http");
+var path = require("path");
+var url = require("url");
+var vm = require("vm");
+
+// ==================== THAM SỐ ====================
+var opts = {
+  port: 8080,
+  latency: 0,
+  jitter: 0,
+  handshake: 0,
+  errorRate: 0,
+  redirect: false,
+  post: []
+};
+
+var argv = process.argv.slice(2);
+for (var i = 0; i < argv.length; i++) {
+  switch (argv[i]) {
+    case "--port": opts.port = parseInt(argv[++i], 10); break;
+    case "--latency": opts.latency = parseInt(argv[++i], 10); break;
+    case "--jitter": opts.jitter = parseInt(argv[++i], 10); break;
+    case "--handshake": opts.handshake = parseInt(argv[++i], 10); break;
+    case "--error-rate": opts.errorRate = parseFloat(argv[++i]); break;
+    case "--redirect": opts.redirect = true; break;
+    case "--post": opts.post.push(argv[++i]); break;
+    default:
+      console.error("Tham số không hợp lệ: " + argv[i]);
+      process.exit(1);
+  }
+}
+
+// ==================== SHEET GIẢ ====================
+// Chỉ đếm dòng và giữ dòng cuối (chạy tải lâu không tốn bộ nhớ)
+var stats = {
+  rows: 0,
+  appendRow: 0,
+  setValues: 0,
+  requests: 0,
+  connections: 0,
+  injectedErrors: 0,
+  redirects: 0,
+  properties: 0,   // Số Script Property đang lưu
+  lastRow: null
+};
+
+var sheet = {
+  appendRow: function(row) {
+    stats.rows++;
+    stats.appendRow++;
+    stats.lastRow = row;
+  },
+  getLastRow: function() {
+    return stats.rows + 1;  // + hàng tiêu đề
+  },
+  getRange: function(row, col, numRows, numCols) {
+    return {
+      setValues: function(values) {
+        if (values.length !== numRows || values[0].length !== numCols) {
+          throw new Error("Kích thước range không khớp dữ liệu");
+        }
+        stats.rows += values.length;
+        stats.setValues++;
+        stats.lastRow = values[values.length - 1];
+      }
+    };
+  }
+};
+
+// Script Properties giả (seq lớn nhất đã ghi của các boot gần nhất)
+var properties = {};
+var scriptProperties = {
+  getProperty: function(key) {
+    return key in properties ? properties[key] : null;
+  },
+  setProperty: function(key, value) {
+    properties[key] = String(value);
+    stats.properties = Object.keys(properties).length;
+    return this;
+  },
+  setProperties: function(obj) {
+    for (var k in obj) properties[k] = String(obj[k]);
+    stats.properties = Object.keys(properties).length;
+    return this;
+  },
+  deleteProperty: function(key) {
+    delete properties[key];
+    stats.properties = Object.keys(properties).length;
+    return this;
+  },
+  getKeys: function() {
+    return Object.keys(properties);
+  }
+};
+
+function textOutput(text) {
+  return {
+    mime: "text/plain",
+    setMimeType: function(m) { this.mime = m; return this; },
+    getContent: function() { return text; }
+  };
+}
+
+var context = {
+  SpreadsheetApp: {
+    getActiveSpreadsheet: function() {
+      return { getActiveSheet: function() { return sheet; } };
+    }
+  },
+  ContentService: {
+    MimeType: { JSON: "application/json" },
+    createTextOutput: textOutput
+  },
+  Utilities: {
+    formatDate: function(d) { return d.toISOString(); }
+  },
+  PropertiesService: {
+    getScriptProperties: function() { return scriptProperties; }
+  },
+  LockService: {
+    // Node chạy script tuần tự trong 1 luồng -> khóa không cần làm gì
+    getScriptLock: function() {
+      return { waitLock: function() {}, releaseLock: function() {} };
+    }
+  },
+  Logger: { log: console.log },
+  JSON: JSON,
+  Date: Date
+};
+
+vm.createContext(context);
+vm.runInContext(
+  fs.readFileSync(path.join(__dirname, "..", "..", "GoogleAppsScript.js"), "utf8"),
+  context);
+
+// ==================== CHẠY 1 LẦN (--post) ====================
+if (opts.post.length > 0) {
+  opts.post.forEach(function(file) {
+    var out = context.doPost({ postData: { contents: fs.readFileSync(file, "utf8") }, parameter: {} });
+    console.log(out.getContent());
+  });
+  console.log(JSON.stringify(stats));
+  process.exit(0);
+}
+
+// ==================== HTTP ====================
+var pendingEcho = {};  // user_content_key -> kết quả chờ GET
+var echoSeq = 0;
+
+function scriptDelay() {
+  var d = opts.latency + (Math.random() * 2 - 1) * opts.jitter;
+  return d > 0 ? d : 0;
+}
+
+function send(res, code, body, headers) {
+  headers = headers || {};
+  headers["Content-Length"] = Buffer.byteLength(body);
+  res.writeHead(code, headers);
+  res.end(body);
+}
+
+function runScript(req, u, body) {
+  if (req.method === "POST") {
+    return context.doPost({ postData: { contents: body }, parameter: u.query });
+  }
+  return context.doGet({ parameter: u.query });
+}
+
+function handleExec(req, res, u, body) {
+  var delay = scriptDelay();
+  if (!req.socket.handshakeDone) {
+    req.socket.handshakeDone = true;
+    delay += opts.handshake;
+  }
+  setTimeout(function() {
+    if (Math.random() < opts.errorRate) {
+      stats.injectedErrors++;
+      send(res, 500, "Internal Server Error", { "Content-Type": "text/plain" });
+      return;
+    }
+
+    var out = runScript(req, u, body);
+    if (opts.redirect) {
+      var key = (++echoSeq).toString(36);
+      pendingEcho[key] = out;
+      stats.redirects++;
+      var host = req.headers.host || ("127.0.0.1:" + opts.port);
+      send(res, 302, "", { "Location": "http://" + host + "/echo?user_content_key=" + key });
+    } else {
+      send(res, 200, out.getContent(), { "Content-Type": out.mime });
+    }
+  }, delay);
+}
+
+function handleEcho(req, res, u) {
+  var key = u.query.user_content_key;
+  var out = pendingEcho[key];
+  if (!out) {
+    send(res, 404, "Not Found", { "Content-Type": "text/plain" });
+    return;
+  }
+  delete pendingEcho[key];
+  send(res, 200, out.getContent(), { "Content-Type": out.mime });
+}
+
+var server = http.createServer(function(req, res) {
+  var chunks = [];
+  req.on("data", function(c) { chunks.push(c); });
+  req.on("end", function() {
+    var u = url.parse(req.url, true);
+    var body = Buffer.concat(chunks).toString("utf8");
+    stats.requests++;
+
+    if (u.pathname === "/exec") {
+      handleExec(req, res, u, body);
+    } else if (u.pathname === "/echo") {
+      handleEcho(req, res, u);
+    } else if (u.pathname === "/__stats") {
+      send(res, 200, JSON.stringify(stats), { "Content-Type": "application/json" });
+    } else {
+      send(res, 404, "Not Found", { "Content-Type": "text/plain" });
+    }
+  });
+});
+
+server.on("connection", function() { stats.connections++; });
+
+// Giữ kết nối lâu hơn chu kỳ gửi lô của firmware
+server.keepAliveTimeout = 60000;
+
+server.listen(opts.port, function() {
+  console.log("[Stub] http://127.0.0.1:" + opts.port + "/exec" +
+              " latency=" + opts.latency + "±" + opts.jitter + "ms" +
+              " handshake=" + opts.handshake + "ms" +
+              " error-rate=" + opts.errorRate +
+              (opts.redirect ? " redirect" : ""));
+});
+
+process.on("SIGINT", function() {
+  console.log("\n[Stub] " + JSON.stringify(stats));
+  process.exit(0);
+});